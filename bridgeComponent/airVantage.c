@@ -421,10 +421,10 @@ static int mangoh_bridge_air_vantage_available(void* param, const unsigned char*
 
     LE_TRACE(traceRef, "---> AVAIL");
 
-    mangoh_bridge_air_vantage_avail_rsp_t* const rsp = (mangoh_bridge_air_vantage_avail_rsp_t*)((mangoh_bridge_t*)airVantage->bridge)->packet.msg.data;
+    mangoh_bridge_air_vantage_avail_rsp_t* const rsp = (mangoh_bridge_air_vantage_avail_rsp_t*)((mangoh_bridge_t*)airVantage->bridge)->packet.tx.data;
 
-    LE_TRACE(traceRef, "Rx buffer length(%u)", airVantage->rxBuffLen);
-    rsp->result = htons(airVantage->rxBuffLen);
+    LE_TRACE(traceRef, "Rx buffer length(%u)", mangoh_bridge_queue_len(&airVantage->rxQueue));
+    rsp->result = htons(mangoh_bridge_queue_len(&airVantage->rxQueue));
     LE_TRACE(traceRef, "result(%d)", rsp->result);
     res = mangoh_bridge_sendResult(airVantage->bridge, sizeof(rsp->result));
     if (res != LE_OK)
@@ -447,15 +447,11 @@ static int mangoh_bridge_air_vantage_recv(void* param, const unsigned char* data
 
     LE_DEBUG("---> RECV");
 
-    if (airVantage->rxBuffLen)
+    if (mangoh_bridge_queue_len(&airVantage->rxQueue))
     {
-        mangoh_bridge_air_vantage_recv_rsp_t* const rsp = (mangoh_bridge_air_vantage_recv_rsp_t*)((mangoh_bridge_t*)airVantage->bridge)->packet.msg.data;
-        uint8_t rdLen = (sizeof(rsp->data) > airVantage->rxBuffLen) ? airVantage->rxBuffLen:sizeof(rsp->data);
-
-        memcpy(rsp->data, (const char*)airVantage->rxBuffer, rdLen);
-        memmove(airVantage->rxBuffer, &airVantage->rxBuffer[rdLen], airVantage->rxBuffLen - rdLen);
-        memset(&airVantage->rxBuffer[airVantage->rxBuffLen - rdLen], 0, rdLen);
-        airVantage->rxBuffLen -= rdLen;
+        mangoh_bridge_air_vantage_recv_rsp_t* const rsp = (mangoh_bridge_air_vantage_recv_rsp_t*)((mangoh_bridge_t*)airVantage->bridge)->packet.tx.data;
+        const uint32_t maxLen = ((mangoh_bridge_t*)airVantage->bridge)->packet.dataSize;
+        uint32_t rdLen = mangoh_bridge_queue_read(&airVantage->rxQueue, rsp->data, maxLen);
 
         LE_DEBUG("result(%u)", rdLen);
         res = mangoh_bridge_sendResult(airVantage->bridge, rdLen);
@@ -533,15 +529,14 @@ static void mangoh_bridge_air_vantage_dataUpdateHdlr(dataRouter_DataType_t type,
 
     LE_DEBUG("'%s'", msg);
     len = strlen(msg);
-    if (len + airVantage->rxBuffLen > sizeof(airVantage->rxBuffer))
+    if (len > mangoh_bridge_queue_room(&airVantage->rxQueue))
     {
-        LE_ERROR("ERROR Rx buffer overflow(%u + %u > %zu)", len, airVantage->rxBuffLen, sizeof(airVantage->rxBuffer));
+        LE_ERROR("ERROR Rx buffer overflow(%u + %u > %zu)", len, mangoh_bridge_queue_len(&airVantage->rxQueue), sizeof(airVantage->rxBuffer));
         goto cleanup;
     }
 
-    strncpy((char*)&airVantage->rxBuffer[airVantage->rxBuffLen], msg, sizeof(airVantage->rxBuffer) - airVantage->rxBuffLen);
-    airVantage->rxBuffLen += len;
-    LE_DEBUG("Rx buffer('%s') length(%u)", airVantage->rxBuffer, airVantage->rxBuffLen);
+    mangoh_bridge_queue_write(&airVantage->rxQueue, msg, len);
+    LE_DEBUG("Rx buffer length(%u)", mangoh_bridge_queue_len(&airVantage->rxQueue));
 
 cleanup:
     return;
@@ -567,6 +562,7 @@ int mangoh_bridge_air_vantage_init(mangoh_bridge_air_vantage_t* airVantage, void
     LE_DEBUG("init");
 
     airVantage->bridge = bridge;
+    mangoh_bridge_queue_init(&airVantage->rxQueue, airVantage->rxBuffer, sizeof(airVantage->rxBuffer));
     airVantage->dataUpdateHandlers = le_hashmap_Create(MANGOH_BRIDGE_AIR_VANTAGE_DATA_UPDATE_MAP_NAME, MANGOH_BRIDGE_AIR_VANTAGE_DATA_UPDATE_MAP_SIZE,
         le_hashmap_HashString, le_hashmap_EqualsString);
 
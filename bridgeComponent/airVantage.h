@@ -13,6 +13,7 @@
 #include "legato.h"
 #include "interfaces.h"
 #include "packet.h"
+#include "queue.h"
 
 #ifndef MANGOH_BRIDGE_AIR_VANTAGE_INCLUDE_GUARD
 #define MANGOH_BRIDGE_AIR_VANTAGE_INCLUDE_GUARD
@@ -59,10 +60,10 @@ typedef struct _mangoh_bridge_air_vantage_recv_rsp_t
 //------------------------------------------------------------------------------------------------------------------
 typedef struct _mangoh_bridge_air_vantage_t
 {
-    int8_t           rxBuffer[MANGOH_BRIDGE_AIR_VANTAGE_RX_BUFF_SIZE]; ///< Receive buffer
-    le_hashmap_Ref_t dataUpdateHandlers;                               ///< Workflow Manager data update callback functions
-    void*            bridge;                                           ///< Bridge module
-    uint32_t         rxBuffLen;                                        ///< Number of bytes in Rx buffer
+    uint8_t               rxBuffer[MANGOH_BRIDGE_AIR_VANTAGE_RX_BUFF_SIZE]; ///< Receive buffer
+    mangoh_bridge_queue_t rxQueue;                                          ///< Data updates waiting for the MCU
+    le_hashmap_Ref_t      dataUpdateHandlers;                               ///< Workflow Manager data update callback functions
+    void*                 bridge;                                           ///< Bridge module
 } mangoh_bridge_air_vantage_t;
 
 int mangoh_bridge_air_vantage_init(mangoh_bridge_air_vantage_t*, void*);
@@ -6,20 +6,65 @@
  * Copyright (C) Sierra Wireless, Inc. Use of this work is subject to license.
  */
 
+#include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <termios.h>
+#include <sys/uio.h>
 #include <arpa/inet.h>
 #include "interfaces.h"
 #include "bridge.h"
+#include "compress.h"
 
-static int mangoh_bridge_read(mangoh_bridge_t*, unsigned char*, unsigned int);
-static int mangoh_bridge_write(const mangoh_bridge_t*, const unsigned char*, unsigned int);
-
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Transport address lookup, run on a worker thread as name resolution may block
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_resolve_job_t
+{
+    mangoh_bridge_transport_peer_t peer;       ///< Resolved address
+    mangoh_bridge_t*               bridge;     ///< Bridge module
+    int32_t                        res;        ///< Lookup result
+    uint32_t                       generation; ///< Bridge reconnect generation of the lookup
+} mangoh_bridge_resolve_job_t;
+
+static int mangoh_bridge_fillRxRing(mangoh_bridge_t*);
+static uint32_t mangoh_bridge_consumeRxRing(mangoh_bridge_t*, unsigned char*, uint32_t);
+static uint8_t mangoh_bridge_peekRxRing(const mangoh_bridge_t*, uint32_t);
+static void mangoh_bridge_discardRxRing(mangoh_bridge_t*, uint32_t);
+static uint32_t mangoh_bridge_maxPayloadLen(const mangoh_bridge_t*);
+static bool mangoh_bridge_scanRxRing(mangoh_bridge_t*);
+static void mangoh_bridge_rewindRxRing(mangoh_bridge_t*);
+static bool mangoh_bridge_rxField(mangoh_bridge_t*, void*, uint32_t);
+static void mangoh_bridge_setRxState(mangoh_bridge_t*, mangoh_bridge_rx_state_t);
+static int mangoh_bridge_write(mangoh_bridge_t*, struct iovec*, int);
+static bool mangoh_bridge_txRingHasRoom(const mangoh_bridge_t*);
+static int mangoh_bridge_drainTxRing(mangoh_bridge_t*);
+static void mangoh_bridge_clearTxRing(mangoh_bridge_t*);
+
+static int mangoh_bridge_process_msg_start(mangoh_bridge_t*);
 static int mangoh_bridge_process_msg_idx(mangoh_bridge_t*);
 static int mangoh_bridge_process_payload_len(mangoh_bridge_t*);
+static int mangoh_bridge_process_payload_data(mangoh_bridge_t*);
+static void mangoh_bridge_captureRx(mangoh_bridge_t*, uint8_t);
 static int mangoh_bridge_process_crc(mangoh_bridge_t*);
+static int mangoh_bridge_decodePayload(mangoh_bridge_t*);
+static void mangoh_bridge_encodePayload(mangoh_bridge_t*, uint32_t*);
+static mangoh_bridge_rsp_cache_t* mangoh_bridge_findResponse(mangoh_bridge_t*, uint8_t);
+static void mangoh_bridge_clearResponses(mangoh_bridge_t*);
+static void mangoh_bridge_clearDeferred(mangoh_bridge_t*);
+static int mangoh_bridge_sendResponse(mangoh_bridge_t*, uint8_t, uint32_t);
+static int mangoh_bridge_complete(mangoh_bridge_t*, const mangoh_bridge_pending_t*, const void*, uint32_t, bool);
+static int mangoh_bridge_replay(mangoh_bridge_t*, const mangoh_bridge_rsp_cache_t*);
 static int mangoh_bridge_process_cmd(mangoh_bridge_t*);
 static int mangoh_bridge_close(mangoh_bridge_t*);
+static uint32_t mangoh_bridge_negotiateBaudRate(uint32_t);
+static int mangoh_bridge_setBaudRate(mangoh_bridge_t*, uint32_t);
+static int mangoh_bridge_switchBaudRate(mangoh_bridge_t*);
+static void mangoh_bridge_baudRateFallback(mangoh_bridge_t*);
+static void mangoh_bridge_baudRateTimerHandler(le_timer_Ref_t);
+static void mangoh_bridge_baudDrainTimerHandler(le_timer_Ref_t);
 static int mangoh_bridge_reset(mangoh_bridge_t*);
 static int mangoh_bridge_process_payload(mangoh_bridge_t*);
 static int mangoh_bridge_process_msg(mangoh_bridge_t*);
@@ -29,368 +74,1167 @@ static int mangoh_bridge_excute_resets(mangoh_bridge_t*);
 static void mangoh_bridge_eventHandler(int, short);
 
 static void mangoh_bridge_SigTermEventHandler(int);
+static void mangoh_bridge_SigChldEventHandler(int);
+static void mangoh_bridge_SigUsr1EventHandler(int);
+static void mangoh_bridge_SigUsr2EventHandler(int);
+static int mangoh_bridge_open(mangoh_bridge_t*);
+static void mangoh_bridge_connected(mangoh_bridge_t*);
+static int mangoh_bridge_resolve(mangoh_bridge_t*);
+static void mangoh_bridge_resolveWork(void*);
+static void mangoh_bridge_resolveDone(void*);
+static void mangoh_bridge_started(mangoh_bridge_t*);
+static void mangoh_bridge_scheduleReconnect(mangoh_bridge_t*);
+static void mangoh_bridge_reconnectTimerHandler(le_timer_Ref_t);
 static int mangoh_bridge_start(mangoh_bridge_t*);
 static int mangoh_bridge_stop(mangoh_bridge_t*);
-static int mangoh_bridge_init(mangoh_bridge_t*);
+static int mangoh_bridge_init(mangoh_bridge_t*, const char*, uint32_t);
+static void mangoh_bridge_release(mangoh_bridge_t*);
+static int mangoh_bridge_create(const char*, uint32_t);
 
-static mangoh_bridge_t bridge;
+static le_sls_List_t mangoh_bridge_list;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Baud rates that can be negotiated at reset, in ascending order
+ */
+//------------------------------------------------------------------------------------------------------------------
+static const struct
+{
+    uint32_t rate;
+    speed_t  speed;
+} mangoh_bridge_baudRates[] =
+{
+    { 115200,  B115200 },
+    { 230400,  B230400 },
+    { 460800,  B460800 },
+    { 921600,  B921600 },
+#ifdef B1000000
+    { 1000000, B1000000 },
+#endif
+#ifdef B1500000
+    { 1500000, B1500000 },
+#endif
+#ifdef B2000000
+    { 2000000, B2000000 },
+#endif
+#ifdef B3000000
+    { 3000000, B3000000 },
+#endif
+};
 
 static le_log_TraceRef_t BridgeTraceRef;
 
-static int mangoh_bridge_read(mangoh_bridge_t* bridge, unsigned char* data, unsigned int len)
+static int mangoh_bridge_fillRxRing(mangoh_bridge_t* bridge)
 {
+    mangoh_bridge_serial_ring_t* ring = NULL;
+    struct iovec iov[2];
     int32_t res = LE_OK;
 
     LE_ASSERT(bridge);
-    LE_ASSERT(data);
 
-    FD_ZERO(&bridge->readfds);
-    FD_SET(bridge->serialFd, &bridge->readfds);
-
-    struct timeval tv  = { .tv_sec = 0, .tv_usec = MANGOH_BRIDGE_READ_WAIT_MICROSEC };
-    res = select(bridge->serialFd + 1, &bridge->readfds, NULL, NULL, &tv);
-    if (res < 0)
+    ring = &bridge->rxRing;
+    uint32_t avail = MANGOH_BRIDGE_SERIAL_RX_RING_SIZE - (ring->tail - ring->head);
+    if (!avail)
     {
-        LE_ERROR("ERROR select() failed(%d/%d)", res, errno);
-        res = LE_IO_ERROR;
+        LE_TRACE(BridgeTraceRef, "receive ring full");
         goto cleanup;
     }
 
-    if ((res > 0) && FD_ISSET(bridge->serialFd, &bridge->readfds))
+    // Drain everything the UART has in a single system call, wrapping around the end of the ring
+    uint32_t offset = ring->tail & MANGOH_BRIDGE_SERIAL_RX_RING_MASK;
+    iov[0].iov_base = &ring->data[offset];
+    iov[0].iov_len = (avail < MANGOH_BRIDGE_SERIAL_RX_RING_SIZE - offset) ? avail : MANGOH_BRIDGE_SERIAL_RX_RING_SIZE - offset;
+    iov[1].iov_base = ring->data;
+    iov[1].iov_len = avail - iov[0].iov_len;
+
+    ssize_t bytesRead = mangoh_bridge_transport_readv(&bridge->transport, iov, iov[1].iov_len ? 2 : 1);
+    if ((bytesRead < 0) && ((errno == EINTR) || (errno == EAGAIN)))
+    {
+        goto cleanup;
+    }
+    else if (bytesRead <= 0)
     {
-        unsigned char* ptr = (unsigned char*)data;
-        unsigned int count = len;
+        LE_ERROR("ERROR read '%s' failed(%zd/%d)", bridge->transport.name, bytesRead, errno);
 
-        while (count > 0)
+        // The device went away (e.g. USB serial unplugged), reopen it from a timer so the event loop keeps running
+        res = mangoh_bridge_stop(bridge);
+        if (res)
         {
-            ssize_t bytesRead = read(bridge->serialFd, ptr, count);
-            if (bytesRead > 0)
-            {
-                count -= bytesRead;
-                ptr += bytesRead;
-            }
-            else
-            {
-                LE_ERROR("ERROR read() fd(%d) failed(%zd/%d)", bridge->serialFd, bytesRead, errno);
-                sleep(1);
-
-                res = mangoh_bridge_stop(bridge);
-                if (res)
-                {
-                    LE_ERROR("ERROR mangoh_bridge_stop() failed(%d/%d)", res, errno);
-                    goto cleanup;
-                }
-
-                res = mangoh_bridge_start(bridge);
-                if (res)
-                {
-                    LE_ERROR("ERROR mangoh_bridge_start() failed(%d/%d)", res, errno);
-                    goto cleanup;
-                }
-
-                res = LE_IO_ERROR;
-                goto cleanup;
-            }
+            LE_ERROR("ERROR mangoh_bridge_stop() failed(%d/%d)", res, errno);
         }
 
-        LE_TRACE(BridgeTraceRef, "received(%u)", len);
-        if(LE_IS_TRACE_ENABLED(BridgeTraceRef))
+        mangoh_bridge_scheduleReconnect(bridge);
+        res = LE_IO_ERROR;
+        goto cleanup;
+    }
+
+    LE_TRACE(BridgeTraceRef, "received(%zd)", bytesRead);
+    if(LE_IS_TRACE_ENABLED(BridgeTraceRef))
+    {
+        mangoh_bridge_packet_dumpBuffer(iov[0].iov_base, ((size_t)bytesRead < iov[0].iov_len) ? bytesRead : iov[0].iov_len);
+        if ((size_t)bytesRead > iov[0].iov_len)
         {
-            mangoh_bridge_packet_dumpBuffer(data, len);
+            mangoh_bridge_packet_dumpBuffer(iov[1].iov_base, bytesRead - iov[0].iov_len);
         }
-        res = len;
     }
 
+    ring->tail += bytesRead;
+    res = bytesRead;
+
 cleanup:
     return res;
 }
 
-static int mangoh_bridge_write(const mangoh_bridge_t* bridge, const unsigned char* data, unsigned int len)
+static uint32_t mangoh_bridge_consumeRxRing(mangoh_bridge_t* bridge, unsigned char* data, uint32_t len)
 {
-    int32_t res = LE_OK;
+    mangoh_bridge_serial_ring_t* ring = NULL;
 
     LE_ASSERT(bridge);
     LE_ASSERT(data);
 
-    if(LE_IS_TRACE_ENABLED(BridgeTraceRef))
+    ring = &bridge->rxRing;
+    if (len > ring->tail - ring->head)
     {
-        mangoh_bridge_packet_dumpBuffer(data, len);
+        len = ring->tail - ring->head;
     }
 
-    const unsigned char* ptr = data;
-    unsigned int msgLen = len;
+    uint32_t offset = ring->head & MANGOH_BRIDGE_SERIAL_RX_RING_MASK;
+    uint32_t first = (len < MANGOH_BRIDGE_SERIAL_RX_RING_SIZE - offset) ? len : MANGOH_BRIDGE_SERIAL_RX_RING_SIZE - offset;
+    memcpy(data, &ring->data[offset], first);
+    memcpy(&data[first], ring->data, len - first);
+    ring->head += len;
+
+    return len;
+}
+
+static uint8_t mangoh_bridge_peekRxRing(const mangoh_bridge_t* bridge, uint32_t offset)
+{
+    LE_ASSERT(bridge);
+    LE_ASSERT(offset < bridge->rxRing.tail - bridge->rxRing.head);
+
+    return bridge->rxRing.data[(bridge->rxRing.head + offset) & MANGOH_BRIDGE_SERIAL_RX_RING_MASK];
+}
+
+static void mangoh_bridge_discardRxRing(mangoh_bridge_t* bridge, uint32_t len)
+{
+    LE_ASSERT(bridge);
+    LE_ASSERT(len <= bridge->rxRing.tail - bridge->rxRing.head);
+
+    bridge->rxRing.head += len;
+    bridge->rxStats.discarded += len;
+    bridge->rxStats.skipped += len;
+}
+
+static uint32_t mangoh_bridge_maxPayloadLen(const mangoh_bridge_t* bridge)
+{
+    LE_ASSERT(bridge);
+
+    // An encoded payload carries one extra byte for the encoding type
+    return bridge->packet.dataSize + ((bridge->codec.type != MANGOH_BRIDGE_COMPRESS_NONE) ? MANGOH_BRIDGE_PACKET_CODEC_SIZE:0);
+}
+
+static bool mangoh_bridge_scanRxRing(mangoh_bridge_t* bridge)
+{
+    mangoh_bridge_serial_ring_t* ring = NULL;
+    bool found = false;
+
+    LE_ASSERT(bridge);
 
-    while (msgLen > 0)
+    ring = &bridge->rxRing;
+    while (ring->tail != ring->head)
     {
-        ssize_t bytesWrite = write(bridge->serialFd, ptr, msgLen);
-        if (bytesWrite < 0)
+        // Skip line noise a contiguous run at a time rather than one byte per pass through the state machine
+        uint32_t offset = ring->head & MANGOH_BRIDGE_SERIAL_RX_RING_MASK;
+        uint32_t len = ring->tail - ring->head;
+        len = (len < MANGOH_BRIDGE_SERIAL_RX_RING_SIZE - offset) ? len : MANGOH_BRIDGE_SERIAL_RX_RING_SIZE - offset;
+
+        const uint8_t* start = memchr(&ring->data[offset], MANGOH_BRIDGE_PACKET_START, len);
+        if (!start)
         {
-            LE_ERROR("ERROR write() failed(%zd/%d)", bytesWrite, errno);
-            res = LE_IO_ERROR;
-            goto cleanup;
+            mangoh_bridge_discardRxRing(bridge, len);
+            continue;
+        }
+
+        mangoh_bridge_discardRxRing(bridge, start - &ring->data[offset]);
+
+        // Wait for the whole header, a start byte followed by an impossible length is not a frame
+        if (ring->tail - ring->head < MANGOH_BRIDGE_RX_HEADER_SIZE)
+        {
+            break;
+        }
+
+        uint16_t msgLen = (mangoh_bridge_peekRxRing(bridge, MANGOH_BRIDGE_RX_HEADER_SIZE - 2) << 8) |
+                          mangoh_bridge_peekRxRing(bridge, MANGOH_BRIDGE_RX_HEADER_SIZE - 1);
+        if (msgLen > mangoh_bridge_maxPayloadLen(bridge))
+        {
+            LE_TRACE(BridgeTraceRef, "start byte with invalid length(%u) skipped", msgLen);
+            bridge->rxStats.lenErrors++;
+            mangoh_bridge_discardRxRing(bridge, sizeof(bridge->packet.rx.start));
+            continue;
+        }
+
+        if (bridge->rxStats.skipped)
+        {
+            LE_DEBUG("resync skipped(%u) discarded(%u) CRC errors(%u) length errors(%u)",
+                     bridge->rxStats.skipped, bridge->rxStats.discarded, bridge->rxStats.crcErrors, bridge->rxStats.lenErrors);
+            bridge->rxStats.skipped = 0;
         }
 
-        msgLen -= bytesWrite;
-        ptr += bytesWrite;
+        ring->mark = ring->head;
+        found = true;
+        break;
     }
 
-cleanup:
-    return res;
+    return found;
 }
 
-static int mangoh_bridge_process_msg_idx(mangoh_bridge_t* bridge)
+static void mangoh_bridge_rewindRxRing(mangoh_bridge_t* bridge)
 {
-    int32_t res = LE_OK;
+    mangoh_bridge_serial_ring_t* ring = NULL;
 
     LE_ASSERT(bridge);
 
-    res = mangoh_bridge_read(bridge, &bridge->packet.msg.idx, sizeof(bridge->packet.msg.idx));
-    if (res < 0)
+    // Rescan from just after the start byte of the rejected frame, the real start may be inside it.  Not possible once
+    // the frame bytes have been overwritten by newer input.
+    ring = &bridge->rxRing;
+    if ((ring->tail - ring->mark <= MANGOH_BRIDGE_SERIAL_RX_RING_SIZE) && (ring->head - ring->mark > sizeof(bridge->packet.rx.start)))
     {
-        LE_ERROR("ERROR mangoh_bridge_read() failed(%d)", res);
-        goto cleanup;
+        LE_TRACE(BridgeTraceRef, "rewind(%u)", ring->head - ring->mark - (uint32_t)sizeof(bridge->packet.rx.start));
+        ring->head = ring->mark + sizeof(bridge->packet.rx.start);
+        bridge->rxStats.skipped += sizeof(bridge->packet.rx.start);
+        bridge->rxStats.discarded += sizeof(bridge->packet.rx.start);
     }
+}
 
-    LE_TRACE(BridgeTraceRef, "message index(%u)", bridge->packet.msg.idx);
-    bridge->packet.crc = mangoh_bridge_packet_crcUpdate(bridge->packet.crc, &bridge->packet.msg.idx, sizeof(bridge->packet.msg.idx));
-    res = LE_OK;
+static bool mangoh_bridge_rxField(mangoh_bridge_t* bridge, void* field, uint32_t len)
+{
+    LE_ASSERT(bridge);
+    LE_ASSERT(field);
 
-cleanup:
-    return res;
+    // Fields may arrive split over several events, accumulate until the field is complete
+    bridge->rxCount += mangoh_bridge_consumeRxRing(bridge, (unsigned char*)field + bridge->rxCount, len - bridge->rxCount);
+    return bridge->rxCount == len;
 }
 
-static int mangoh_bridge_process_payload_len(mangoh_bridge_t* bridge)
+static void mangoh_bridge_setRxState(mangoh_bridge_t* bridge, mangoh_bridge_rx_state_t state)
+{
+    LE_ASSERT(bridge);
+
+    bridge->rxState = state;
+    bridge->rxCount = 0;
+}
+
+static int mangoh_bridge_write(mangoh_bridge_t* bridge, struct iovec* iov, int iovcnt)
 {
+    mangoh_bridge_tx_ring_t* ring = NULL;
     int32_t res = LE_OK;
+    uint32_t len = 0;
+    int idx = 0;
 
     LE_ASSERT(bridge);
+    LE_ASSERT(iov);
 
-    res = mangoh_bridge_read(bridge, (unsigned char*)&bridge->packet.msg.len, sizeof(bridge->packet.msg.len));
-    if (res < 0)
+    if (bridge->transport.fd == MANGOH_BRIDGE_TRANSPORT_FD_INVALID)
     {
-        LE_ERROR("ERROR mangoh_bridge_read() failed(%d)", res);
+        LE_ERROR("ERROR '%s' not open", bridge->transport.name);
+        res = LE_IO_ERROR;
         goto cleanup;
     }
 
-    bridge->packet.crc = mangoh_bridge_packet_crcUpdate(bridge->packet.crc, (unsigned char*)&bridge->packet.msg.len, sizeof(bridge->packet.msg.len));
-    bridge->packet.msg.len = ntohs(bridge->packet.msg.len);
-    if (bridge->packet.msg.len > sizeof(bridge->packet.msg.data))
+    for (idx = 0; idx < iovcnt; idx++)
     {
-        LE_ERROR("ERROR invalid payload length(0x%04x > %u)", bridge->packet.msg.len, MANGOH_BRIDGE_PACKET_DATA_SIZE);
-        res = LE_OUT_OF_RANGE;
+        len += iov[idx].iov_len;
+        if(LE_IS_TRACE_ENABLED(BridgeTraceRef))
+        {
+            mangoh_bridge_packet_dumpBuffer(iov[idx].iov_base, iov[idx].iov_len);
+        }
+    }
+
+    ring = &bridge->txRing;
+    if (len > mangoh_bridge_queue_room(&ring->queue))
+    {
+        LE_WARN("WARNING transmit ring full, response length(%u) refused", len);
+        res = LE_WOULD_BLOCK;
         goto cleanup;
     }
 
-    if (bridge->packet.msg.len)
+    if (!mangoh_bridge_queue_len(&ring->queue))
     {
-        LE_TRACE(BridgeTraceRef, "payload length(%u)", bridge->packet.msg.len);
-        LE_TRACE(BridgeTraceRef, "---> payload");
+        le_fdMonitor_Enable(bridge->fdMonitor, POLLOUT);
+    }
 
-        memset(bridge->packet.msg.data, 0, sizeof(bridge->packet.msg.data));
-        res = mangoh_bridge_read(bridge, bridge->packet.msg.data, bridge->packet.msg.len);
-        if (res < 0)
-        {
-            LE_ERROR("ERROR mangoh_bridge_read() failed(%d)", res);
-            goto cleanup;
-        }
+    for (idx = 0; idx < iovcnt; idx++)
+    {
+        mangoh_bridge_queue_write(&ring->queue, iov[idx].iov_base, iov[idx].iov_len);
     }
 
-    bridge->packet.crc = mangoh_bridge_packet_crcUpdate(bridge->packet.crc, bridge->packet.msg.data, bridge->packet.msg.len);
-    res = LE_OK;
+    mangoh_bridge_capture_add(&bridge->capture, MANGOH_BRIDGE_CAPTURE_TX, iov, iovcnt);
 
 cleanup:
     return res;
 }
 
-static int mangoh_bridge_process_crc(mangoh_bridge_t* bridge)
+static bool mangoh_bridge_txRingHasRoom(const mangoh_bridge_t* bridge)
 {
+    LE_ASSERT(bridge);
+
+    const uint32_t frameLen = MANGOH_BRIDGE_RX_HEADER_SIZE + mangoh_bridge_maxPayloadLen(bridge) + sizeof(uint16_t);
+    return (mangoh_bridge_queue_room(&bridge->txRing.queue) >= frameLen);
+}
+
+static int mangoh_bridge_drainTxRing(mangoh_bridge_t* bridge)
+{
+    mangoh_bridge_tx_ring_t* ring = NULL;
+    struct iovec iov[MANGOH_BRIDGE_QUEUE_NUM_IOVS];
     int32_t res = LE_OK;
 
     LE_ASSERT(bridge);
 
-    res = mangoh_bridge_read(bridge, (unsigned char*)&bridge->packet.msg.crc, sizeof(bridge->packet.msg.crc));
-    if (res < 0)
+    ring = &bridge->txRing;
+    uint32_t used = mangoh_bridge_queue_len(&ring->queue);
+    if (!used)
     {
-        LE_ERROR("ERROR mangoh_bridge_read() failed(%d)", res);
         goto cleanup;
     }
 
-    bridge->packet.msg.crc = ntohs(bridge->packet.msg.crc);
-    LE_TRACE(BridgeTraceRef, "CRC (0x%04x/0x%04x)", bridge->packet.crc, bridge->packet.msg.crc);
-
-    if (bridge->packet.crc != bridge->packet.msg.crc)
+    // Write as much as the port accepts in a single system call, wrapping around the end of the ring
+    int iovcnt = mangoh_bridge_queue_readIov(&ring->queue, iov, used);
+    ssize_t bytesWrite = mangoh_bridge_transport_writev(&bridge->transport, iov, iovcnt);
+    if (bytesWrite < 0)
     {
-        LE_ERROR("ERROR invalid crc(0x%04x != 0x%04x)", bridge->packet.crc, bridge->packet.msg.crc);
-        res = LE_BAD_PARAMETER;
+        if ((errno == EINTR) || (errno == EAGAIN))
+        {
+            goto cleanup;
+        }
+
+        LE_ERROR("ERROR writev() failed(%zd/%d)", bytesWrite, errno);
+        mangoh_bridge_clearTxRing(bridge);
+        res = LE_IO_ERROR;
         goto cleanup;
     }
 
-    res = LE_OK;
+    LE_TRACE(BridgeTraceRef, "sent(%zd/%u)", bytesWrite, used);
+    mangoh_bridge_queue_consume(&ring->queue, bytesWrite);
+    if (!mangoh_bridge_queue_len(&ring->queue))
+    {
+        le_fdMonitor_Disable(bridge->fdMonitor, POLLOUT);
+
+        res = mangoh_bridge_switchBaudRate(bridge);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_switchBaudRate() failed(%d)", res);
+            goto cleanup;
+        }
+    }
+
+    if (ring->stalled && mangoh_bridge_txRingHasRoom(bridge))
+    {
+        LE_TRACE(BridgeTraceRef, "receive resumed");
+        ring->stalled = false;
+        le_fdMonitor_Enable(bridge->fdMonitor, POLLIN);
+    }
 
 cleanup:
     return res;
 }
 
-static int mangoh_bridge_process_cmd(mangoh_bridge_t* bridge)
+static void mangoh_bridge_clearTxRing(mangoh_bridge_t* bridge)
 {
-    int32_t res = LE_OK;
-
     LE_ASSERT(bridge);
 
-    mangoh_bridge_packet_data_t* req = (mangoh_bridge_packet_data_t*)bridge->packet.msg.data;
-    LE_TRACE(BridgeTraceRef, "command(0x%02x)", req->cmd);
-
-    if (!bridge->cmdHdlrs[req->cmd].fcn || !bridge->cmdHdlrs[req->cmd].module)
+    if ((bridge->transport.fd != MANGOH_BRIDGE_TRANSPORT_FD_INVALID) && bridge->fdMonitor)
     {
-        LE_ERROR("ERROR unsupported command(0x%02x)", req->cmd);
-
-        res = mangoh_bridge_sendNack(bridge);
-        if (res != LE_OK)
+        if (mangoh_bridge_queue_len(&bridge->txRing.queue))
         {
-            LE_ERROR("ERROR mangoh_bridge_sendNack() failed(%d)", res);
-            goto cleanup;
+            le_fdMonitor_Disable(bridge->fdMonitor, POLLOUT);
         }
 
-        res = LE_BAD_PARAMETER;
-        goto cleanup;
+        if (bridge->txRing.stalled)
+        {
+            le_fdMonitor_Enable(bridge->fdMonitor, POLLIN);
+        }
     }
 
-    res = bridge->cmdHdlrs[req->cmd].fcn(bridge->cmdHdlrs[req->cmd].module, req->buffer, bridge->packet.msg.len - sizeof(req->cmd));
-    if (res != LE_OK)
+    mangoh_bridge_queue_clear(&bridge->txRing.queue);
+    bridge->txRing.stalled = false;
+}
+
+static int mangoh_bridge_process_msg_start(mangoh_bridge_t* bridge)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(bridge);
+
+    LE_TRACE(BridgeTraceRef, "read 0x%02x", bridge->packet.rx.start);
+    if (bridge->packet.rx.start != MANGOH_BRIDGE_PACKET_START)
     {
-        LE_ERROR("ERROR command processor('%c') failed(%d)", req->cmd, res);
+        mangoh_bridge_setRxState(bridge, MANGOH_BRIDGE_RX_STATE_START);
         goto cleanup;
     }
 
+    bridge->packet.crc = MANGOH_BRIDGE_PACKET_CRC_RESET;
+    bridge->packet.crc = mangoh_bridge_packet_crcUpdate(bridge->packet.crc, &bridge->packet.rx.start, sizeof(bridge->packet.rx.start));
+    mangoh_bridge_setRxState(bridge, MANGOH_BRIDGE_RX_STATE_IDX);
+
 cleanup:
     return res;
 }
 
-static int mangoh_bridge_close(mangoh_bridge_t* bridge)
+static int mangoh_bridge_process_msg_idx(mangoh_bridge_t* bridge)
 {
     int32_t res = LE_OK;
 
     LE_ASSERT(bridge);
 
-    LE_INFO("---> CLOSE");
-    if (bridge->packet.msg.len != sizeof(bridge->packet.close))
+    LE_TRACE(BridgeTraceRef, "message index(%u)", bridge->packet.rx.idx);
+    bridge->packet.crc = mangoh_bridge_packet_crcUpdate(bridge->packet.crc, &bridge->packet.rx.idx, sizeof(bridge->packet.rx.idx));
+    mangoh_bridge_setRxState(bridge, MANGOH_BRIDGE_RX_STATE_LEN);
+
+    return res;
+}
+
+static int mangoh_bridge_process_payload_len(mangoh_bridge_t* bridge)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(bridge);
+
+    bridge->packet.crc = mangoh_bridge_packet_crcUpdate(bridge->packet.crc, (unsigned char*)&bridge->packet.rx.len, sizeof(bridge->packet.rx.len));
+    bridge->packet.rx.len = ntohs(bridge->packet.rx.len);
+
+    uint32_t maxLen = mangoh_bridge_maxPayloadLen(bridge);
+    if (bridge->packet.rx.len > maxLen)
     {
-        LE_ERROR("ERROR invalid close command length(%u != %zu)", bridge->packet.msg.len, sizeof(bridge->packet.close));
-        res = LE_BAD_PARAMETER;
+        LE_ERROR("ERROR invalid payload length(0x%04x > %u)", bridge->packet.rx.len, maxLen);
+        res = LE_OUT_OF_RANGE;
         goto cleanup;
     }
 
-    res = mangoh_bridge_sendAck(bridge);
-    if (res != LE_OK)
+    // Handlers treat string payloads as NUL terminated, clearing the whole (large) buffer is not needed
+    memset(bridge->packet.rx.data, 0, (bridge->packet.rx.len < sizeof(bridge->packet.rx.data)) ? bridge->packet.rx.len + 1:sizeof(bridge->packet.rx.data));
+    if (bridge->packet.rx.len)
     {
-          LE_ERROR("ERROR mangoh_bridge_sendAck() failed(%d)", res);
-        goto cleanup;
+        LE_TRACE(BridgeTraceRef, "payload length(%u)", bridge->packet.rx.len);
+        LE_TRACE(BridgeTraceRef, "---> payload");
+        mangoh_bridge_setRxState(bridge, MANGOH_BRIDGE_RX_STATE_PAYLOAD);
+    }
+    else
+    {
+        mangoh_bridge_setRxState(bridge, MANGOH_BRIDGE_RX_STATE_CRC);
     }
-
-    bridge->closed = true;
 
 cleanup:
     return res;
 }
 
-static int mangoh_bridge_reset(mangoh_bridge_t* bridge)
+static int mangoh_bridge_process_payload_data(mangoh_bridge_t* bridge)
 {
-    unsigned int rxVersion[MANGOH_BRIDGE_PACKET_VERSION_SIZE] = {0};
     int32_t res = LE_OK;
 
     LE_ASSERT(bridge);
 
-    LE_INFO("---> RESET");
-    if (bridge->packet.msg.len != sizeof(bridge->packet.reset) + MANGOH_BRIDGE_PACKET_VERSION_SIZE)
-    {
-        LE_ERROR("ERROR invalid reset command length(%u != %zu)",
-                bridge->packet.msg.len, sizeof(bridge->packet.reset) + MANGOH_BRIDGE_PACKET_VERSION_SIZE);
+    bridge->packet.crc = mangoh_bridge_packet_crcUpdate(bridge->packet.crc, bridge->packet.rx.data, bridge->packet.rx.len);
+    mangoh_bridge_setRxState(bridge, MANGOH_BRIDGE_RX_STATE_CRC);
 
-        res = mangoh_bridge_sendNack(bridge);
-        if (res != LE_OK)
-        {
-            LE_ERROR("ERROR mangoh_bridge_sendNack() failed(%d)", res);
-            goto cleanup;
-        }
+    return res;
+}
 
-        res = LE_BAD_PARAMETER;
-        goto cleanup;
+static void mangoh_bridge_captureRx(mangoh_bridge_t* bridge, uint8_t flags)
+{
+    mangoh_bridge_serial_ring_t* ring = NULL;
+
+    LE_ASSERT(bridge);
+
+    // The frame is still in the receive ring unless it was larger than the ring
+    ring = &bridge->rxRing;
+    if (ring->tail - ring->mark > MANGOH_BRIDGE_SERIAL_RX_RING_SIZE)
+    {
+        return;
     }
 
-    rxVersion[0] = bridge->packet.msg.data[sizeof(bridge->packet.reset)] - '0';
-    rxVersion[1] = bridge->packet.msg.data[sizeof(bridge->packet.reset) + 1] - '0';
-    rxVersion[2] = bridge->packet.msg.data[sizeof(bridge->packet.reset) + 2] - '0';
+    const uint32_t offset = ring->mark & MANGOH_BRIDGE_SERIAL_RX_RING_MASK;
+    const uint32_t len = ring->head - ring->mark;
+    const uint32_t first = (len < MANGOH_BRIDGE_SERIAL_RX_RING_SIZE - offset) ? len : MANGOH_BRIDGE_SERIAL_RX_RING_SIZE - offset;
+    const struct iovec iov[] =
+    {
+        { .iov_base = &ring->data[offset], .iov_len = first },
+        { .iov_base = ring->data,          .iov_len = len - first },
+    };
 
-    LE_INFO("Rx version %u.%u.%u", rxVersion[0], rxVersion[1], rxVersion[2]);
-    if (memcmp(&bridge->packet.msg.data[sizeof(bridge->packet.reset)], bridge->packet.version, sizeof(bridge->packet.version)))
+    mangoh_bridge_capture_add(&bridge->capture, flags, iov, NUM_ARRAY_MEMBERS(iov));
+}
+
+static int mangoh_bridge_process_crc(mangoh_bridge_t* bridge)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(bridge);
+
+    mangoh_bridge_setRxState(bridge, MANGOH_BRIDGE_RX_STATE_START);
+
+    bridge->packet.rx.crc = ntohs(bridge->packet.rx.crc);
+    LE_TRACE(BridgeTraceRef, "CRC (0x%04x/0x%04x)", bridge->packet.crc, bridge->packet.rx.crc);
+
+    mangoh_bridge_captureRx(bridge, (bridge->packet.crc != bridge->packet.rx.crc) ?
+                            MANGOH_BRIDGE_CAPTURE_RX | MANGOH_BRIDGE_CAPTURE_CRC_ERROR:MANGOH_BRIDGE_CAPTURE_RX);
+
+    if (bridge->packet.crc != bridge->packet.rx.crc)
     {
-        LE_ERROR("ERROR unsupported version(%u.%u.%u != %c.%c.%c)",
-                rxVersion[0], rxVersion[1], rxVersion[2],
-                bridge->packet.version[0], bridge->packet.version[1], bridge->packet.version[2]);
+        LE_ERROR("ERROR invalid crc(0x%04x != 0x%04x)", bridge->packet.crc, bridge->packet.rx.crc);
+        bridge->rxStats.crcErrors++;
+        mangoh_bridge_rewindRxRing(bridge);
 
-        res = mangoh_bridge_sendNack(bridge);
-        if (res != LE_OK)
+        // Repeated CRC failures at a negotiated rate mean the MCU is not talking at that rate (anymore)
+        bridge->baud.crcErrors++;
+        if ((bridge->baud.rate != MANGOH_BRIDGE_BAUD_DEFAULT) && (bridge->baud.crcErrors >= MANGOH_BRIDGE_BAUD_FALLBACK_CRC_ERRORS))
         {
-            LE_ERROR("ERROR mangoh_bridge_sendNack() failed(%d)", res);
-            goto cleanup;
+            mangoh_bridge_baudRateFallback(bridge);
         }
 
         res = LE_BAD_PARAMETER;
         goto cleanup;
     }
 
-    res = mangoh_bridge_excute_resets(bridge);
+    bridge->baud.crcErrors = 0;
+    if (bridge->baud.verifying)
+    {
+        LE_INFO("baud rate(%u) verified", bridge->baud.rate);
+        le_timer_Stop(bridge->baud.timer);
+        bridge->baud.verifying = false;
+    }
+
+    res = mangoh_bridge_decodePayload(bridge);
     if (res != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_excute_resets() failed(%d)", res);
+        LE_ERROR("ERROR mangoh_bridge_decodePayload() failed(%d)", res);
         goto cleanup;
     }
 
-    unsigned char* result = bridge->packet.msg.data;
-    result[0] = res;
-    memcpy(&result[1], bridge->packet.version, sizeof(bridge->packet.version));
-    LE_TRACE(BridgeTraceRef, "result(%d) version(%u.%u.%u)", result[0], result[1] - '0', result[2] - '0', result[3] - '0');
-    res = mangoh_bridge_sendResult(bridge, sizeof(uint8_t) + sizeof(bridge->packet.version));
+    res = mangoh_bridge_process_payload(bridge);
     if (res != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_sendResult() failed(%d)", res);
+        LE_ERROR("ERROR mangoh_bridge_process_payload() failed(%d)", res);
         goto cleanup;
     }
 
-    bridge->closed = false;
-
 cleanup:
     return res;
 }
 
-static int mangoh_bridge_process_payload(mangoh_bridge_t* bridge)
+static int mangoh_bridge_decodePayload(mangoh_bridge_t* bridge)
 {
     int32_t res = LE_OK;
 
     LE_ASSERT(bridge);
 
-    if (bridge->closed)
+    if ((bridge->codec.type == MANGOH_BRIDGE_COMPRESS_NONE) || !bridge->packet.rx.len)
     {
-        if (!memcmp(bridge->packet.msg.data, bridge->packet.reset, sizeof(bridge->packet.reset)))
-        {
-            res = mangoh_bridge_reset(bridge);
-            if (res != LE_OK)
-            {
-                LE_ERROR("ERROR mangoh_bridge_reset() failed(%d)", res);
-                goto cleanup;
-            }
-        }
-        else
+        goto cleanup;
+    }
+
+    const uint32_t len = bridge->packet.rx.len - MANGOH_BRIDGE_PACKET_CODEC_SIZE;
+    switch (bridge->packet.rx.data[0])
+    {
+    case MANGOH_BRIDGE_COMPRESS_NONE:
+        memmove(bridge->packet.rx.data, &bridge->packet.rx.data[MANGOH_BRIDGE_PACKET_CODEC_SIZE], len);
+        bridge->packet.rx.len = len;
+        break;
+
+    case MANGOH_BRIDGE_COMPRESS_LZSS:
+    {
+        uint32_t decodedLen = 0;
+        res = mangoh_bridge_compress_decode(&bridge->packet.rx.data[MANGOH_BRIDGE_PACKET_CODEC_SIZE], len,
+                                            bridge->codec.buff, bridge->packet.dataSize, &decodedLen);
+        if (res != LE_OK)
         {
-            LE_ERROR("ERROR unexpected command");
-            mangoh_bridge_packet_dumpBuffer(bridge->packet.msg.data, bridge->packet.msg.len);
-            res = LE_BAD_PARAMETER;
+            LE_ERROR("ERROR mangoh_bridge_compress_decode() failed(%d)", res);
             goto cleanup;
         }
+
+        LE_TRACE(BridgeTraceRef, "decoded length(%u -> %u)", len, decodedLen);
+        memcpy(bridge->packet.rx.data, bridge->codec.buff, decodedLen);
+        bridge->packet.rx.len = decodedLen;
+        break;
     }
-    else
+
+    default:
+        // Not encoded, e.g. a reset from an MCU that rebooted and has not negotiated compression (yet)
+        goto cleanup;
+    }
+
+    // Handlers treat string payloads as NUL terminated
+    if (bridge->packet.rx.len < sizeof(bridge->packet.rx.data))
     {
-        if (!memcmp(bridge->packet.msg.data, bridge->packet.close, sizeof(bridge->packet.close)))
+        bridge->packet.rx.data[bridge->packet.rx.len] = 0;
+    }
+
+cleanup:
+    return res;
+}
+
+static void mangoh_bridge_encodePayload(mangoh_bridge_t* bridge, uint32_t* len)
+{
+    LE_ASSERT(bridge);
+    LE_ASSERT(len);
+
+    if (bridge->codec.type == MANGOH_BRIDGE_COMPRESS_NONE)
+    {
+        return;
+    }
+
+    // Only worth sending compressed when it saves at least the encoding type byte
+    uint32_t encodedLen = 0;
+    if ((bridge->codec.type == MANGOH_BRIDGE_COMPRESS_LZSS) && (*len > MANGOH_BRIDGE_PACKET_CODEC_SIZE) &&
+        (mangoh_bridge_compress_encode(bridge->packet.tx.data, *len, bridge->codec.buff, *len - MANGOH_BRIDGE_PACKET_CODEC_SIZE, &encodedLen) == LE_OK))
+    {
+        LE_TRACE(BridgeTraceRef, "encoded length(%u -> %u)", *len, encodedLen);
+        bridge->packet.tx.data[0] = MANGOH_BRIDGE_COMPRESS_LZSS;
+        memcpy(&bridge->packet.tx.data[MANGOH_BRIDGE_PACKET_CODEC_SIZE], bridge->codec.buff, encodedLen);
+        *len = encodedLen + MANGOH_BRIDGE_PACKET_CODEC_SIZE;
+    }
+    else
+    {
+        memmove(&bridge->packet.tx.data[MANGOH_BRIDGE_PACKET_CODEC_SIZE], bridge->packet.tx.data, *len);
+        bridge->packet.tx.data[0] = MANGOH_BRIDGE_COMPRESS_NONE;
+        *len += MANGOH_BRIDGE_PACKET_CODEC_SIZE;
+    }
+}
+
+static mangoh_bridge_rsp_cache_t* mangoh_bridge_findResponse(mangoh_bridge_t* bridge, uint8_t idx)
+{
+    mangoh_bridge_rsp_cache_t* rsp = NULL;
+    uint32_t slot = 0;
+
+    LE_ASSERT(bridge);
+
+    for (slot = 0; slot < bridge->window.size; slot++)
+    {
+        if (bridge->window.rsp[slot].valid && (bridge->window.rsp[slot].idx == idx))
+        {
+            rsp = &bridge->window.rsp[slot];
+            break;
+        }
+    }
+
+    return rsp;
+}
+
+static void mangoh_bridge_clearResponses(mangoh_bridge_t* bridge)
+{
+    uint32_t slot = 0;
+
+    LE_ASSERT(bridge);
+
+    for (slot = 0; slot < MANGOH_BRIDGE_WINDOW_MAX; slot++)
+    {
+        bridge->window.rsp[slot].valid = false;
+    }
+
+    bridge->window.next = 0;
+}
+
+static void mangoh_bridge_clearDeferred(mangoh_bridge_t* bridge)
+{
+    LE_ASSERT(bridge);
+
+    memset(bridge->deferred.inFlight, 0, sizeof(bridge->deferred.inFlight));
+    bridge->deferred.generation++;
+}
+
+static int mangoh_bridge_replay(mangoh_bridge_t* bridge, const mangoh_bridge_rsp_cache_t* rsp)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(bridge);
+    LE_ASSERT(rsp);
+
+    LE_INFO("<--- REPLAY index(%u) length(%u)", rsp->idx, rsp->len);
+    struct iovec iov = { .iov_base = (void*)rsp->data, .iov_len = rsp->len };
+
+    res = mangoh_bridge_write(bridge, &iov, 1);
+    if (res)
+    {
+        LE_ERROR("ERROR mangoh_bridge_write() failed(%d)", res);
+        goto cleanup;
+    }
+
+cleanup:
+    return res;
+}
+
+static int mangoh_bridge_process_cmd(mangoh_bridge_t* bridge)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(bridge);
+
+    mangoh_bridge_packet_data_t* req = (mangoh_bridge_packet_data_t*)bridge->packet.rx.data;
+    LE_TRACE(BridgeTraceRef, "command(0x%02x)", req->cmd);
+
+    // The MCU retransmits with the same index when it missed our reply, resend it instead of running the command again
+    const mangoh_bridge_rsp_cache_t* cached = mangoh_bridge_findResponse(bridge, bridge->packet.rx.idx);
+    if (cached)
+    {
+        res = mangoh_bridge_replay(bridge, cached);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_replay() failed(%d)", res);
+            goto cleanup;
+        }
+
+        goto cleanup;
+    }
+
+    // A retransmitted request still being worked on is answered when its work completes
+    if (bridge->deferred.inFlight[bridge->packet.rx.idx])
+    {
+        LE_INFO("---> IN PROGRESS index(%u)", bridge->packet.rx.idx);
+        goto cleanup;
+    }
+
+    mangoh_bridge_stats_begin(&bridge->stats, req->cmd, bridge->packet.rx.len - sizeof(req->cmd));
+
+    if (!bridge->cmdHdlrs[req->cmd].fcn || !bridge->cmdHdlrs[req->cmd].module)
+    {
+        LE_ERROR("ERROR unsupported command(0x%02x)", req->cmd);
+
+        res = mangoh_bridge_sendNack(bridge);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_sendNack() failed(%d)", res);
+            goto cleanup;
+        }
+
+        res = LE_BAD_PARAMETER;
+        goto cleanup;
+    }
+
+    res = bridge->cmdHdlrs[req->cmd].fcn(bridge->cmdHdlrs[req->cmd].module, req->buffer, bridge->packet.rx.len - sizeof(req->cmd));
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR command processor('%c') failed(%d)", req->cmd, res);
+        goto cleanup;
+    }
+
+cleanup:
+    mangoh_bridge_stats_end(&bridge->stats, res);
+    return res;
+}
+
+static int mangoh_bridge_close(mangoh_bridge_t* bridge)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(bridge);
+
+    LE_INFO("---> CLOSE");
+    if (bridge->packet.rx.len != sizeof(bridge->packet.close))
+    {
+        LE_ERROR("ERROR invalid close command length(%u != %zu)", bridge->packet.rx.len, sizeof(bridge->packet.close));
+        res = LE_BAD_PARAMETER;
+        goto cleanup;
+    }
+
+    res = mangoh_bridge_sendAck(bridge);
+    if (res != LE_OK)
+    {
+          LE_ERROR("ERROR mangoh_bridge_sendAck() failed(%d)", res);
+        goto cleanup;
+    }
+
+    bridge->closed = true;
+
+cleanup:
+    return res;
+}
+
+static uint32_t mangoh_bridge_negotiateBaudRate(uint32_t requested)
+{
+    uint32_t rate = MANGOH_BRIDGE_BAUD_DEFAULT;
+    uint32_t idx = 0;
+
+    // Highest supported rate that does not exceed the MCU request
+    for (idx = 0; idx < NUM_ARRAY_MEMBERS(mangoh_bridge_baudRates); idx++)
+    {
+        if (mangoh_bridge_baudRates[idx].rate > requested)
+        {
+            break;
+        }
+
+        rate = mangoh_bridge_baudRates[idx].rate;
+    }
+
+    return rate;
+}
+
+static int mangoh_bridge_setBaudRate(mangoh_bridge_t* bridge, uint32_t rate)
+{
+    speed_t speed = B0;
+    uint32_t idx = 0;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(bridge);
+
+    for (idx = 0; idx < NUM_ARRAY_MEMBERS(mangoh_bridge_baudRates); idx++)
+    {
+        if (mangoh_bridge_baudRates[idx].rate == rate)
+        {
+            speed = mangoh_bridge_baudRates[idx].speed;
+            break;
+        }
+    }
+
+    if (speed == B0)
+    {
+        LE_ERROR("ERROR unsupported baud rate(%u)", rate);
+        res = LE_BAD_PARAMETER;
+        goto cleanup;
+    }
+
+    res = mangoh_bridge_transport_setSpeed(&bridge->transport, speed);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_transport_setSpeed() failed(%d)", res);
+        goto cleanup;
+    }
+
+    LE_INFO("baud rate(%u -> %u)", bridge->baud.rate, rate);
+    bridge->rxRing.head = 0;
+    bridge->rxRing.tail = 0;
+    bridge->baud.rate = rate;
+    bridge->baud.crcErrors = 0;
+
+cleanup:
+    return res;
+}
+
+static int mangoh_bridge_switchBaudRate(mangoh_bridge_t* bridge)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(bridge);
+
+    if (!bridge->baud.next || mangoh_bridge_queue_len(&bridge->txRing.queue))
+    {
+        // Checked again when the transmit ring is empty
+        le_timer_Stop(bridge->baud.drainTimer);
+        bridge->baud.drainPolls = 0;
+        goto cleanup;
+    }
+
+    // The reply acknowledging the rate must leave the UART at the old one, polled so the event loop does not wait for it
+    uint32_t pending = 0;
+    res = mangoh_bridge_transport_outputPending(&bridge->transport, &pending);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_transport_outputPending() failed(%d)", res);
+        pending = 0;
+    }
+
+    if (pending)
+    {
+        if (bridge->baud.drainPolls < MANGOH_BRIDGE_BAUD_DRAIN_MAX_POLLS)
+        {
+            if (!bridge->baud.drainPolls++)
+            {
+                le_timer_Restart(bridge->baud.drainTimer);
+            }
+
+            res = LE_OK;
+            goto cleanup;
+        }
+
+        LE_WARN("WARNING output(%u) not drained, switching baud rate", pending);
+    }
+
+    le_timer_Stop(bridge->baud.drainTimer);
+    bridge->baud.drainPolls = 0;
+
+    const uint32_t rate = bridge->baud.next;
+    bridge->baud.next = 0;
+
+    res = mangoh_bridge_setBaudRate(bridge, rate);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_setBaudRate() failed(%d)", res);
+        goto cleanup;
+    }
+
+    mangoh_bridge_setRxState(bridge, MANGOH_BRIDGE_RX_STATE_START);
+    bridge->baud.verifying = (rate != MANGOH_BRIDGE_BAUD_DEFAULT);
+    if (bridge->baud.verifying)
+    {
+        le_timer_Restart(bridge->baud.timer);
+    }
+
+cleanup:
+    return res;
+}
+
+static void mangoh_bridge_baudRateFallback(mangoh_bridge_t* bridge)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(bridge);
+
+    LE_WARN("WARNING baud rate(%u) failed, falling back to %u", bridge->baud.rate, MANGOH_BRIDGE_BAUD_DEFAULT);
+    le_timer_Stop(bridge->baud.timer);
+    bridge->baud.verifying = false;
+
+    res = mangoh_bridge_setBaudRate(bridge, MANGOH_BRIDGE_BAUD_DEFAULT);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_setBaudRate() failed(%d)", res);
+    }
+
+    mangoh_bridge_setRxState(bridge, MANGOH_BRIDGE_RX_STATE_START);
+}
+
+static void mangoh_bridge_baudRateTimerHandler(le_timer_Ref_t timer)
+{
+    mangoh_bridge_t* bridge = le_timer_GetContextPtr(timer);
+
+    LE_ASSERT(bridge);
+
+    if (bridge->baud.verifying)
+    {
+        LE_ERROR("ERROR no valid frame at baud rate(%u)", bridge->baud.rate);
+        mangoh_bridge_baudRateFallback(bridge);
+    }
+}
+
+static void mangoh_bridge_baudDrainTimerHandler(le_timer_Ref_t timer)
+{
+    mangoh_bridge_t* bridge = le_timer_GetContextPtr(timer);
+
+    LE_ASSERT(bridge);
+
+    int32_t res = mangoh_bridge_switchBaudRate(bridge);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_switchBaudRate() failed(%d)", res);
+    }
+}
+
+static int mangoh_bridge_reset(mangoh_bridge_t* bridge)
+{
+    unsigned int rxVersion[MANGOH_BRIDGE_PACKET_VERSION_SIZE] = {0};
+    const uint32_t minLen = sizeof(bridge->packet.reset) + MANGOH_BRIDGE_PACKET_VERSION_SIZE;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(bridge);
+
+    LE_INFO("---> RESET");
+
+    // A reset restarts negotiation, the reply (or NACK) goes out unencoded
+    bridge->codec.type = MANGOH_BRIDGE_COMPRESS_NONE;
+
+    if (bridge->packet.rx.len < minLen)
+    {
+        LE_ERROR("ERROR invalid reset command length(%u < %u)", bridge->packet.rx.len, minLen);
+        goto nack;
+    }
+
+    const unsigned char* ptr = &bridge->packet.rx.data[sizeof(bridge->packet.reset)];
+    uint32_t extLen = bridge->packet.rx.len - minLen;
+
+    rxVersion[0] = ptr[0] - '0';
+    rxVersion[1] = ptr[1] - '0';
+    rxVersion[2] = ptr[2] - '0';
+
+    LE_INFO("Rx version %u.%u.%u", rxVersion[0], rxVersion[1], rxVersion[2]);
+    bool largeFrames = !memcmp(ptr, bridge->packet.versionLarge, sizeof(bridge->packet.versionLarge));
+    if (!largeFrames && memcmp(ptr, bridge->packet.version, sizeof(bridge->packet.version)))
+    {
+        LE_ERROR("ERROR unsupported version(%u.%u.%u != %c.%c.%c|%c.%c.%c)",
+                rxVersion[0], rxVersion[1], rxVersion[2],
+                bridge->packet.version[0], bridge->packet.version[1], bridge->packet.version[2],
+                bridge->packet.versionLarge[0], bridge->packet.versionLarge[1], bridge->packet.versionLarge[2]);
+        goto nack;
+    }
+
+    ptr += MANGOH_BRIDGE_PACKET_VERSION_SIZE;
+
+    // Large frame versions carry the payload size the MCU can buffer
+    uint16_t dataSize = MANGOH_BRIDGE_PACKET_DATA_SIZE_DEFAULT;
+    if (largeFrames)
+    {
+        if (extLen < MANGOH_BRIDGE_PACKET_DATA_SIZE_LEN)
+        {
+            LE_ERROR("ERROR missing payload size");
+            goto nack;
+        }
+
+        uint16_t requested = 0;
+        memcpy(&requested, ptr, sizeof(requested));
+        requested = ntohs(requested);
+        ptr += MANGOH_BRIDGE_PACKET_DATA_SIZE_LEN;
+        extLen -= MANGOH_BRIDGE_PACKET_DATA_SIZE_LEN;
+
+        // Fixed size responses are sized for the version 1 payload, so that is the smallest accepted
+        if (requested < MANGOH_BRIDGE_PACKET_DATA_SIZE_DEFAULT)
+        {
+            LE_ERROR("ERROR invalid payload size(%u < %u)", requested, MANGOH_BRIDGE_PACKET_DATA_SIZE_DEFAULT);
+            goto nack;
+        }
+
+        // Never more than the MCU can buffer, a smaller request is honoured as it is
+        dataSize = (requested < MANGOH_BRIDGE_PACKET_DATA_SIZE) ? requested:MANGOH_BRIDGE_PACKET_DATA_SIZE;
+        LE_INFO("payload size requested(%u) accepted(%u)", requested, dataSize);
+    }
+
+    // The window size and compression type are single bytes ahead of the optional baud rate, so they are the
+    // remainder
+    uint8_t windowSize = 1;
+    uint32_t optLen = largeFrames ? (extLen % MANGOH_BRIDGE_PACKET_BAUD_SIZE):0;
+    bool windowRequest = (optLen >= MANGOH_BRIDGE_PACKET_WINDOW_SIZE);
+    bool codecRequest = (optLen == MANGOH_BRIDGE_PACKET_WINDOW_SIZE + MANGOH_BRIDGE_PACKET_CODEC_SIZE);
+    if (windowRequest)
+    {
+        windowSize = (*ptr < MANGOH_BRIDGE_WINDOW_MAX) ? *ptr:MANGOH_BRIDGE_WINDOW_MAX;
+        windowSize = windowSize ? windowSize:1;
+        LE_INFO("window size requested(%u) accepted(%u)", *ptr, windowSize);
+        ptr += MANGOH_BRIDGE_PACKET_WINDOW_SIZE;
+        extLen -= MANGOH_BRIDGE_PACKET_WINDOW_SIZE;
+    }
+
+    uint8_t codecType = MANGOH_BRIDGE_COMPRESS_NONE;
+    if (codecRequest)
+    {
+        codecType = (*ptr == MANGOH_BRIDGE_COMPRESS_LZSS) ? MANGOH_BRIDGE_COMPRESS_LZSS:MANGOH_BRIDGE_COMPRESS_NONE;
+        LE_INFO("compression requested(%u) accepted(%u)", *ptr, codecType);
+        ptr += MANGOH_BRIDGE_PACKET_CODEC_SIZE;
+        extLen -= MANGOH_BRIDGE_PACKET_CODEC_SIZE;
+
+        // Leave room for the encoding type byte in front of a full payload
+        if ((codecType != MANGOH_BRIDGE_COMPRESS_NONE) && (dataSize > MANGOH_BRIDGE_PACKET_DATA_SIZE - MANGOH_BRIDGE_PACKET_CODEC_SIZE))
+        {
+            dataSize = MANGOH_BRIDGE_PACKET_DATA_SIZE - MANGOH_BRIDGE_PACKET_CODEC_SIZE;
+        }
+    }
+
+    bool baudRequest = (extLen == MANGOH_BRIDGE_PACKET_BAUD_SIZE);
+    if (extLen && !baudRequest)
+    {
+        LE_ERROR("ERROR invalid reset command length(%u)", bridge->packet.rx.len);
+        goto nack;
+    }
+
+    uint32_t baudRate = bridge->baud.rate;
+    if (baudRequest)
+    {
+        uint32_t requested = 0;
+        memcpy(&requested, ptr, sizeof(requested));
+        baudRate = mangoh_bridge_transport_hasLineRate(&bridge->transport) ? mangoh_bridge_negotiateBaudRate(ntohl(requested)):baudRate;
+        LE_INFO("baud rate requested(%u) accepted(%u)", ntohl(requested), baudRate);
+    }
+
+    res = mangoh_bridge_excute_resets(bridge);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_excute_resets() failed(%d)", res);
+        goto cleanup;
+    }
+
+    unsigned char* result = bridge->packet.tx.data;
+    uint32_t rspLen = sizeof(uint8_t) + MANGOH_BRIDGE_PACKET_VERSION_SIZE;
+    result[0] = res;
+    memcpy(&result[1], largeFrames ? bridge->packet.versionLarge:bridge->packet.version, MANGOH_BRIDGE_PACKET_VERSION_SIZE);
+    LE_TRACE(BridgeTraceRef, "result(%d) version(%u.%u.%u)", result[0], result[1] - '0', result[2] - '0', result[3] - '0');
+    if (largeFrames)
+    {
+        uint16_t accepted = htons(dataSize);
+        memcpy(&result[rspLen], &accepted, sizeof(accepted));
+        rspLen += sizeof(accepted);
+    }
+
+    if (windowRequest)
+    {
+        result[rspLen++] = windowSize;
+    }
+
+    if (codecRequest)
+    {
+        result[rspLen++] = codecType;
+    }
+
+    if (baudRequest)
+    {
+        uint32_t accepted = htonl(baudRate);
+        memcpy(&result[rspLen], &accepted, sizeof(accepted));
+        rspLen += sizeof(accepted);
+    }
+
+    res = mangoh_bridge_sendResult(bridge, rspLen);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_sendResult() failed(%d)", res);
+        goto cleanup;
+    }
+
+    bridge->packet.dataSize = dataSize;
+    mangoh_bridge_clearResponses(bridge);
+    mangoh_bridge_clearDeferred(bridge);
+    bridge->window.size = windowSize;
+    bridge->codec.type = codecType;
+    bridge->closed = false;
+
+    // Both ends switch once the reply is out, the MCU must send a good frame at the new rate before the timer expires
+    if (baudRate != bridge->baud.rate)
+    {
+        bridge->baud.next = baudRate;
+        res = mangoh_bridge_switchBaudRate(bridge);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_switchBaudRate() failed(%d)", res);
+            goto cleanup;
+        }
+    }
+
+    goto cleanup;
+
+nack:
+    res = mangoh_bridge_sendNack(bridge);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_sendNack() failed(%d)", res);
+        goto cleanup;
+    }
+
+    res = LE_BAD_PARAMETER;
+
+cleanup:
+    return res;
+}
+
+static int mangoh_bridge_process_payload(mangoh_bridge_t* bridge)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(bridge);
+
+    if (bridge->closed)
+    {
+        if (!memcmp(bridge->packet.rx.data, bridge->packet.reset, sizeof(bridge->packet.reset)))
+        {
+            res = mangoh_bridge_reset(bridge);
+            if (res != LE_OK)
+            {
+                LE_ERROR("ERROR mangoh_bridge_reset() failed(%d)", res);
+                goto cleanup;
+            }
+        }
+        else
+        {
+            LE_ERROR("ERROR unexpected command");
+            mangoh_bridge_packet_dumpBuffer(bridge->packet.rx.data, bridge->packet.rx.len);
+            res = LE_BAD_PARAMETER;
+            goto cleanup;
+        }
+    }
+    else
+    {
+        if (!memcmp(bridge->packet.rx.data, bridge->packet.close, sizeof(bridge->packet.close)))
         {
             res = mangoh_bridge_close(bridge);
             if (res != LE_OK)
@@ -399,7 +1243,7 @@ static int mangoh_bridge_process_payload(mangoh_bridge_t* bridge)
                 goto cleanup;
             }
         }
-        else if (!memcmp(bridge->packet.msg.data, bridge->packet.reset, sizeof(bridge->packet.reset)))
+        else if (!memcmp(bridge->packet.rx.data, bridge->packet.reset, sizeof(bridge->packet.reset)))
         {
             res = mangoh_bridge_reset(bridge);
             if (res != LE_OK)
@@ -429,35 +1273,76 @@ static int mangoh_bridge_process_msg(mangoh_bridge_t* bridge)
 
     LE_ASSERT(bridge);
 
-    bridge->packet.crc = MANGOH_BRIDGE_PACKET_CRC_RESET;
-    bridge->packet.crc = mangoh_bridge_packet_crcUpdate(bridge->packet.crc, &bridge->packet.msg.start, sizeof(bridge->packet.msg.start));
-
-    res = mangoh_bridge_process_msg_idx(bridge);
-    if (res != LE_OK)
+    // Consume whatever is buffered, a partial frame is resumed on the next event
+    while (bridge->rxRing.tail != bridge->rxRing.head)
     {
-        LE_ERROR("ERROR mangoh_bridge_process_msg_idx() failed(%d)", res);
-        goto cleanup;
-    }
+        // Leave the requests with the MCU until their responses can be queued without blocking
+        if ((bridge->rxState == MANGOH_BRIDGE_RX_STATE_START) && !mangoh_bridge_txRingHasRoom(bridge))
+        {
+            if (!bridge->txRing.stalled)
+            {
+                LE_TRACE(BridgeTraceRef, "receive stalled, transmit ring full");
+                bridge->txRing.stalled = true;
+                le_fdMonitor_Disable(bridge->fdMonitor, POLLIN);
+            }
 
-    res = mangoh_bridge_process_payload_len(bridge);
-    if (res != LE_OK)
-    {
-        LE_ERROR("ERROR mangoh_bridge_process_payload_len() failed(%d)", res);
-        goto cleanup;
-    }
+            goto cleanup;
+        }
 
-    res = mangoh_bridge_process_crc(bridge);
-    if (res != LE_OK)
-    {
-        LE_ERROR("ERROR mangoh_bridge_process_crc() failed(%d)", res);
-        goto cleanup;
-    }
+        switch (bridge->rxState)
+        {
+        case MANGOH_BRIDGE_RX_STATE_START:
+            if (!mangoh_bridge_scanRxRing(bridge))
+            {
+                goto cleanup;
+            }
 
-    res = mangoh_bridge_process_payload(bridge);
-    if (res != LE_OK)
-    {
-        LE_ERROR("ERROR mangoh_bridge_process_payload() failed(%d)", res);
-        goto cleanup;
+            if (mangoh_bridge_rxField(bridge, &bridge->packet.rx.start, sizeof(bridge->packet.rx.start)))
+            {
+                res = mangoh_bridge_process_msg_start(bridge);
+            }
+            break;
+
+        case MANGOH_BRIDGE_RX_STATE_IDX:
+            if (mangoh_bridge_rxField(bridge, &bridge->packet.rx.idx, sizeof(bridge->packet.rx.idx)))
+            {
+                res = mangoh_bridge_process_msg_idx(bridge);
+            }
+            break;
+
+        case MANGOH_BRIDGE_RX_STATE_LEN:
+            if (mangoh_bridge_rxField(bridge, &bridge->packet.rx.len, sizeof(bridge->packet.rx.len)))
+            {
+                res = mangoh_bridge_process_payload_len(bridge);
+            }
+            break;
+
+        case MANGOH_BRIDGE_RX_STATE_PAYLOAD:
+            if (mangoh_bridge_rxField(bridge, bridge->packet.rx.data, bridge->packet.rx.len))
+            {
+                res = mangoh_bridge_process_payload_data(bridge);
+            }
+            break;
+
+        case MANGOH_BRIDGE_RX_STATE_CRC:
+            if (mangoh_bridge_rxField(bridge, &bridge->packet.rx.crc, sizeof(bridge->packet.rx.crc)))
+            {
+                res = mangoh_bridge_process_crc(bridge);
+            }
+            break;
+
+        default:
+            LE_ERROR("ERROR invalid receive state(%d)", bridge->rxState);
+            res = LE_FAULT;
+            break;
+        }
+
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR frame state(%d) failed(%d)", bridge->rxState, res);
+            mangoh_bridge_setRxState(bridge, MANGOH_BRIDGE_RX_STATE_START);
+            res = LE_OK;
+        }
     }
 
 cleanup:
@@ -521,119 +1406,304 @@ static void mangoh_bridge_eventHandler(int fd, short events)
 
     LE_ASSERT(bridge);
 
-    res = mangoh_bridge_excute_runners(bridge);
-    if (res != LE_OK)
+    if (bridge->reconnect.connecting)
     {
-        LE_ERROR("ERROR mangoh_bridge_excute_runners() failed(%d)", res);
+        mangoh_bridge_connected(bridge);
+        goto cleanup;
     }
 
-    LE_TRACE(BridgeTraceRef, "read '%s'", MANGOH_BRIDGE_SERIAL_PORT_FN);
-    res = mangoh_bridge_read(bridge, &bridge->packet.msg.start, sizeof(bridge->packet.msg.start));
-    if (res < 0)
+    if (events & POLLOUT)
     {
-        LE_ERROR("ERROR mangoh_bridge_read() failed(%d)", res);
+        res = mangoh_bridge_drainTxRing(bridge);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_drainTxRing() failed(%d)", res);
+        }
     }
-    else if (res > 0)
+
+    if (events & ~POLLOUT)
     {
-        LE_TRACE(BridgeTraceRef, "read 0x%02x", bridge->packet.msg.start);
-        if (bridge->packet.msg.start == MANGOH_BRIDGE_PACKET_START)
+        res = mangoh_bridge_excute_runners(bridge);
+        if (res != LE_OK)
         {
-            res = mangoh_bridge_process_msg(bridge);
-            if (res != LE_OK)
-            {
-                LE_ERROR("ERROR mangoh_bridge_process_msg() failed(%d)", res);
-            }
+            LE_ERROR("ERROR mangoh_bridge_excute_runners() failed(%d)", res);
+        }
+
+        LE_TRACE(BridgeTraceRef, "read '%s'", bridge->transport.name);
+        res = mangoh_bridge_fillRxRing(bridge);
+        if (res < 0)
+        {
+            LE_ERROR("ERROR mangoh_bridge_fillRxRing() failed(%d)", res);
+            goto cleanup;
         }
     }
+
+    res = mangoh_bridge_process_msg(bridge);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_process_msg() failed(%d)", res);
+        goto cleanup;
+    }
+
+cleanup:
+    return;
+}
+
+static int mangoh_bridge_open(mangoh_bridge_t* bridge)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(bridge);
+
+    res = mangoh_bridge_transport_open(&bridge->transport);
+    if ((res != LE_OK) && (res != LE_WOULD_BLOCK))
+    {
+        LE_ERROR("ERROR mangoh_bridge_transport_open() failed(%d)", res);
+        goto cleanup;
+    }
+
+    bridge->reconnect.connecting = (res == LE_WOULD_BLOCK);
+
+    // Responses are written from POLLOUT, a full output buffer must never stall the event loop
+    int flags = fcntl(bridge->transport.fd, F_GETFL);
+    res = (flags < 0) ? flags:fcntl(bridge->transport.fd, F_SETFL, flags | O_NONBLOCK);
+    if (res < 0)
+    {
+        LE_ERROR("ERROR fcntl() '%s' failed(%d/%d)", bridge->transport.name, res, errno);
+        res = LE_IO_ERROR;
+        goto cleanup;
+    }
+
+    // A socket still connecting is watched for POLLOUT, it reports POLLIN once connected
+    bridge->fdMonitor = le_fdMonitor_Create(MANGOH_BRIDGE_FD_MONITOR_NAME, bridge->transport.fd, mangoh_bridge_eventHandler,
+                                            bridge->reconnect.connecting ? POLLOUT:POLLIN);
+    if (!bridge->fdMonitor)
+    {
+        LE_ERROR("ERROR le_fdMonitor_Create() failed");
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    le_fdMonitor_SetContextPtr(bridge->fdMonitor, bridge);
+    bridge->baud.rate = MANGOH_BRIDGE_BAUD_DEFAULT;
+    bridge->baud.crcErrors = 0;
+    res = LE_OK;
+
+    if (bridge->reconnect.connecting)
+    {
+        // Bound the time an unreachable server is waited for, the reconnect timer gives up on it
+        le_timer_SetMsInterval(bridge->reconnect.timer, MANGOH_BRIDGE_TRANSPORT_CONNECT_TIMEOUT_SEC * 1000);
+        le_timer_Restart(bridge->reconnect.timer);
+        res = LE_WOULD_BLOCK;
+    }
+
+cleanup:
+    if ((res != LE_OK) && (res != LE_WOULD_BLOCK))
+    {
+        bridge->reconnect.connecting = false;
+        mangoh_bridge_transport_close(&bridge->transport);
+    }
+
+    return res;
+}
+
+static void mangoh_bridge_connected(mangoh_bridge_t* bridge)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(bridge);
+
+    bridge->reconnect.connecting = false;
+    le_timer_Stop(bridge->reconnect.timer);
+    res = mangoh_bridge_transport_finishConnect(&bridge->transport);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_transport_finishConnect() failed(%d)", res);
+        mangoh_bridge_stop(bridge);
+        mangoh_bridge_scheduleReconnect(bridge);
+        goto cleanup;
+    }
+
+    le_fdMonitor_Disable(bridge->fdMonitor, POLLOUT);
+    le_fdMonitor_Enable(bridge->fdMonitor, POLLIN);
+    mangoh_bridge_started(bridge);
+
+cleanup:
+    return;
+}
+
+static void mangoh_bridge_resolveWork(void* param)
+{
+    mangoh_bridge_resolve_job_t* job = (mangoh_bridge_resolve_job_t*)param;
+
+    LE_ASSERT(job);
+
+    job->res = mangoh_bridge_transport_resolve(&job->bridge->transport, &job->peer);
+}
+
+static void mangoh_bridge_resolveDone(void* param)
+{
+    mangoh_bridge_resolve_job_t* job = (mangoh_bridge_resolve_job_t*)param;
+    mangoh_bridge_t* bridge = NULL;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(job);
+
+    bridge = job->bridge;
+    if (job->generation != bridge->reconnect.generation)
+    {
+        LE_INFO("address lookup '%s' dropped, bridge stopped since", bridge->transport.name);
+        goto cleanup;
+    }
+
+    bridge->reconnect.resolving = false;
+    if (job->res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_transport_resolve() '%s' failed(%d)", bridge->transport.name, job->res);
+        mangoh_bridge_scheduleReconnect(bridge);
+        goto cleanup;
+    }
+
+    bridge->transport.peer = job->peer;
+    res = mangoh_bridge_open(bridge);
+    if (res == LE_WOULD_BLOCK)
+    {
+        goto cleanup;
+    }
+    else if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_open() '%s' failed(%d)", bridge->transport.name, res);
+        mangoh_bridge_scheduleReconnect(bridge);
+        goto cleanup;
+    }
+
+    mangoh_bridge_started(bridge);
+
+cleanup:
+    free(job);
+}
+
+static int mangoh_bridge_resolve(mangoh_bridge_t* bridge)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(bridge);
+
+    mangoh_bridge_resolve_job_t* job = calloc(1, sizeof(mangoh_bridge_resolve_job_t));
+    if (!job)
+    {
+        LE_ERROR("ERROR calloc() failed");
+        res = LE_NO_MEMORY;
+        goto cleanup;
+    }
+
+    job->bridge = bridge;
+    job->generation = bridge->reconnect.generation;
+
+    // The transport name and address are not changed after init, the worker may read them
+    res = mangoh_bridge_worker_submit(bridge, mangoh_bridge_resolveWork, mangoh_bridge_resolveDone, job);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_worker_submit() failed(%d)", res);
+        free(job);
+        goto cleanup;
+    }
+
+    bridge->reconnect.resolving = true;
+
+cleanup:
+    return res;
+}
+
+static void mangoh_bridge_scheduleReconnect(mangoh_bridge_t* bridge)
+{
+    LE_ASSERT(bridge);
+
+    LE_INFO("reconnect '%s' in %u ms", bridge->transport.name, bridge->reconnect.delayMs);
+    le_timer_SetMsInterval(bridge->reconnect.timer, bridge->reconnect.delayMs);
+    le_timer_Restart(bridge->reconnect.timer);
+
+    // Back off exponentially while the device stays away
+    bridge->reconnect.delayMs = (bridge->reconnect.delayMs < MANGOH_BRIDGE_RECONNECT_MAX_MS / 2) ?
+                                bridge->reconnect.delayMs * 2:MANGOH_BRIDGE_RECONNECT_MAX_MS;
+}
+
+static void mangoh_bridge_reconnectTimerHandler(le_timer_Ref_t timer)
+{
+    mangoh_bridge_t* bridge = le_timer_GetContextPtr(timer);
+    int32_t res = LE_OK;
+
+    LE_ASSERT(bridge);
+
+    if (bridge->reconnect.connecting)
+    {
+        LE_ERROR("ERROR connect '%s' timed out", bridge->transport.name);
+        mangoh_bridge_stop(bridge);
+        mangoh_bridge_scheduleReconnect(bridge);
+        goto cleanup;
+    }
+
+    res = mangoh_bridge_start(bridge);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_start() failed(%d)", res);
+        goto cleanup;
+    }
+
+cleanup:
+    return;
 }
 
-static int mangoh_bridge_start(mangoh_bridge_t* bridge)
+static void mangoh_bridge_started(mangoh_bridge_t* bridge)
 {
-    int32_t res = LE_OK;
-
     LE_ASSERT(bridge);
 
-    while (bridge->serialFd < 0)
-    {
-        LE_INFO("open '%s'", MANGOH_BRIDGE_SERIAL_PORT_FN);
-        bridge->serialFd = open(MANGOH_BRIDGE_SERIAL_PORT_FN, O_RDWR | O_NOCTTY | O_EXCL);
-        if (bridge->serialFd < 0)
-        {
-            LE_ERROR("ERROR open() '%s' failed(%d)", MANGOH_BRIDGE_SERIAL_PORT_FN, errno);
-            sleep(1);
-            continue;
-        }
-
-        res = fcntl(bridge->serialFd, F_SETFL, 0);
-        if (res)
-        {
-            LE_ERROR("ERROR fcntl() failed(%d/%d)", res, errno);
-            res = LE_FAULT;
-            goto cleanup;
-        }
-
-        struct termios tty = {0};
-        res = tcgetattr(bridge->serialFd, &tty);
-        if (res)
-        {
-            LE_ERROR("ERROR tcgetattr() failed(%d/%d)", res, errno);
-            res = LE_FAULT;
-            goto cleanup;
-        }
+    bridge->reconnect.delayMs = MANGOH_BRIDGE_RECONNECT_MIN_MS;
 
-        res = cfsetospeed(&tty, B115200);
-        if (res)
-        {
-            LE_ERROR("ERROR cfsetospeed() failed(%d/%d)", res, errno);
-            res = LE_FAULT;
-            goto cleanup;
-        }
+    LE_FATAL_IF(
+      mangoh_muxCtrl_ArduinoDeassertReset() != LE_OK, "Couldn't deassert the Arduino reset");
 
-        res = cfsetispeed(&tty, B115200);
-        if (res)
-        {
-            LE_ERROR("ERROR cfsetispeed() failed(%d/%d)", res, errno);
-            res = LE_FAULT;
-            goto cleanup;
-        }
+    LE_INFO("bridge '%s' started", bridge->transport.name);
+}
 
-        cfmakeraw(&tty);
+static int mangoh_bridge_start(mangoh_bridge_t* bridge)
+{
+    int32_t res = LE_OK;
 
-        tty.c_cc[VMIN] = 1;       // read blocks
-        tty.c_cc[VTIME] = 0;      // seconds read timeout
+    LE_ASSERT(bridge);
 
-        res = tcflush(bridge->serialFd, TCIFLUSH);
-        if (res)
-        {
-            LE_ERROR("ERROR tcflush() failed(%d/%d)", res, errno);
-            res = LE_FAULT;
-            goto cleanup;
-        }
+    if ((bridge->transport.fd != MANGOH_BRIDGE_TRANSPORT_FD_INVALID) || bridge->reconnect.resolving)
+    {
+        LE_WARN("WARNING already started");
+        goto cleanup;
+    }
 
-        res = tcsetattr(bridge->serialFd, TCSANOW, &tty);
-        if (res)
+    // Socket addresses are looked up on the worker pool, the bridge is opened when the lookup completes
+    if (mangoh_bridge_transport_needsResolve(&bridge->transport))
+    {
+        res = mangoh_bridge_resolve(bridge);
+        if (res != LE_OK)
         {
-            LE_ERROR("ERROR tcsetattr() failed(%d/%d)", res, errno);
-            res = LE_FAULT;
-            goto cleanup;
+            LE_ERROR("ERROR mangoh_bridge_resolve() '%s' failed(%d)", bridge->transport.name, res);
+            mangoh_bridge_scheduleReconnect(bridge);
+            res = LE_OK;
         }
 
-        bridge->fdMonitor = le_fdMonitor_Create(MANGOH_BRIDGE_FD_MONITOR_NAME, bridge->serialFd, mangoh_bridge_eventHandler, POLLIN);
-        if (!bridge->fdMonitor)
-        {
-            LE_ERROR("ERROR le_fdMonitor_Create() failed");
-            res = LE_FAULT;
-            goto cleanup;
-        }
+        goto cleanup;
+    }
 
-        le_fdMonitor_SetContextPtr(bridge->fdMonitor, bridge);
+    res = mangoh_bridge_open(bridge);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_open() '%s' failed(%d)", bridge->transport.name, res);
+        mangoh_bridge_scheduleReconnect(bridge);
+        res = LE_OK;
+        goto cleanup;
     }
 
-    LE_FATAL_IF(
-      mangoh_muxCtrl_ArduinoDeassertReset() != LE_OK, "Couldn't deassert the Arduino reset");
+    mangoh_bridge_started(bridge);
 
 cleanup:
-    LE_INFO("bridge started(%d)", res);
     return res;
 }
 
@@ -644,119 +1714,289 @@ static int mangoh_bridge_stop(mangoh_bridge_t* bridge)
     LE_ASSERT(bridge);
 
     LE_INFO("bridge stop");
-    if (bridge->serialFd != MANGOH_BRIDGE_SERIAL_FD_INVALID)
+    le_timer_Stop(bridge->reconnect.timer);
+    bridge->reconnect.generation++;
+    bridge->reconnect.resolving = false;
+    bridge->reconnect.connecting = false;
+    if (bridge->transport.fd != MANGOH_BRIDGE_TRANSPORT_FD_INVALID)
     {
-        res = close(bridge->serialFd);
+        // The descriptor is released even when close() reports an error, the monitor must still go
+        res = mangoh_bridge_transport_close(&bridge->transport);
         if (res != LE_OK)
         {
-            LE_ERROR("ERROR close() failed(%d/%d)", res, errno);
-            res = errno;
-            goto cleanup;
+            LE_ERROR("ERROR mangoh_bridge_transport_close() failed(%d)", res);
         }
 
-        bridge->serialFd = MANGOH_BRIDGE_SERIAL_FD_INVALID;
         bridge->closed = false;
+        LE_INFO("receive discarded(%u) CRC errors(%u) length errors(%u)",
+                bridge->rxStats.discarded, bridge->rxStats.crcErrors, bridge->rxStats.lenErrors);
+        mangoh_bridge_stats_dump(&bridge->stats, bridge->transport.name);
+        bridge->rxRing.head = 0;
+        bridge->rxRing.tail = 0;
+        bridge->rxRing.mark = 0;
+        mangoh_bridge_setRxState(bridge, MANGOH_BRIDGE_RX_STATE_START);
+        mangoh_bridge_clearResponses(bridge);
+        mangoh_bridge_clearDeferred(bridge);
+        mangoh_bridge_clearTxRing(bridge);
+        bridge->window.size = 1;
+        bridge->codec.type = MANGOH_BRIDGE_COMPRESS_NONE;
+        bridge->packet.dataSize = MANGOH_BRIDGE_PACKET_DATA_SIZE_DEFAULT;
+        bridge->baud.verifying = false;
+        bridge->baud.next = 0;
+        bridge->baud.drainPolls = 0;
+        le_timer_Stop(bridge->baud.timer);
+        le_timer_Stop(bridge->baud.drainTimer);
 
         le_fdMonitor_Delete(bridge->fdMonitor);
+        bridge->fdMonitor = NULL;
     }
     else
     {
         LE_WARN("WARNING already stopped");
     }
 
-cleanup:
     return res;
 }
 
 static void mangoh_bridge_SigTermEventHandler(int sigNum)
 {
-    int32_t res = mangoh_bridge_destroy(&bridge);
-    if (res != LE_OK)
+    le_sls_Link_t* link = le_sls_Pop(&mangoh_bridge_list);
+    while (link)
     {
-        LE_ERROR("ERROR mangoh_bridge_destroy() failed(%d)", res);
-        goto cleanup;
+        mangoh_bridge_t* bridge = CONTAINER_OF(link, mangoh_bridge_t, link);
+
+        int32_t res = mangoh_bridge_destroy(bridge);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_destroy() '%s' failed(%d)", bridge->transport.name, res);
+        }
+
+        link = le_sls_Pop(&mangoh_bridge_list);
     }
 
-cleanup:
-    return;
+    // Worker pool completions may still be queued against the bridges, exit rather than free them
+    LE_INFO("mangOH Arduino Bridge Service Stopped");
+    exit(EXIT_SUCCESS);
+}
+
+static void mangoh_bridge_SigChldEventHandler(int sigNum)
+{
+    le_sls_Link_t* link = le_sls_Peek(&mangoh_bridge_list);
+    while (link)
+    {
+        mangoh_bridge_t* bridge = CONTAINER_OF(link, mangoh_bridge_t, link);
+        mangoh_bridge_processes_childExited(&bridge->modules.processes);
+        link = le_sls_PeekNext(&mangoh_bridge_list, link);
+    }
+}
+
+static void mangoh_bridge_SigUsr1EventHandler(int sigNum)
+{
+    le_sls_Link_t* link = le_sls_Peek(&mangoh_bridge_list);
+    while (link)
+    {
+        const mangoh_bridge_t* bridge = CONTAINER_OF(link, mangoh_bridge_t, link);
+        mangoh_bridge_stats_dump(&bridge->stats, bridge->transport.name);
+        link = le_sls_PeekNext(&mangoh_bridge_list, link);
+    }
+}
+
+static void mangoh_bridge_SigUsr2EventHandler(int sigNum)
+{
+    le_sls_Link_t* link = le_sls_Peek(&mangoh_bridge_list);
+    while (link)
+    {
+        const mangoh_bridge_t* bridge = CONTAINER_OF(link, mangoh_bridge_t, link);
+
+        char name[MANGOH_BRIDGE_TRANSPORT_NAME_MAX_LEN] = {0};
+        mangoh_bridge_getFileName(bridge, name, sizeof(name));
+
+        char path[MANGOH_BRIDGE_CAPTURE_PATH_MAX_LEN] = {0};
+        snprintf(path, sizeof(path), MANGOH_BRIDGE_CAPTURE_PATH_FORMAT, name);
+
+        int32_t res = mangoh_bridge_capture_save(&bridge->capture, path);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_capture_save() failed(%d)", res);
+        }
+
+        link = le_sls_PeekNext(&mangoh_bridge_list, link);
+    }
 }
 
-static int mangoh_bridge_init(mangoh_bridge_t* bridge)
+static int mangoh_bridge_init(mangoh_bridge_t* bridge, const char* transport, uint32_t instance)
 {
     char version[MANGOH_BRIDGE_PACKET_VERSION_SIZE] = MANGOH_BRIDGE_PACKET_VERSION;
+    char versionLarge[MANGOH_BRIDGE_PACKET_VERSION_SIZE] = MANGOH_BRIDGE_PACKET_VERSION_LARGE;
     char reset[MANGOH_BRIDGE_PACKET_RESET_SIZE] = MANGOH_BRIDGE_PACKET_RESET;
     char close[MANGOH_BRIDGE_PACKET_CLOSE_SIZE] = MANGOH_BRIDGE_PACKET_CLOSE;
     int32_t res = LE_OK;
 
     LE_ASSERT(bridge);
+    LE_ASSERT(transport);
     memset(bridge, 0, sizeof(mangoh_bridge_t));
+    bridge->instance = instance;
 
-    BridgeTraceRef = le_log_GetTraceRef("Bridge");
-
-    LE_FATAL_IF(mangoh_muxCtrl_ArduinoAssertReset() != LE_OK, "Couldn't assert the Arduino reset");
-    // Sleep for a while to ensure that the Arduino catches the reset
-    usleep(300);
+    res = mangoh_bridge_transport_init(&bridge->transport, transport);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_transport_init() failed(%d)", res);
+        goto cleanup;
+    }
 
+    bridge->link = LE_SLS_LINK_INIT;
+    mangoh_bridge_stats_init(&bridge->stats);
+    mangoh_bridge_capture_init(&bridge->capture);
+    mangoh_bridge_queue_init(&bridge->txRing.queue, bridge->txRing.data, sizeof(bridge->txRing.data));
     memcpy(bridge->packet.version, version, sizeof(version));
+    memcpy(bridge->packet.versionLarge, versionLarge, sizeof(versionLarge));
+    bridge->packet.dataSize = MANGOH_BRIDGE_PACKET_DATA_SIZE_DEFAULT;
     memcpy(bridge->packet.reset, reset, sizeof(reset));
     memcpy(bridge->packet.close, close, sizeof(close));
-    bridge->serialFd = MANGOH_BRIDGE_SERIAL_FD_INVALID;
     bridge->packet.crc = MANGOH_BRIDGE_PACKET_CRC_RESET;
-    bridge->packet.msg.crc = MANGOH_BRIDGE_PACKET_CRC_RESET;
+    bridge->packet.rx.crc = MANGOH_BRIDGE_PACKET_CRC_RESET;
     bridge->runnerList = LE_SLS_LIST_INIT;
     bridge->resetList = LE_SLS_LIST_INIT;
+    bridge->baud.rate = MANGOH_BRIDGE_BAUD_DEFAULT;
+    bridge->window.size = 1;
+
+    bridge->baud.timer = le_timer_Create(MANGOH_BRIDGE_BAUD_TIMER_NAME);
+    le_timer_SetMsInterval(bridge->baud.timer, MANGOH_BRIDGE_BAUD_VERIFY_TIMEOUT_MS);
+    le_timer_SetRepeat(bridge->baud.timer, 1);
+    le_timer_SetContextPtr(bridge->baud.timer, bridge);
+    le_timer_SetHandler(bridge->baud.timer, mangoh_bridge_baudRateTimerHandler);
+
+    bridge->baud.drainTimer = le_timer_Create(MANGOH_BRIDGE_BAUD_DRAIN_TIMER_NAME);
+    le_timer_SetMsInterval(bridge->baud.drainTimer, MANGOH_BRIDGE_BAUD_DRAIN_POLL_MS);
+    le_timer_SetRepeat(bridge->baud.drainTimer, 0);
+    le_timer_SetContextPtr(bridge->baud.drainTimer, bridge);
+    le_timer_SetHandler(bridge->baud.drainTimer, mangoh_bridge_baudDrainTimerHandler);
+
+    bridge->reconnect.delayMs = MANGOH_BRIDGE_RECONNECT_MIN_MS;
+    bridge->reconnect.timer = le_timer_Create(MANGOH_BRIDGE_RECONNECT_TIMER_NAME);
+    le_timer_SetRepeat(bridge->reconnect.timer, 1);
+    le_timer_SetContextPtr(bridge->reconnect.timer, bridge);
+    le_timer_SetHandler(bridge->reconnect.timer, mangoh_bridge_reconnectTimerHandler);
 
     res = mangoh_bridge_fileio_init(&bridge->modules.fileio, bridge);
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_fileio_init() failed(%d)", res);
-        goto cleanup;
+        goto releaseBridge;
     }
 
     res = mangoh_bridge_console_init(&bridge->modules.console, bridge);
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_console_init() failed(%d)", res);
-        goto cleanup;
+        goto destroyFileio;
     }
 
     res = mangoh_bridge_mailbox_init(&bridge->modules.mailbox, bridge);
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_mailbox_init() failed(%d)", res);
-        goto cleanup;
+        goto destroyConsole;
     }
 
     res = mangoh_bridge_processes_init(&bridge->modules.processes, bridge);
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_processes_init() failed(%d)", res);
-        goto cleanup;
+        goto destroyMailbox;
     }
 
     res = mangoh_bridge_sockets_init(&bridge->modules.sockets, bridge);
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_sockets_init() failed(%d)", res);
-        goto cleanup;
+        goto destroyProcesses;
     }
 
     res = mangoh_bridge_air_vantage_init(&bridge->modules.airVantage, bridge);
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_air_vantage_init() failed(%d)", res);
-        goto cleanup;
+        goto destroySockets;
     }
 
+    goto cleanup;
+
+    // Unwind the sub-modules initialized so far in reverse order, nothing may be left referring to the bridge
+destroySockets:
+    mangoh_bridge_sockets_destroy(&bridge->modules.sockets);
+destroyProcesses:
+    mangoh_bridge_processes_destroy(&bridge->modules.processes);
+destroyMailbox:
+    mangoh_bridge_mailbox_destroy(&bridge->modules.mailbox);
+destroyConsole:
+    mangoh_bridge_console_destroy(&bridge->modules.console);
+destroyFileio:
+    mangoh_bridge_fileio_destroy(&bridge->modules.fileio);
+releaseBridge:
+    mangoh_bridge_release(bridge);
+
 cleanup:
     return res;
 }
 
+static void mangoh_bridge_release(mangoh_bridge_t* bridge)
+{
+    LE_ASSERT(bridge);
+
+    if (bridge->baud.timer)
+    {
+        le_timer_Delete(bridge->baud.timer);
+        bridge->baud.timer = NULL;
+    }
+
+    if (bridge->baud.drainTimer)
+    {
+        le_timer_Delete(bridge->baud.drainTimer);
+        bridge->baud.drainTimer = NULL;
+    }
+
+    if (bridge->reconnect.timer)
+    {
+        le_timer_Delete(bridge->reconnect.timer);
+        bridge->reconnect.timer = NULL;
+    }
+
+    le_sls_Link_t* link = le_sls_Pop(&bridge->runnerList);
+    while (link)
+    {
+        free(CONTAINER_OF(link, mangoh_bridge_runner_item_t, link));
+        link = le_sls_Pop(&bridge->runnerList);
+    }
+
+    link = le_sls_Pop(&bridge->resetList);
+    while (link)
+    {
+        free(CONTAINER_OF(link, mangoh_bridge_reset_item_t, link));
+        link = le_sls_Pop(&bridge->resetList);
+    }
+}
+
 le_log_TraceRef_t mangoh_bridge_getTraceRef(void)
 {
     return BridgeTraceRef;
 }
 
+void mangoh_bridge_getFileName(const mangoh_bridge_t* bridge, char* name, uint32_t size)
+{
+    LE_ASSERT(bridge);
+    LE_ASSERT(name && size);
+
+    // Transport names hold device paths and addresses, keep only characters safe in a file name
+    uint32_t idx = 0;
+    for (idx = 0; (idx < size - 1) && bridge->transport.name[idx]; idx++)
+    {
+        name[idx] = isalnum((unsigned char)bridge->transport.name[idx]) ? bridge->transport.name[idx]:'_';
+    }
+
+    name[idx] = 0;
+}
+
 int mangoh_bridge_sendAck(mangoh_bridge_t* bridge)
 {
     int32_t res = LE_OK;
@@ -764,7 +2004,7 @@ int mangoh_bridge_sendAck(mangoh_bridge_t* bridge)
     LE_ASSERT(bridge);
 
     LE_INFO("<--- ACK");
-    unsigned char* result = bridge->packet.msg.data;
+    unsigned char* result = bridge->packet.tx.data;
     result[0] = MANGOH_BRIDGE_PACKET_ACK;
 
     res = mangoh_bridge_sendResult(bridge, sizeof(uint8_t));
@@ -785,8 +2025,9 @@ int mangoh_bridge_sendNack(mangoh_bridge_t* bridge)
     LE_ASSERT(bridge);
 
     LE_INFO("<--- NACK");
-    unsigned char* result = bridge->packet.msg.data;
+    unsigned char* result = bridge->packet.tx.data;
     result[0] = MANGOH_BRIDGE_PACKET_NACK;
+    mangoh_bridge_stats_addNack(&bridge->stats);
 
     res = mangoh_bridge_sendResult(bridge, sizeof(uint8_t));
     if (res)
@@ -800,43 +2041,134 @@ cleanup:
 }
 
 int mangoh_bridge_sendResult(mangoh_bridge_t* bridge, uint32_t len)
+{
+    LE_ASSERT(bridge);
+    return mangoh_bridge_sendResponse(bridge, bridge->packet.rx.idx, len);
+}
+
+static int mangoh_bridge_sendResponse(mangoh_bridge_t* bridge, uint8_t msgIdx, uint32_t len)
 {
     int32_t res = LE_OK;
 
     LE_ASSERT(bridge);
 
+    if (len > bridge->packet.dataSize)
+    {
+        LE_ERROR("ERROR response index(%u) length(%u) exceeds payload size(%u)", msgIdx, len, bridge->packet.dataSize);
+        res = LE_OVERFLOW;
+        goto cleanup;
+    }
+
+    mangoh_bridge_stats_addBytesOut(&bridge->stats, len);
+    mangoh_bridge_encodePayload(bridge, &len);
+    bridge->packet.tx.idx = msgIdx;
     mangoh_bridge_packet_initResponse(&bridge->packet, len);
-    LE_TRACE(BridgeTraceRef, "<--- RSP length(%u)", len);
+    LE_TRACE(BridgeTraceRef, "<--- RSP index(%u) length(%u)", msgIdx, len);
+
+    struct iovec iov[] =
+    {
+        { .iov_base = &bridge->packet.tx, .iov_len = sizeof(bridge->packet.tx.start) + sizeof(bridge->packet.tx.idx) + sizeof(bridge->packet.tx.len) },
+        { .iov_base = bridge->packet.tx.data, .iov_len = len },
+        { .iov_base = &bridge->packet.tx.crc, .iov_len = sizeof(bridge->packet.tx.crc) },
+    };
+
+    // Keep the wire image so a retransmitted request can be answered without re-running its command,
+    // the oldest response in the window is overwritten
+    mangoh_bridge_rsp_cache_t* cached = &bridge->window.rsp[bridge->window.next];
+    uint32_t idx = 0;
+    cached->len = 0;
+    for (idx = 0; idx < NUM_ARRAY_MEMBERS(iov); idx++)
+    {
+        memcpy(&cached->data[cached->len], iov[idx].iov_base, iov[idx].iov_len);
+        cached->len += iov[idx].iov_len;
+    }
+
+    cached->idx = msgIdx;
+    cached->valid = true;
+    bridge->window.next = (bridge->window.next + 1) % bridge->window.size;
 
-    res = mangoh_bridge_write(bridge, (const uint8_t*)&bridge->packet.msg,
-            sizeof(bridge->packet.msg.start) + sizeof(bridge->packet.msg.idx) + sizeof(bridge->packet.msg.len));
+    res = mangoh_bridge_write(bridge, iov, NUM_ARRAY_MEMBERS(iov));
     if (res)
     {
         LE_ERROR("ERROR mangoh_bridge_write() failed(%d)", res);
         goto cleanup;
     }
 
-    if (len)
+cleanup:
+    return res;
+}
+
+static int mangoh_bridge_complete(mangoh_bridge_t* bridge, const mangoh_bridge_pending_t* pending, const void* data, uint32_t len, bool nack)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(bridge);
+    LE_ASSERT(pending);
+
+    if (pending->generation != bridge->deferred.generation)
     {
-        res = mangoh_bridge_write(bridge, bridge->packet.msg.data, len);
-        if (res)
-        {
-            LE_ERROR("ERROR mangoh_bridge_write() failed(%d)", res);
-            goto cleanup;
-        }
+        LE_INFO("response index(%u) dropped, bridge reset since the request", pending->idx);
+        goto cleanup;
     }
 
-    res = mangoh_bridge_write(bridge, (const unsigned char*)&bridge->packet.msg.crc, sizeof(bridge->packet.msg.crc));
-    if (res)
+    bridge->deferred.inFlight[pending->idx] = false;
+    if (!nack && (len > bridge->packet.dataSize))
     {
-        LE_ERROR("ERROR mangoh_bridge_write() failed(%d)", res);
-        goto cleanup;
+        // The MCU still waits for this index, answer it rather than leave it to time out
+        LE_ERROR("ERROR response index(%u) length(%u) too long", pending->idx, len);
+        res = LE_OVERFLOW;
+        nack = true;
+    }
+
+    mangoh_bridge_stats_resume(&bridge->stats, pending->statsCmd, &pending->start);
+    if (nack)
+    {
+        LE_INFO("<--- NACK index(%u)", pending->idx);
+        bridge->packet.tx.data[0] = MANGOH_BRIDGE_PACKET_NACK;
+        mangoh_bridge_stats_addNack(&bridge->stats);
+        len = sizeof(uint8_t);
+    }
+    else
+    {
+        memcpy(bridge->packet.tx.data, data, len);
+    }
+
+    int32_t err = mangoh_bridge_sendResponse(bridge, pending->idx, len);
+    if (err != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_sendResponse() failed(%d)", err);
+        res = err;
     }
 
+    mangoh_bridge_stats_end(&bridge->stats, nack ? LE_FAULT:res);
+
 cleanup:
     return res;
 }
 
+void mangoh_bridge_deferResult(mangoh_bridge_t* bridge, mangoh_bridge_pending_t* pending)
+{
+    LE_ASSERT(bridge);
+    LE_ASSERT(pending);
+
+    pending->idx = bridge->packet.rx.idx;
+    pending->generation = bridge->deferred.generation;
+    bridge->deferred.inFlight[pending->idx] = true;
+    mangoh_bridge_stats_suspend(&bridge->stats, &pending->statsCmd, &pending->start);
+    LE_TRACE(BridgeTraceRef, "deferred index(%u)", pending->idx);
+}
+
+int mangoh_bridge_completeResult(mangoh_bridge_t* bridge, const mangoh_bridge_pending_t* pending, const void* data, uint32_t len)
+{
+    LE_ASSERT(!len || data);
+    return mangoh_bridge_complete(bridge, pending, data, len, false);
+}
+
+int mangoh_bridge_completeNack(mangoh_bridge_t* bridge, const mangoh_bridge_pending_t* pending)
+{
+    return mangoh_bridge_complete(bridge, pending, NULL, 0, true);
+}
+
 int mangoh_bridge_registerCommandProcessor(mangoh_bridge_t* bridge, uint8_t cmd, void* module, mangoh_bridge_cmd_proc_func_t cmdProc)
 {
     int32_t res = LE_OK;
@@ -908,48 +2240,94 @@ cleanup:
 int mangoh_bridge_destroy(mangoh_bridge_t* bridge)
 {
     int32_t res = LE_OK;
+    int32_t err = LE_OK;
 
     LE_ASSERT(bridge);
 
-    res = mangoh_bridge_stop(bridge);
-    if (res)
+    // Every step is run even after a failure so nothing is left referring to the bridge, the first error is returned
+    err = mangoh_bridge_stop(bridge);
+    if (err != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_stop() failed(%d)", res);
-        goto cleanup;
+        LE_ERROR("ERROR mangoh_bridge_stop() failed(%d)", err);
+        res = (res != LE_OK) ? res:err;
     }
 
-    res = mangoh_bridge_fileio_destroy(&bridge->modules.fileio);
-    if (res != LE_OK)
+    err = mangoh_bridge_air_vantage_destroy(&bridge->modules.airVantage);
+    if (err != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_fileio_destroy() failed(%d)", res);
-        goto cleanup;
+        LE_ERROR("ERROR mangoh_bridge_air_vantage_destroy() failed(%d)", err);
+        res = (res != LE_OK) ? res:err;
     }
 
-    res = mangoh_bridge_console_destroy(&bridge->modules.console);
-    if (res != LE_OK)
+    err = mangoh_bridge_sockets_destroy(&bridge->modules.sockets);
+    if (err != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_console_destroy() failed(%d)", res);
-        goto cleanup;
+        LE_ERROR("ERROR mangoh_bridge_sockets_destroy() failed(%d)", err);
+        res = (res != LE_OK) ? res:err;
     }
 
-    res = mangoh_bridge_mailbox_destroy(&bridge->modules.mailbox);
-    if (res != LE_OK)
+    err = mangoh_bridge_processes_destroy(&bridge->modules.processes);
+    if (err != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_processes_destroy() failed(%d)", err);
+        res = (res != LE_OK) ? res:err;
+    }
+
+    err = mangoh_bridge_mailbox_destroy(&bridge->modules.mailbox);
+    if (err != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_mailbox_destroy() failed(%d)", err);
+        res = (res != LE_OK) ? res:err;
+    }
+
+    err = mangoh_bridge_console_destroy(&bridge->modules.console);
+    if (err != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_console_destroy() failed(%d)", err);
+        res = (res != LE_OK) ? res:err;
+    }
+
+    err = mangoh_bridge_fileio_destroy(&bridge->modules.fileio);
+    if (err != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_fileio_destroy() failed(%d)", err);
+        res = (res != LE_OK) ? res:err;
+    }
+
+    mangoh_bridge_release(bridge);
+
+    return res;
+}
+
+static int mangoh_bridge_create(const char* serialPort, uint32_t instance)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(serialPort);
+
+    mangoh_bridge_t* bridge = calloc(1, sizeof(mangoh_bridge_t));
+    if (!bridge)
     {
-        LE_ERROR("ERROR mangoh_bridge_mailbox_destroy() failed(%d)", res);
+        LE_ERROR("ERROR calloc() failed");
+        res = LE_NO_MEMORY;
         goto cleanup;
     }
 
-    res = mangoh_bridge_processes_destroy(&bridge->modules.processes);
+    res = mangoh_bridge_init(bridge, serialPort, instance);
     if (res != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_processes_destroy() failed(%d)", res);
+        LE_ERROR("ERROR mangoh_bridge_init() '%s' failed(%d)", serialPort, res);
+        free(bridge);
         goto cleanup;
     }
 
-    res = mangoh_bridge_air_vantage_destroy(&bridge->modules.airVantage);
+    le_sls_Queue(&mangoh_bridge_list, &bridge->link);
+
+    LE_INFO("start bridge %u '%s'...", instance, serialPort);
+    res = mangoh_bridge_start(bridge);
     if (res != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_air_vantage_destroy() failed(%d)", res);
+        LE_ERROR("ERROR mangoh_bridge_start() '%s' failed(%d)", serialPort, res);
         goto cleanup;
     }
 
@@ -957,35 +2335,59 @@ cleanup:
     return res;
 }
 
-__inline mangoh_bridge_air_vantage_t* mangoh_bridge_getAirVantageModule(void)
-{
-  return &bridge.modules.airVantage;
-}
-
 COMPONENT_INIT
 {
     int32_t res = LE_OK;
 
     LE_INFO("mangOH Arduino Bridge Service Starting");
 
+    BridgeTraceRef = le_log_GetTraceRef("Bridge");
+    mangoh_bridge_list = LE_SLS_LIST_INIT;
+
     le_sig_Block(SIGTERM);
     le_sig_SetEventHandler(SIGTERM, mangoh_bridge_SigTermEventHandler);
-
-    res = mangoh_bridge_init(&bridge);
+    le_sig_Block(SIGCHLD);
+    le_sig_SetEventHandler(SIGCHLD, mangoh_bridge_SigChldEventHandler);
+    le_sig_Block(SIGUSR1);
+    le_sig_SetEventHandler(SIGUSR1, mangoh_bridge_SigUsr1EventHandler);
+    le_sig_Block(SIGUSR2);
+    le_sig_SetEventHandler(SIGUSR2, mangoh_bridge_SigUsr2EventHandler);
+
+    res = mangoh_bridge_packet_crcInit(MANGOH_BRIDGE_PACKET_CRC_ENGINE);
     if (res != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_init() failed(%d)", res);
-        goto cleanup;
+        LE_ERROR("ERROR mangoh_bridge_packet_crcInit() failed(%d)", res);
     }
 
-    LE_INFO("start bridge...");
-    res = mangoh_bridge_start(&bridge);
-    if (res != LE_OK)
+    LE_FATAL_IF(mangoh_muxCtrl_ArduinoAssertReset() != LE_OK, "Couldn't assert the Arduino reset");
+    // Sleep for a while to ensure that the Arduino catches the reset
+    usleep(300);
+
+    // One bridge per serial port given on the command line, all served by this event loop
+    size_t numPorts = le_arg_NumArgs();
+    if (!numPorts)
     {
-        LE_ERROR("ERROR mangoh_bridge_start() failed(%d)", res);
-        goto cleanup;
+        res = mangoh_bridge_create(MANGOH_BRIDGE_SERIAL_PORT_FN, 0);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_create() failed(%d)", res);
+        }
     }
 
-cleanup:
-    return;
+    size_t idx = 0;
+    uint32_t instance = 0;
+    for (idx = 0; idx < numPorts; idx++)
+    {
+        const char* serialPort = le_arg_GetArg(idx);
+        if (!serialPort)
+        {
+            continue;
+        }
+
+        res = mangoh_bridge_create(serialPort, instance++);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_create() failed(%d)", res);
+        }
+    }
 }
@@ -5,7 +5,10 @@
  *
  * This module is the main module for executing the Arduino Yun bridge protocol.  The module provides functions for
  * bridge initialization and destroying as well functions to register command processors, processing loop runners, and
- * reset command functions.
+ * reset command functions.  A command processor may defer its response and complete it later, e.g. from a worker pool
+ * job, while the bridge keeps serving other requests.  Responses never block on the serial port, a response that does
+ * not fit in the transmit ring is refused with LE_WOULD_BLOCK and replayed when the MCU retransmits its request.
+ * Every frame received or written is kept in a capture ring, send SIGUSR2 to save it as a pcap file.
  *
  * <HR>
  *
@@ -19,20 +22,54 @@
 #include "mailbox.h"
 #include "processes.h"
 #include "sockets.h"
+#include "transport.h"
+#include "stats.h"
+#include "capture.h"
+#include "queue.h"
+#include "worker.h"
 
 #ifndef MANGOH_BRIDGE_INCLUDE_GUARD
 #define MANGOH_BRIDGE_INCLUDE_GUARD
 
-#define MANGOH_BRIDGE_READ_WAIT_MICROSEC        50000
 #define MANGOH_BRIDGE_NUMBER_OF_COMMANDS        256
 #define MANGOH_BRIDGE_SERIAL_PORT_FN_MAX_LEN    32
 #define MANGOH_BRIDGE_FD_MONITOR_NAME           "BridgeFdMonitor"
 #define MANGOH_BRIDGE_SERIAL_PORT_FN            "/dev/ttyUSB0"
-#define MANGOH_BRIDGE_SERIAL_FD_INVALID         -1
+#define MANGOH_BRIDGE_SERIAL_RX_RING_SIZE       4096
+#define MANGOH_BRIDGE_SERIAL_RX_RING_MASK       (MANGOH_BRIDGE_SERIAL_RX_RING_SIZE - 1)
+#define MANGOH_BRIDGE_SERIAL_TX_RING_SIZE       32768
+#define MANGOH_BRIDGE_RX_HEADER_SIZE            (sizeof(uint8_t) + sizeof(uint8_t) + sizeof(uint16_t))
+#define MANGOH_BRIDGE_BAUD_DEFAULT              115200
+#define MANGOH_BRIDGE_BAUD_FALLBACK_CRC_ERRORS  3
+#define MANGOH_BRIDGE_BAUD_VERIFY_TIMEOUT_MS    2000
+#define MANGOH_BRIDGE_BAUD_TIMER_NAME           "BridgeBaudTimer"
+#define MANGOH_BRIDGE_BAUD_DRAIN_TIMER_NAME     "BridgeBaudDrainTimer"
+#define MANGOH_BRIDGE_BAUD_DRAIN_POLL_MS        5
+#define MANGOH_BRIDGE_BAUD_DRAIN_MAX_POLLS      200
+#define MANGOH_BRIDGE_RECONNECT_MIN_MS          250
+#define MANGOH_BRIDGE_RECONNECT_MAX_MS          30000
+#define MANGOH_BRIDGE_RECONNECT_TIMER_NAME      "BridgeReconnectTimer"
+#define MANGOH_BRIDGE_WINDOW_MAX                8
+#define MANGOH_BRIDGE_NUMBER_OF_INDEXES         256
+#define MANGOH_BRIDGE_RSP_CACHE_SIZE            (sizeof(uint8_t) + sizeof(uint8_t) + sizeof(uint16_t) + MANGOH_BRIDGE_PACKET_DATA_SIZE + sizeof(uint16_t))
 
 #define MANGOH_BRIDGE_RESULT_OK                 0
 #define MANGOH_BRIDGE_RESULT_FAILED             1
 
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Bridge frame decoder states
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef enum _mangoh_bridge_rx_state_t
+{
+    MANGOH_BRIDGE_RX_STATE_START = 0, ///< Waiting for the start byte
+    MANGOH_BRIDGE_RX_STATE_IDX,       ///< Receiving the message index
+    MANGOH_BRIDGE_RX_STATE_LEN,       ///< Receiving the payload length
+    MANGOH_BRIDGE_RX_STATE_PAYLOAD,   ///< Receiving the payload
+    MANGOH_BRIDGE_RX_STATE_CRC,       ///< Receiving the CRC
+} mangoh_bridge_rx_state_t;
+
 typedef int (*mangoh_bridge_cmd_proc_func_t)(void*, const unsigned char*, uint32_t);
 typedef int (*mangoh_bridge_runner_func_t)(void*);
 typedef int (*mangoh_bridge_reset_func_t)(void*);
@@ -110,22 +147,182 @@ typedef struct _mangoh_bridge_modules_t
     mangoh_bridge_air_vantage_t airVantage; ///< Bridge custom Air Vantage module
 } mangoh_bridge_modules_t;
 
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Bridge serial receive ring
+ *
+ * Head and tail are free running counters, the ring size must be a power of two.
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_serial_ring_t
+{
+    uint8_t  data[MANGOH_BRIDGE_SERIAL_RX_RING_SIZE]; ///< Ring storage
+    uint32_t head;                                    ///< Next byte to consume
+    uint32_t tail;                                    ///< Next byte to fill
+    uint32_t mark;                                    ///< Start byte of the frame being decoded
+} mangoh_bridge_serial_ring_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Bridge serial receive error counters
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_rx_stats_t
+{
+    uint32_t discarded; ///< Bytes dropped while looking for a frame start
+    uint32_t skipped;   ///< Bytes dropped since the last frame start
+    uint32_t crcErrors; ///< Frames failing the CRC check
+    uint32_t lenErrors; ///< Start bytes followed by an invalid length
+} mangoh_bridge_rx_stats_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Bridge response, replayed when the MCU retransmits a request
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_rsp_cache_t
+{
+    uint8_t  data[MANGOH_BRIDGE_RSP_CACHE_SIZE]; ///< Response as sent on the wire
+    uint32_t len;                                ///< Response length
+    uint8_t  idx;                                ///< Response message index
+    bool     valid;                              ///< Response can be replayed
+} mangoh_bridge_rsp_cache_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Bridge request window
+ *
+ * The MCU may have up to size requests in flight, each with its own message index.  Requests are still processed in
+ * the order received, the responses of the last size requests are kept for replay.
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_window_t
+{
+    mangoh_bridge_rsp_cache_t rsp[MANGOH_BRIDGE_WINDOW_MAX]; ///< Last responses sent
+    uint8_t                   size;                          ///< Negotiated window size
+    uint8_t                   next;                          ///< Next response slot to overwrite
+} mangoh_bridge_window_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Bridge serial transmit ring
+ *
+ * Responses are copied in as complete frames and written without blocking when the serial port reports POLLOUT, so the
+ * next request is decoded while earlier responses are still going out.  Frame decoding stalls while the ring cannot
+ * take a full size response.
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_tx_ring_t
+{
+    uint8_t               data[MANGOH_BRIDGE_SERIAL_TX_RING_SIZE]; ///< Ring storage
+    mangoh_bridge_queue_t queue;                                   ///< Bytes not written yet
+    bool                  stalled;                                 ///< Receive paused until the ring has room for a response
+} mangoh_bridge_tx_ring_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Bridge deferred response
+ *
+ * Taken by a command processor that completes its request later, typically from a worker pool job.  It is owned by the
+ * command processor until passed back to mangoh_bridge_completeResult() or mangoh_bridge_completeNack().
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_pending_t
+{
+    struct timespec start;      ///< Request start time for the latency statistics
+    int32_t         statsCmd;   ///< Command being measured or NONE
+    uint32_t        generation; ///< Bridge generation of the request
+    uint8_t         idx;        ///< Request message index
+} mangoh_bridge_pending_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Bridge deferred requests
+ *
+ * The bridge keeps decoding frames while deferred requests are worked on.  A retransmitted request still in flight is
+ * ignored, its response is sent when completed.  A reset or stop bumps the generation so the completions of requests
+ * made before it are dropped.
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_deferred_t
+{
+    bool     inFlight[MANGOH_BRIDGE_NUMBER_OF_INDEXES]; ///< Request indexes waiting for their response
+    uint32_t generation;                                ///< Incremented by each reset or stop
+} mangoh_bridge_deferred_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Bridge serial baud rate negotiation
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_baud_t
+{
+    le_timer_Ref_t timer;      ///< Fallback timer armed after switching rate
+    le_timer_Ref_t drainTimer; ///< Polls the UART output queue before switching rate
+    uint32_t       rate;       ///< Current baud rate
+    uint32_t       crcErrors;  ///< Consecutive CRC failures
+    uint32_t       next;       ///< Rate to switch to once the transmit ring and the UART are empty, 0 if none
+    uint32_t       drainPolls; ///< Output queue polls for the pending switch
+    bool           verifying;  ///< No valid frame received yet at the current rate
+} mangoh_bridge_baud_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Bridge serial reconnection
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_reconnect_t
+{
+    le_timer_Ref_t timer;      ///< Timer retrying to open the serial port
+    uint32_t       delayMs;    ///< Delay before the next attempt, doubled after each failure
+    uint32_t       generation; ///< Bumped at stop so a stale address lookup is dropped
+    bool           resolving;  ///< Address lookup running on the worker pool
+    bool           connecting; ///< Socket connection waiting for POLLOUT
+} mangoh_bridge_reconnect_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Bridge payload compression
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_codec_t
+{
+    uint8_t buff[MANGOH_BRIDGE_PACKET_DATA_SIZE]; ///< Scratch buffer for encoding/decoding a payload
+    uint8_t type;                                 ///< Negotiated compression type
+} mangoh_bridge_codec_t;
+
 //------------------------------------------------------------------------------------------------------------------
 /**
  * Bridge module
+ *
+ * One instance per serial port, each with its own packet state, command table and sub-modules.  The console and
+ * mailbox servers of an instance listen on their base port plus the instance index.
  */
 //------------------------------------------------------------------------------------------------------------------
 typedef struct _mangoh_bridge_t
 {
-    mangoh_bridge_cmd_proc_t cmdHdlrs[MANGOH_BRIDGE_NUMBER_OF_COMMANDS]; ///< List of command processors
-    mangoh_bridge_packet_t   packet;                                     ///< Bridge packet
-    mangoh_bridge_modules_t  modules;                                    ///< Bridge sub-modules
-    fd_set                   readfds;                                    ///< Read fd set
-    le_sls_List_t            runnerList;                                 ///< Bridge functions run in each processing loop
-    le_sls_List_t            resetList;                                  ///< Bridge functions run when a reset is received
-    le_fdMonitor_Ref_t       fdMonitor;                                  ///< UART Bridge serial file monitor
-    int                      serialFd;                                   ///< UART Bridge serial file descriptor
-    bool                     closed;                                     ///< Bridge closed flag
+    mangoh_bridge_cmd_proc_t    cmdHdlrs[MANGOH_BRIDGE_NUMBER_OF_COMMANDS]; ///< List of command processors
+    mangoh_bridge_packet_t      packet;                                     ///< Bridge packet
+    mangoh_bridge_modules_t     modules;                                    ///< Bridge sub-modules
+    mangoh_bridge_serial_ring_t rxRing;                                     ///< UART Bridge serial receive ring
+    mangoh_bridge_rx_stats_t    rxStats;                                    ///< UART Bridge serial receive error counters
+    mangoh_bridge_window_t      window;                                     ///< Request window and response replay cache
+    mangoh_bridge_deferred_t    deferred;                                   ///< Requests completed later
+    mangoh_bridge_tx_ring_t     txRing;                                     ///< UART Bridge serial transmit ring
+    mangoh_bridge_baud_t        baud;                                       ///< UART Bridge baud rate
+    mangoh_bridge_reconnect_t   reconnect;                                  ///< UART Bridge serial reconnection
+    mangoh_bridge_codec_t       codec;                                      ///< Payload compression
+    mangoh_bridge_stats_t       stats;                                      ///< Per command statistics
+    mangoh_bridge_capture_t     capture;                                    ///< Recent frames capture ring
+    mangoh_bridge_rx_state_t    rxState;                                    ///< UART Bridge frame decoder state
+    uint32_t                    rxCount;                                    ///< Bytes received of the current frame field
+    le_sls_List_t               runnerList;                                 ///< Bridge functions run in each processing loop
+    le_sls_List_t               resetList;                                  ///< Bridge functions run when a reset is received
+    le_fdMonitor_Ref_t          fdMonitor;                                  ///< UART Bridge serial file monitor
+    mangoh_bridge_transport_t   transport;                                  ///< UART Bridge serial transport
+    uint32_t                    instance;                                   ///< Instance index, offsets the server ports
+    bool                        closed;                                     ///< Bridge closed flag
+    le_sls_Link_t               link;                                       ///< Bridge instance list link
 } mangoh_bridge_t;
 
 int mangoh_bridge_registerCommandProcessor(mangoh_bridge_t*, uint8_t, void*, mangoh_bridge_cmd_proc_func_t);
@@ -136,8 +333,12 @@ int mangoh_bridge_sendResult(mangoh_bridge_t*, uint32_t);
 int mangoh_bridge_sendAck(mangoh_bridge_t*);
 int mangoh_bridge_sendNack(mangoh_bridge_t*);
 
-mangoh_bridge_air_vantage_t* mangoh_bridge_getAirVantageModule(void);
+void mangoh_bridge_deferResult(mangoh_bridge_t*, mangoh_bridge_pending_t*);
+int mangoh_bridge_completeResult(mangoh_bridge_t*, const mangoh_bridge_pending_t*, const void*, uint32_t);
+int mangoh_bridge_completeNack(mangoh_bridge_t*, const mangoh_bridge_pending_t*);
+
 le_log_TraceRef_t mangoh_bridge_getTraceRef(void);
+void mangoh_bridge_getFileName(const mangoh_bridge_t*, char*, uint32_t);
 
 int mangoh_bridge_destroy(mangoh_bridge_t*);
 
@@ -0,0 +1,170 @@
+/**
+ * @file
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless, Inc. Use of this work is subject to license.
+ */
+
+#include <stdio.h>
+#include "legato.h"
+#include "capture.h"
+
+static int mangoh_bridge_capture_write(const mangoh_bridge_capture_t*, uint32_t, uint32_t, FILE*);
+
+static int mangoh_bridge_capture_write(const mangoh_bridge_capture_t* capture, uint32_t offset, uint32_t len, FILE* file)
+{
+    struct iovec iov[MANGOH_BRIDGE_QUEUE_NUM_IOVS];
+    int32_t res = LE_OK;
+
+    int iovcnt = mangoh_bridge_queue_peekIov(&capture->ring, offset, iov, len);
+    int idx = 0;
+    for (idx = 0; idx < iovcnt; idx++)
+    {
+        if (fwrite(iov[idx].iov_base, 1, iov[idx].iov_len, file) != iov[idx].iov_len)
+        {
+            LE_ERROR("ERROR fwrite() failed(%d)", errno);
+            res = LE_IO_ERROR;
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    return res;
+}
+
+void mangoh_bridge_capture_add(mangoh_bridge_capture_t* capture, uint8_t flags, const struct iovec* iov, int iovcnt)
+{
+    mangoh_bridge_capture_record_t record = {0};
+    struct timespec now = {0};
+    int idx = 0;
+
+    LE_ASSERT(capture);
+    LE_ASSERT(iov);
+
+    for (idx = 0; idx < iovcnt; idx++)
+    {
+        record.origLen += iov[idx].iov_len;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    record.len = (record.origLen < MANGOH_BRIDGE_CAPTURE_SNAP_LEN) ? record.origLen:MANGOH_BRIDGE_CAPTURE_SNAP_LEN;
+    record.sec = now.tv_sec;
+    record.nsec = now.tv_nsec;
+    record.flags = flags;
+
+    // Make room by dropping the oldest records
+    const uint32_t needed = sizeof(record) + record.len;
+    while (mangoh_bridge_queue_room(&capture->ring) < needed)
+    {
+        mangoh_bridge_capture_record_t oldest;
+        mangoh_bridge_queue_read(&capture->ring, &oldest, sizeof(oldest));
+        mangoh_bridge_queue_consume(&capture->ring, oldest.len);
+        capture->dropped++;
+    }
+
+    mangoh_bridge_queue_write(&capture->ring, &record, sizeof(record));
+
+    uint32_t remaining = record.len;
+    for (idx = 0; (idx < iovcnt) && remaining; idx++)
+    {
+        uint32_t len = (iov[idx].iov_len < remaining) ? iov[idx].iov_len:remaining;
+        mangoh_bridge_queue_write(&capture->ring, iov[idx].iov_base, len);
+        remaining -= len;
+    }
+}
+
+int mangoh_bridge_capture_save(const mangoh_bridge_capture_t* capture, const char* path)
+{
+    FILE* file = NULL;
+    int32_t res = LE_OK;
+    uint32_t count = 0;
+
+    LE_ASSERT(capture);
+    LE_ASSERT(path);
+
+    file = fopen(path, "w");
+    if (!file)
+    {
+        LE_ERROR("ERROR fopen() '%s' failed(%d)", path, errno);
+        res = LE_IO_ERROR;
+        goto cleanup;
+    }
+
+    const mangoh_bridge_capture_pcap_hdr_t hdr =
+    {
+        .magic = MANGOH_BRIDGE_CAPTURE_PCAP_MAGIC_NSEC,
+        .versionMajor = MANGOH_BRIDGE_CAPTURE_PCAP_VERSION_MAJOR,
+        .versionMinor = MANGOH_BRIDGE_CAPTURE_PCAP_VERSION_MINOR,
+        .snapLen = MANGOH_BRIDGE_CAPTURE_SNAP_LEN + sizeof(uint8_t),
+        .linkType = MANGOH_BRIDGE_CAPTURE_PCAP_LINKTYPE_USER0,
+    };
+
+    if (fwrite(&hdr, sizeof(hdr), 1, file) != 1)
+    {
+        LE_ERROR("ERROR fwrite() '%s' failed(%d)", path, errno);
+        res = LE_IO_ERROR;
+        goto cleanup;
+    }
+
+    // Records carry monotonic time, shift them to wall clock time for the capture tools
+    struct timespec mono = {0};
+    struct timespec real = {0};
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    clock_gettime(CLOCK_REALTIME, &real);
+    const int64_t offsetNs = ((int64_t)real.tv_sec - mono.tv_sec) * 1000000000 + (real.tv_nsec - mono.tv_nsec);
+
+    // Walked from the head without consuming, the frames stay in the ring
+    uint32_t pos = 0;
+    while (pos < mangoh_bridge_queue_len(&capture->ring))
+    {
+        mangoh_bridge_capture_record_t record;
+        mangoh_bridge_queue_peek(&capture->ring, pos, &record, sizeof(record));
+        pos += sizeof(record);
+
+        const int64_t timeNs = (int64_t)record.sec * 1000000000 + record.nsec + offsetNs;
+        const mangoh_bridge_capture_pcap_rec_t rec =
+        {
+            .sec = timeNs / 1000000000,
+            .nsec = timeNs % 1000000000,
+            .inclLen = record.len + sizeof(record.flags),
+            .origLen = record.origLen + sizeof(record.flags),
+        };
+
+        if ((fwrite(&rec, sizeof(rec), 1, file) != 1) || (fwrite(&record.flags, sizeof(record.flags), 1, file) != 1))
+        {
+            LE_ERROR("ERROR fwrite() '%s' failed(%d)", path, errno);
+            res = LE_IO_ERROR;
+            goto cleanup;
+        }
+
+        res = mangoh_bridge_capture_write(capture, pos, record.len, file);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_capture_write() '%s' failed(%d)", path, res);
+            goto cleanup;
+        }
+
+        pos += record.len;
+        count++;
+    }
+
+    LE_INFO("saved %u frames to '%s', %u older frames dropped", count, path, capture->dropped);
+
+cleanup:
+    if (file && fclose(file))
+    {
+        LE_ERROR("ERROR fclose() '%s' failed(%d)", path, errno);
+        res = LE_IO_ERROR;
+    }
+
+    return res;
+}
+
+void mangoh_bridge_capture_init(mangoh_bridge_capture_t* capture)
+{
+    LE_ASSERT(capture);
+
+    mangoh_bridge_queue_init(&capture->ring, capture->data, sizeof(capture->data));
+    capture->dropped = 0;
+}
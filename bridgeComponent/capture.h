@@ -0,0 +1,96 @@
+/*
+ * @file mangoh_bridge_capture.h
+ *
+ * Arduino bridge frame capture module.
+ *
+ * An always-on ring of the last frames exchanged with the MCU, recorded as raw wire bytes with a monotonic timestamp
+ * and a direction.  Recording a frame costs a clock read and a copy, the oldest frames are dropped when the ring is
+ * full.  Send SIGUSR2 to save the ring of each bridge as a pcap file, every packet starts with a one byte pseudo header
+ * holding the capture flags and is followed by the frame as sent on the wire.
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+#include <sys/uio.h>
+#include "legato.h"
+#include "queue.h"
+
+#ifndef MANGOH_BRIDGE_CAPTURE_INCLUDE_GUARD
+#define MANGOH_BRIDGE_CAPTURE_INCLUDE_GUARD
+
+#define MANGOH_BRIDGE_CAPTURE_RING_SIZE           65536
+#define MANGOH_BRIDGE_CAPTURE_SNAP_LEN            8192
+#define MANGOH_BRIDGE_CAPTURE_PATH_MAX_LEN        192
+#define MANGOH_BRIDGE_CAPTURE_PATH_FORMAT         "/tmp/mangoh_bridge_%s.pcap"
+
+#define MANGOH_BRIDGE_CAPTURE_PCAP_MAGIC_NSEC     0xa1b23c4d
+#define MANGOH_BRIDGE_CAPTURE_PCAP_VERSION_MAJOR  2
+#define MANGOH_BRIDGE_CAPTURE_PCAP_VERSION_MINOR  4
+#define MANGOH_BRIDGE_CAPTURE_PCAP_LINKTYPE_USER0 147
+
+#define MANGOH_BRIDGE_CAPTURE_RX                  0x00
+#define MANGOH_BRIDGE_CAPTURE_TX                  0x01
+#define MANGOH_BRIDGE_CAPTURE_CRC_ERROR           0x02
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Captured frame header, followed by the frame bytes in the ring
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_capture_record_t
+{
+    uint32_t len;         ///< Captured frame length
+    uint32_t origLen;     ///< Frame length on the wire
+    uint32_t sec;         ///< Monotonic timestamp seconds
+    uint32_t nsec;        ///< Monotonic timestamp nanoseconds
+    uint8_t  flags;       ///< Direction and error flags
+    uint8_t  reserved[3];
+} mangoh_bridge_capture_record_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * pcap file header
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_capture_pcap_hdr_t
+{
+    uint32_t magic;
+    uint16_t versionMajor;
+    uint16_t versionMinor;
+    int32_t  thisZone;
+    uint32_t sigFigs;
+    uint32_t snapLen;
+    uint32_t linkType;
+} mangoh_bridge_capture_pcap_hdr_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * pcap packet header
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_capture_pcap_rec_t
+{
+    uint32_t sec;
+    uint32_t nsec;
+    uint32_t inclLen;
+    uint32_t origLen;
+} mangoh_bridge_capture_pcap_rec_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Frame capture ring
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_capture_t
+{
+    uint8_t               data[MANGOH_BRIDGE_CAPTURE_RING_SIZE]; ///< Records storage
+    mangoh_bridge_queue_t ring;                                  ///< Records, oldest at the head
+    uint32_t              dropped;                               ///< Records overwritten since the start
+} mangoh_bridge_capture_t;
+
+void mangoh_bridge_capture_add(mangoh_bridge_capture_t*, uint8_t, const struct iovec*, int);
+int mangoh_bridge_capture_save(const mangoh_bridge_capture_t*, const char*);
+void mangoh_bridge_capture_init(mangoh_bridge_capture_t*);
+
+#endif
@@ -0,0 +1,182 @@
+/**
+ * @file
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless, Inc. Use of this work is subject to license.
+ */
+
+#include "legato.h"
+#include "compress.h"
+
+static uint32_t mangoh_bridge_compress_hash(const uint8_t*);
+
+static uint32_t mangoh_bridge_compress_hash(const uint8_t* data)
+{
+    uint32_t val = ((uint32_t)data[0] << 16) | ((uint32_t)data[1] << 8) | data[2];
+    return ((val * 2654435761U) >> (32 - MANGOH_BRIDGE_COMPRESS_HASH_BITS)) & (MANGOH_BRIDGE_COMPRESS_HASH_SIZE - 1);
+}
+
+int mangoh_bridge_compress_encode(const uint8_t* in, uint32_t inLen, uint8_t* out, uint32_t outSize, uint32_t* outLen)
+{
+    int32_t hashTable[MANGOH_BRIDGE_COMPRESS_HASH_SIZE];
+    uint32_t inPos = 0;
+    uint32_t outPos = 0;
+    uint32_t flagPos = 0;
+    uint32_t token = MANGOH_BRIDGE_COMPRESS_GROUP_TOKENS;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(in);
+    LE_ASSERT(out);
+    LE_ASSERT(outLen);
+
+    memset(hashTable, 0xFF, sizeof(hashTable));
+
+    while (inPos < inLen)
+    {
+        if (token == MANGOH_BRIDGE_COMPRESS_GROUP_TOKENS)
+        {
+            if (outPos >= outSize)
+            {
+                res = LE_OVERFLOW;
+                goto cleanup;
+            }
+
+            flagPos = outPos++;
+            out[flagPos] = 0;
+            token = 0;
+        }
+
+        uint32_t matchLen = 0;
+        uint32_t matchOffset = 0;
+        if (inLen - inPos >= MANGOH_BRIDGE_COMPRESS_MIN_MATCH)
+        {
+            uint32_t hash = mangoh_bridge_compress_hash(&in[inPos]);
+            int32_t candidate = hashTable[hash];
+            hashTable[hash] = inPos;
+
+            if ((candidate >= 0) && (inPos - candidate <= MANGOH_BRIDGE_COMPRESS_MAX_OFFSET))
+            {
+                uint32_t maxLen = (inLen - inPos < MANGOH_BRIDGE_COMPRESS_MAX_MATCH) ? inLen - inPos:MANGOH_BRIDGE_COMPRESS_MAX_MATCH;
+                while ((matchLen < maxLen) && (in[candidate + matchLen] == in[inPos + matchLen]))
+                {
+                    matchLen++;
+                }
+
+                matchOffset = inPos - candidate;
+            }
+        }
+
+        if (matchLen >= MANGOH_BRIDGE_COMPRESS_MIN_MATCH)
+        {
+            if (outPos + sizeof(uint16_t) > outSize)
+            {
+                res = LE_OVERFLOW;
+                goto cleanup;
+            }
+
+            uint16_t code = ((matchOffset - 1) << 4) | (matchLen - MANGOH_BRIDGE_COMPRESS_MIN_MATCH);
+            out[outPos++] = code >> 8;
+            out[outPos++] = code & 0xFF;
+            out[flagPos] |= 1 << token;
+
+            // Index the positions covered by the match so later data can refer to them
+            uint32_t idx = 0;
+            for (idx = 1; (idx < matchLen) && (inPos + idx + MANGOH_BRIDGE_COMPRESS_MIN_MATCH <= inLen); idx++)
+            {
+                hashTable[mangoh_bridge_compress_hash(&in[inPos + idx])] = inPos + idx;
+            }
+
+            inPos += matchLen;
+        }
+        else
+        {
+            if (outPos >= outSize)
+            {
+                res = LE_OVERFLOW;
+                goto cleanup;
+            }
+
+            out[outPos++] = in[inPos++];
+        }
+
+        token++;
+    }
+
+    *outLen = outPos;
+
+cleanup:
+    return res;
+}
+
+int mangoh_bridge_compress_decode(const uint8_t* in, uint32_t inLen, uint8_t* out, uint32_t outSize, uint32_t* outLen)
+{
+    uint32_t inPos = 0;
+    uint32_t outPos = 0;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(in);
+    LE_ASSERT(out);
+    LE_ASSERT(outLen);
+
+    while (inPos < inLen)
+    {
+        uint8_t flags = in[inPos++];
+        uint32_t token = 0;
+
+        for (token = 0; (token < MANGOH_BRIDGE_COMPRESS_GROUP_TOKENS) && (inPos < inLen); token++)
+        {
+            if (flags & (1 << token))
+            {
+                if (inPos + sizeof(uint16_t) > inLen)
+                {
+                    LE_ERROR("ERROR truncated match");
+                    res = LE_FORMAT_ERROR;
+                    goto cleanup;
+                }
+
+                uint16_t code = ((uint16_t)in[inPos] << 8) | in[inPos + 1];
+                inPos += sizeof(uint16_t);
+
+                uint32_t offset = (code >> 4) + 1;
+                uint32_t len = (code & 0x0F) + MANGOH_BRIDGE_COMPRESS_MIN_MATCH;
+                if (offset > outPos)
+                {
+                    LE_ERROR("ERROR invalid match offset(%u > %u)", offset, outPos);
+                    res = LE_FORMAT_ERROR;
+                    goto cleanup;
+                }
+
+                if (outPos + len > outSize)
+                {
+                    LE_ERROR("ERROR output overflow(%u > %u)", outPos + len, outSize);
+                    res = LE_OVERFLOW;
+                    goto cleanup;
+                }
+
+                // Byte copy, a match may overlap the bytes it produces
+                while (len--)
+                {
+                    out[outPos] = out[outPos - offset];
+                    outPos++;
+                }
+            }
+            else
+            {
+                if (outPos >= outSize)
+                {
+                    LE_ERROR("ERROR output overflow(%u)", outSize);
+                    res = LE_OVERFLOW;
+                    goto cleanup;
+                }
+
+                out[outPos++] = in[inPos++];
+            }
+        }
+    }
+
+    *outLen = outPos;
+
+cleanup:
+    return res;
+}
@@ -0,0 +1,36 @@
+/*
+ * @file mangoh_bridge_compress.h
+ *
+ * Arduino bridge payload compression module.
+ *
+ * Small footprint LZSS codec used to compress frame payloads when negotiated at reset.  Every payload is compressed
+ * on its own, back references only point into the output produced so far so a decoder needs no window beyond the
+ * payload buffer itself.
+ *
+ * The stream is a sequence of groups, each group starts with a flag byte followed by up to eight tokens.  Flag bit n
+ * (LSB first) set means token n is a match, otherwise it is a literal byte.  A match is two bytes, big endian, holding
+ * (offset - 1) in the upper 12 bits and (length - 3) in the lower 4 bits.
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+#include "legato.h"
+
+#ifndef MANGOH_BRIDGE_COMPRESS_INCLUDE_GUARD
+#define MANGOH_BRIDGE_COMPRESS_INCLUDE_GUARD
+
+#define MANGOH_BRIDGE_COMPRESS_NONE               0x00
+#define MANGOH_BRIDGE_COMPRESS_LZSS               0x01
+
+#define MANGOH_BRIDGE_COMPRESS_MIN_MATCH          3
+#define MANGOH_BRIDGE_COMPRESS_MAX_MATCH          (MANGOH_BRIDGE_COMPRESS_MIN_MATCH + 0x0F)
+#define MANGOH_BRIDGE_COMPRESS_MAX_OFFSET         0x1000
+#define MANGOH_BRIDGE_COMPRESS_HASH_BITS          10
+#define MANGOH_BRIDGE_COMPRESS_HASH_SIZE          (1 << MANGOH_BRIDGE_COMPRESS_HASH_BITS)
+#define MANGOH_BRIDGE_COMPRESS_GROUP_TOKENS       8
+
+int mangoh_bridge_compress_encode(const uint8_t*, uint32_t, uint8_t*, uint32_t, uint32_t*);
+int mangoh_bridge_compress_decode(const uint8_t*, uint32_t, uint8_t*, uint32_t, uint32_t*);
+
+#endif
@@ -20,7 +20,6 @@ static int mangoh_bridge_console_write(void*, const unsigned char*, uint32_t);
 static int mangoh_bridge_console_read(void*, const unsigned char*, uint32_t);
 static int mangoh_bridge_console_connected(void*, const unsigned char*, uint32_t);
 
-static int mangoh_bridge_console_runner(void*);
 static int mangoh_bridge_console_reset(void*);
 
 static int mangoh_bridge_console_write(void* param, const unsigned char* data, uint32_t size)
@@ -63,24 +62,20 @@ static int mangoh_bridge_console_read(void* param, const unsigned char* data, ui
     const mangoh_bridge_console_read_req_t* const req = (mangoh_bridge_console_read_req_t*)data;
     LE_DEBUG("---> READ length(%u)", req->len);
 
-    res = mangoh_bridge_tcp_client_getReceivedData(&console->clients, &console->rxBuffer[console->rxBuffLen], &console->rxBuffLen, sizeof(console->rxBuffer));
+    res = mangoh_bridge_tcp_client_getReceivedData(&console->clients, &console->rxQueue);
     if (res)
     {
         LE_ERROR("ERROR mangoh_bridge_tcp_client_getReceivedData() failed(%d)", res);
         goto cleanup;
     }
 
-    if (console->rxBuffLen)
+    if (mangoh_bridge_queue_len(&console->rxQueue))
     {
-        uint8_t rdLen = (req->len > console->rxBuffLen) ? console->rxBuffLen:req->len;
+        mangoh_bridge_console_read_rsp_t* const rsp = (mangoh_bridge_console_read_rsp_t*)((mangoh_bridge_t*)console->bridge)->packet.tx.data;
+        const uint32_t maxLen = ((mangoh_bridge_t*)console->bridge)->packet.dataSize;
+        uint8_t rdLen = mangoh_bridge_queue_read(&console->rxQueue, rsp->data, (req->len > maxLen) ? maxLen:req->len);
 
-        mangoh_bridge_console_read_rsp_t* const rsp = (mangoh_bridge_console_read_rsp_t*)((mangoh_bridge_t*)console->bridge)->packet.msg.data;
-        memcpy(rsp->data, (const char*)console->rxBuffer, rdLen);
-        memmove(console->rxBuffer, &console->rxBuffer[rdLen], console->rxBuffLen - rdLen);
-        memset(&console->rxBuffer[console->rxBuffLen - rdLen], 0, rdLen);
-        console->rxBuffLen -= rdLen;
-
-        LE_INFO("result(%d) '%s'", rdLen, rsp->data);
+        LE_INFO("result(%d) '%.*s'", rdLen, rdLen, rsp->data);
         res = mangoh_bridge_sendResult(console->bridge, rdLen);
         if (res)
         {
@@ -111,7 +106,7 @@ static int mangoh_bridge_console_connected(void* param, const unsigned char* dat
 
     LE_DEBUG("---> CONNECTED");
 
-    mangoh_bridge_console_connected_rsp_t* const rsp = (mangoh_bridge_console_connected_rsp_t*)((mangoh_bridge_t*)console->bridge)->packet.msg.data;
+    mangoh_bridge_console_connected_rsp_t* const rsp = (mangoh_bridge_console_connected_rsp_t*)((mangoh_bridge_t*)console->bridge)->packet.tx.data;
     mangoh_bridge_tcp_client_connected(&console->clients, &rsp->result);
 
     LE_DEBUG("result(%d)", rsp->result);
@@ -126,61 +121,22 @@ cleanup:
     return res;
 }
 
-static int mangoh_bridge_console_runner(void* param)
+static int mangoh_bridge_console_reset(void* param)
 {
     mangoh_bridge_console_t* console = (mangoh_bridge_console_t*)param;
     int32_t res = LE_OK;
 
     LE_ASSERT(console);
 
-    res = mangoh_bridge_tcp_server_acceptNewConnections(&console->server, &console->clients);
+    res = mangoh_bridge_tcp_client_closeAll(&console->clients);
     if (res != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_tcp_server_acceptNewConnections() failed(%d)", res);
+        LE_ERROR("ERROR mangoh_bridge_tcp_client_closeAll() failed(%d)", res);
         goto cleanup;
     }
 
-    res = mangoh_bridge_tcp_client_run(&console->clients);
-    if (res != LE_OK)
-    {
-        LE_ERROR("ERROR mangoh_bridge_tcp_client_run() failed(%d)", res);
-        goto cleanup;
-    }
-
-cleanup:
-    return res;
-}
-
-static int mangoh_bridge_console_reset(void* param)
-{
-    mangoh_bridge_console_t* console = (mangoh_bridge_console_t*)param;
-    int32_t res = LE_OK;
-
-    LE_ASSERT(console);
-
-    uint8_t idx = 0;
-    for (idx = 0; idx < MANGOH_BRIDGE_SOCKETS_MAX_CLIENTS; idx++)
-    {
-        if (console->clients.info[idx].sockFd != MANGOH_BRIDGE_SOCKETS_INVALID)
-        {
-            LE_DEBUG("close socket[%u](%d)", idx, console->clients.info[idx].sockFd);
-            res = close(console->clients.info[idx].sockFd);
-            if (res < 0)
-            {
-                LE_ERROR("ERROR close() failed(%d/%d)", res, errno);
-                res = LE_IO_ERROR;
-                goto cleanup;
-            }
-
-            console->clients.info[idx].sockFd = MANGOH_BRIDGE_SOCKETS_INVALID;
-            console->clients.info[idx].recvBuffLen = 0;
-            console->clients.info[idx].sendBuffLen = 0;
-        }
-    }
-
     console->clients.nextId = 0;
     console->clients.broadcast = 0;
-    console->clients.maxSockFd = 0;
 
 cleanup:
     return res;
@@ -195,11 +151,12 @@ int mangoh_bridge_console_init(mangoh_bridge_console_t* console, void* bridge)
     LE_DEBUG("init");
 
     console->bridge = bridge;
+    mangoh_bridge_queue_init(&console->rxQueue, console->rxBuffer, sizeof(console->rxBuffer));
 
     mangoh_bridge_tcp_client_init(&console->clients, true);
 
-    res = mangoh_bridge_tcp_server_start(&console->server, MANGOH_BRIDGE_CONSOLE_SERVER_IP_ADDR,
-            MANGOH_BRIDGE_CONSOLE_SERVER_PORT, MANGOH_BRIDGE_CONSOLE_SERVER_BACKLOG);
+    res = mangoh_bridge_tcp_server_start(&console->server, &console->clients, MANGOH_BRIDGE_CONSOLE_SERVER_IP_ADDR,
+            MANGOH_BRIDGE_CONSOLE_SERVER_PORT + ((mangoh_bridge_t*)bridge)->instance, MANGOH_BRIDGE_CONSOLE_SERVER_BACKLOG);
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_tcp_server_start() failed(%d)", res);
@@ -210,37 +167,35 @@ int mangoh_bridge_console_init(mangoh_bridge_console_t* console, void* bridge)
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_registerCommandProcessor() failed(%d)", res);
-        goto cleanup;
+        goto stopServer;
     }
 
     res = mangoh_bridge_registerCommandProcessor(console->bridge, MANGOH_BRIDGE_CONSOLE_READ, console, mangoh_bridge_console_read);
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_registerCommandProcessor() failed(%d)", res);
-        goto cleanup;
+        goto stopServer;
     }
 
     res = mangoh_bridge_registerCommandProcessor(console->bridge, MANGOH_BRIDGE_CONSOLE_CONNECTED, console, mangoh_bridge_console_connected);
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_registerCommandProcessor() failed(%d)", res);
-        goto cleanup;
-    }
-
-    res = mangoh_bridge_registerRunner(console->bridge, console, mangoh_bridge_console_runner);
-    if (res != LE_OK)
-    {
-        LE_ERROR("ERROR mangoh_bridge_registerRunner() failed(%d)", res);
-        goto cleanup;
+        goto stopServer;
     }
 
     res = mangoh_bridge_registerReset(console->bridge, console, mangoh_bridge_console_reset);
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_registerReset() failed(%d)", res);
-        goto cleanup;
+        goto stopServer;
     }
 
+    goto cleanup;
+
+stopServer:
+    mangoh_bridge_tcp_server_stop(&console->server);
+    mangoh_bridge_tcp_client_destroy(&console->clients);
 cleanup:
     LE_DEBUG("init completed(%d)", res);
     return res;
@@ -14,6 +14,7 @@
 #include "legato.h"
 #include "packet.h"
 #include "tcpClient.h"
+#include "queue.h"
 #include "tcpServer.h"
 
 #ifndef MANGOH_BRIDGE_CONSOLE_INCLUDE_GUARD
@@ -24,7 +25,7 @@
 #define MANGOH_BRIDGE_CONSOLE_CONNECTED                       'a'
 
 #define MANGOH_BRIDGE_CONSOLE_SERVER_IP_ADDR                  "127.0.0.1"
-#define MANGOH_BRIDGE_CONSOLE_SERVER_PORT                     "6571"
+#define MANGOH_BRIDGE_CONSOLE_SERVER_PORT                     6571
 #define MANGOH_BRIDGE_CONSOLE_SERVER_BACKLOG                  1
 #define MANGOH_BRIDGE_CONSOLE_RX_BUFF_SIZE                    1024
 
@@ -67,9 +68,9 @@ typedef struct _mangoh_bridge_console_t
 {
     mangoh_bridge_tcp_server_t server;                                       ///< Server
     mangoh_bridge_tcp_client_t clients;                                      ///< Clients
-    int8_t                     rxBuffer[MANGOH_BRIDGE_CONSOLE_RX_BUFF_SIZE]; ///< Receive data buffer
+    uint8_t                    rxBuffer[MANGOH_BRIDGE_CONSOLE_RX_BUFF_SIZE]; ///< Receive data buffer
+    mangoh_bridge_queue_t      rxQueue;                                      ///< Received data waiting for the MCU
     void*                      bridge;                                       ///< Bridge module
-    uint32_t                   rxBuffLen;                                    ///< Current bytes in Rx buffer
 } mangoh_bridge_console_t;
 
 int mangoh_bridge_console_run(mangoh_bridge_console_t*);
@@ -0,0 +1,1416 @@
+/**
+ * @file
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless, Inc. Use of this work is subject to license.
+ */
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include "legato.h"
+#include "packet.h"
+#include "worker.h"
+#include "datastore.h"
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * fdatasync() job, outlives the datastore when it is destroyed while the job runs
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_datastore_sync_job_t
+{
+    mangoh_bridge_datastore_t* datastore; ///< NULL once the datastore is destroyed
+    int                        fd;        ///< Log file duplicate, the log may be closed while the job runs
+    int32_t                    err;       ///< fdatasync() errno, set by the worker
+} mangoh_bridge_datastore_sync_job_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Compaction job, the snapshot is built on the event loop and written by the worker
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_datastore_compact_job_t
+{
+    mangoh_bridge_datastore_t* datastore;                                        ///< NULL once the datastore is destroyed
+    uint8_t*                   snapshot;                                         ///< Snapshot records
+    uint32_t                   len;                                              ///< Snapshot size
+    uint32_t                   count;                                            ///< Number of records
+    char                       dir[MANGOH_BRIDGE_DATASTORE_PATH_MAX_LEN];        ///< Files directory
+    char                       snapPath[MANGOH_BRIDGE_DATASTORE_PATH_MAX_LEN];   ///< Snapshot file
+    char                       tmpPath[MANGOH_BRIDGE_DATASTORE_PATH_MAX_LEN];    ///< Snapshot being written
+    char                       oldLogPath[MANGOH_BRIDGE_DATASTORE_PATH_MAX_LEN]; ///< Log covered by the snapshot
+    const char*                op;                                               ///< Failed call, set by the worker
+    int32_t                    err;                                              ///< Failed call errno, set by the worker
+} mangoh_bridge_datastore_compact_job_t;
+
+static uint32_t mangoh_bridge_datastore_hash(const char*);
+static int32_t mangoh_bridge_datastore_find(const mangoh_bridge_datastore_t*, const char*, uint32_t);
+static int mangoh_bridge_datastore_resize(mangoh_bridge_datastore_t*, uint32_t);
+static int mangoh_bridge_datastore_grow(mangoh_bridge_datastore_t*);
+static bool mangoh_bridge_datastore_isPinned(const mangoh_bridge_datastore_t*, const char*);
+static mangoh_bridge_datastore_entry_t* mangoh_bridge_datastore_createEntry(const mangoh_bridge_datastore_t*, const char*, const uint8_t*, uint32_t);
+static void mangoh_bridge_datastore_insert(mangoh_bridge_datastore_t*, mangoh_bridge_datastore_entry_t*);
+static void mangoh_bridge_datastore_erase(mangoh_bridge_datastore_t*, int32_t);
+static void mangoh_bridge_datastore_touch(mangoh_bridge_datastore_t*, mangoh_bridge_datastore_entry_t*);
+static uint32_t mangoh_bridge_datastore_evict(mangoh_bridge_datastore_t*, const mangoh_bridge_datastore_entry_t*, uint32_t);
+static int mangoh_bridge_datastore_reserve(const mangoh_bridge_datastore_t*, const mangoh_bridge_datastore_entry_t*, uint32_t, uint32_t*);
+static void mangoh_bridge_datastore_initRecord(mangoh_bridge_datastore_record_t*, struct iovec*, uint8_t, const char*, const uint8_t*, uint32_t);
+static ssize_t mangoh_bridge_datastore_writeRecord(int, uint8_t, const char*, const uint8_t*, uint32_t);
+static int mangoh_bridge_datastore_append(mangoh_bridge_datastore_t*, uint8_t, const char*, const uint8_t*, uint32_t);
+static int mangoh_bridge_datastore_replay(mangoh_bridge_datastore_t*, const uint8_t*, uint32_t, uint32_t*);
+static int mangoh_bridge_datastore_load(mangoh_bridge_datastore_t*, const char*, uint32_t*);
+static int mangoh_bridge_datastore_open(mangoh_bridge_datastore_t*);
+static int mangoh_bridge_datastore_rotate(mangoh_bridge_datastore_t*);
+static int mangoh_bridge_datastore_syncDir(const char*);
+static void mangoh_bridge_datastore_compactWork(void*);
+static void mangoh_bridge_datastore_compactDone(void*);
+static int mangoh_bridge_datastore_compact(mangoh_bridge_datastore_t*);
+static bool mangoh_bridge_datastore_needsCompact(const mangoh_bridge_datastore_t*);
+static void mangoh_bridge_datastore_notify(le_sls_List_t*, int32_t);
+static void mangoh_bridge_datastore_syncWork(void*);
+static void mangoh_bridge_datastore_syncDone(void*);
+static void mangoh_bridge_datastore_startSync(mangoh_bridge_datastore_t*);
+
+static uint32_t mangoh_bridge_datastore_hash(const char* key)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    while (*key)
+    {
+        hash = (hash ^ (uint8_t)*key++) * 16777619u;
+    }
+
+    return hash;
+}
+
+static int32_t mangoh_bridge_datastore_find(const mangoh_bridge_datastore_t* datastore, const char* key, uint32_t hash)
+{
+    LE_ASSERT(datastore);
+    LE_ASSERT(key);
+
+    const uint32_t mask = datastore->tableSize - 1;
+    uint32_t idx = hash & mask;
+    while (datastore->table[idx])
+    {
+        if ((datastore->table[idx]->hash == hash) && !strcmp(datastore->table[idx]->key, key))
+        {
+            return idx;
+        }
+
+        idx = (idx + 1) & mask;
+    }
+
+    return MANGOH_BRIDGE_DATASTORE_SLOT_EMPTY;
+}
+
+static int mangoh_bridge_datastore_resize(mangoh_bridge_datastore_t* datastore, uint32_t size)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(datastore);
+    LE_ASSERT(size && !(size & (size - 1)) && (size > datastore->count));
+
+    mangoh_bridge_datastore_entry_t** table = calloc(size, sizeof(mangoh_bridge_datastore_entry_t*));
+    if (!table)
+    {
+        LE_ERROR("ERROR calloc() failed");
+        res = LE_NO_MEMORY;
+        goto cleanup;
+    }
+
+    uint32_t idx = 0;
+    for (idx = 0; idx < datastore->tableSize; idx++)
+    {
+        mangoh_bridge_datastore_entry_t* entry = datastore->table[idx];
+        if (entry)
+        {
+            uint32_t slot = entry->hash & (size - 1);
+            while (table[slot])
+            {
+                slot = (slot + 1) & (size - 1);
+            }
+
+            table[slot] = entry;
+        }
+    }
+
+    LE_DEBUG("table size(%u -> %u) entries(%u)", datastore->tableSize, size, datastore->count);
+    free(datastore->table);
+    datastore->table = table;
+    datastore->tableSize = size;
+
+cleanup:
+    return res;
+}
+
+static int mangoh_bridge_datastore_grow(mangoh_bridge_datastore_t* datastore)
+{
+    LE_ASSERT(datastore);
+
+    // Keep the load under 3/4 so the probe sequences stay short
+    if ((datastore->count + 1) * 4 > datastore->tableSize * 3)
+    {
+        return mangoh_bridge_datastore_resize(datastore, datastore->tableSize * 2);
+    }
+
+    return LE_OK;
+}
+
+static bool mangoh_bridge_datastore_isPinned(const mangoh_bridge_datastore_t* datastore, const char* key)
+{
+    LE_ASSERT(datastore);
+    LE_ASSERT(key);
+
+    uint32_t idx = 0;
+    for (idx = 0; idx < datastore->numPinned; idx++)
+    {
+        if (!strncmp(key, datastore->pinnedPrefix[idx], strlen(datastore->pinnedPrefix[idx])))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static mangoh_bridge_datastore_entry_t* mangoh_bridge_datastore_createEntry(const mangoh_bridge_datastore_t* datastore, const char* key, const uint8_t* value, uint32_t len)
+{
+    LE_ASSERT(datastore);
+    LE_ASSERT(key);
+    LE_ASSERT(value || !len);
+
+    const uint32_t keyLen = strlen(key);
+    const uint32_t bytes = sizeof(mangoh_bridge_datastore_entry_t) + keyLen + sizeof(char) + len + sizeof(uint8_t);
+    mangoh_bridge_datastore_entry_t* entry = malloc(bytes);
+    if (!entry)
+    {
+        LE_ERROR("ERROR malloc() failed");
+        goto cleanup;
+    }
+
+    entry->lruLink = LE_DLS_LINK_INIT;
+    entry->key = (char*)(entry + 1);
+    memcpy(entry->key, key, keyLen + 1);
+    entry->serialized = (uint8_t*)entry->key + keyLen + 1;
+    memcpy(entry->serialized, value, len);
+    entry->serialized[len] = 0;
+    entry->serializedLen = len;
+    entry->recordLen = sizeof(mangoh_bridge_datastore_record_t) + keyLen + len + sizeof(uint8_t);
+    entry->bytes = bytes;
+    entry->hash = mangoh_bridge_datastore_hash(key);
+    entry->pinned = mangoh_bridge_datastore_isPinned(datastore, key);
+
+cleanup:
+    return entry;
+}
+
+static void mangoh_bridge_datastore_insert(mangoh_bridge_datastore_t* datastore, mangoh_bridge_datastore_entry_t* entry)
+{
+    LE_ASSERT(datastore);
+    LE_ASSERT(entry);
+
+    int32_t slot = mangoh_bridge_datastore_find(datastore, entry->key, entry->hash);
+    if (slot != MANGOH_BRIDGE_DATASTORE_SLOT_EMPTY)
+    {
+        LE_DEBUG("REPLACED('%s')", entry->key);
+        mangoh_bridge_datastore_entry_t* old = datastore->table[slot];
+        le_dls_Remove(&datastore->lru, &old->lruLink);
+        datastore->usedBytes -= old->bytes;
+        datastore->liveBytes -= old->recordLen;
+        free(old);
+    }
+    else
+    {
+        LE_DEBUG("ADDED('%s')", entry->key);
+        LE_ASSERT(datastore->count < datastore->tableSize - 1);
+
+        const uint32_t mask = datastore->tableSize - 1;
+        slot = entry->hash & mask;
+        while (datastore->table[slot])
+        {
+            slot = (slot + 1) & mask;
+        }
+
+        datastore->count++;
+    }
+
+    datastore->table[slot] = entry;
+    le_dls_Queue(&datastore->lru, &entry->lruLink);
+    datastore->usedBytes += entry->bytes;
+    datastore->liveBytes += entry->recordLen;
+}
+
+static void mangoh_bridge_datastore_erase(mangoh_bridge_datastore_t* datastore, int32_t slot)
+{
+    LE_ASSERT(datastore);
+    LE_ASSERT(datastore->table[slot]);
+
+    mangoh_bridge_datastore_entry_t* entry = datastore->table[slot];
+    le_dls_Remove(&datastore->lru, &entry->lruLink);
+    datastore->usedBytes -= entry->bytes;
+    datastore->liveBytes -= entry->recordLen;
+    datastore->count--;
+    free(entry);
+
+    // Shift the following entries back so no probe sequence crosses an empty slot, no tombstones are needed
+    const uint32_t mask = datastore->tableSize - 1;
+    uint32_t hole = slot;
+    uint32_t idx = (hole + 1) & mask;
+    datastore->table[hole] = NULL;
+    while (datastore->table[idx])
+    {
+        const uint32_t home = datastore->table[idx]->hash & mask;
+        if (((idx - home) & mask) >= ((idx - hole) & mask))
+        {
+            datastore->table[hole] = datastore->table[idx];
+            datastore->table[idx] = NULL;
+            hole = idx;
+        }
+
+        idx = (idx + 1) & mask;
+    }
+
+    if ((datastore->tableSize > MANGOH_BRIDGE_DATASTORE_TABLE_MIN_SIZE) && (datastore->count * 8 < datastore->tableSize))
+    {
+        mangoh_bridge_datastore_resize(datastore, datastore->tableSize / 2);
+    }
+}
+
+static void mangoh_bridge_datastore_touch(mangoh_bridge_datastore_t* datastore, mangoh_bridge_datastore_entry_t* entry)
+{
+    LE_ASSERT(datastore);
+    LE_ASSERT(entry);
+
+    le_dls_Remove(&datastore->lru, &entry->lruLink);
+    le_dls_Queue(&datastore->lru, &entry->lruLink);
+}
+
+static uint32_t mangoh_bridge_datastore_evict(mangoh_bridge_datastore_t* datastore, const mangoh_bridge_datastore_entry_t* replaced, uint32_t used)
+{
+    LE_ASSERT(datastore);
+
+    le_dls_Link_t* link = le_dls_Peek(&datastore->lru);
+    while (link && (used > datastore->maxBytes))
+    {
+        mangoh_bridge_datastore_entry_t* entry = CONTAINER_OF(link, mangoh_bridge_datastore_entry_t, lruLink);
+        link = le_dls_PeekNext(&datastore->lru, link);
+        if ((entry == replaced) || entry->pinned)
+        {
+            continue;
+        }
+
+        LE_INFO("evicted('%s') bytes(%u)", entry->key, entry->bytes);
+        used -= entry->bytes;
+
+        // The log forgets the key too, it would come back at the next start otherwise
+        int32_t err = mangoh_bridge_datastore_append(datastore, MANGOH_BRIDGE_DATASTORE_OP_DELETE, entry->key, NULL, 0);
+        if (err != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_datastore_append() failed(%d)", err);
+        }
+
+        mangoh_bridge_datastore_erase(datastore, mangoh_bridge_datastore_find(datastore, entry->key, entry->hash));
+    }
+
+    return used;
+}
+
+static int mangoh_bridge_datastore_reserve(const mangoh_bridge_datastore_t* datastore, const mangoh_bridge_datastore_entry_t* replaced, uint32_t bytes, uint32_t* usedBytes)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(datastore);
+    LE_ASSERT(usedBytes);
+
+    uint32_t used = datastore->usedBytes - (replaced ? replaced->bytes:0) + bytes;
+    *usedBytes = used;
+    if (used <= datastore->maxBytes)
+    {
+        goto cleanup;
+    }
+
+    // Check first so an entry that cannot fit does not evict anything
+    uint32_t evictable = 0;
+    le_dls_Link_t* link = le_dls_Peek(&datastore->lru);
+    while (link && (used - evictable > datastore->maxBytes))
+    {
+        const mangoh_bridge_datastore_entry_t* entry = CONTAINER_OF(link, mangoh_bridge_datastore_entry_t, lruLink);
+        if ((entry != replaced) && !entry->pinned)
+        {
+            evictable += entry->bytes;
+        }
+
+        link = le_dls_PeekNext(&datastore->lru, link);
+    }
+
+    if (used - evictable > datastore->maxBytes)
+    {
+        LE_WARN("WARNING datastore budget(%u) exceeded(%u), %u bytes evictable", datastore->maxBytes, used, evictable);
+        res = LE_OVERFLOW;
+        goto cleanup;
+    }
+
+cleanup:
+    return res;
+}
+
+static void mangoh_bridge_datastore_initRecord(mangoh_bridge_datastore_record_t* hdr, struct iovec* iov, uint8_t op, const char* key, const uint8_t* value, uint32_t len)
+{
+    static const uint8_t terminator = 0;
+
+    LE_ASSERT(hdr);
+    LE_ASSERT(iov);
+    LE_ASSERT(key);
+
+    memset(hdr, 0, sizeof(mangoh_bridge_datastore_record_t));
+    hdr->op = op;
+    hdr->keyLen = strlen(key);
+    hdr->valueLen = value ? len + sizeof(terminator):0;
+
+    iov[0] = (struct iovec){ .iov_base = hdr, .iov_len = sizeof(mangoh_bridge_datastore_record_t) };
+    iov[1] = (struct iovec){ .iov_base = (void*)key, .iov_len = hdr->keyLen };
+    iov[2] = (struct iovec){ .iov_base = (void*)value, .iov_len = value ? len:0 };
+    iov[3] = (struct iovec){ .iov_base = (void*)&terminator, .iov_len = value ? sizeof(terminator):0 };
+
+    uint32_t idx = 0;
+    hdr->crc = MANGOH_BRIDGE_PACKET_CRC_RESET;
+    for (idx = 0; idx < MANGOH_BRIDGE_DATASTORE_RECORD_IOV; idx++)
+    {
+        const uint8_t* data = iov[idx].iov_base;
+        uint32_t skip = (idx == 0) ? sizeof(hdr->crc):0;
+        if (iov[idx].iov_len)
+        {
+            hdr->crc = mangoh_bridge_packet_crcUpdate(hdr->crc, data + skip, iov[idx].iov_len - skip);
+        }
+    }
+}
+
+static ssize_t mangoh_bridge_datastore_writeRecord(int fd, uint8_t op, const char* key, const uint8_t* value, uint32_t len)
+{
+    mangoh_bridge_datastore_record_t hdr;
+    struct iovec iov[MANGOH_BRIDGE_DATASTORE_RECORD_IOV];
+
+    mangoh_bridge_datastore_initRecord(&hdr, iov, op, key, value, len);
+
+    uint32_t idx = 0;
+    ssize_t total = 0;
+    for (idx = 0; idx < NUM_ARRAY_MEMBERS(iov); idx++)
+    {
+        total += iov[idx].iov_len;
+    }
+
+    ssize_t written = writev(fd, iov, NUM_ARRAY_MEMBERS(iov));
+    if (written != total)
+    {
+        LE_ERROR("ERROR writev() fd(%d) failed(%zd/%zd/%d)", fd, written, total, errno);
+        return -1;
+    }
+
+    return written;
+}
+
+static int mangoh_bridge_datastore_append(mangoh_bridge_datastore_t* datastore, uint8_t op, const char* key, const uint8_t* value, uint32_t len)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(datastore);
+    LE_ASSERT(key);
+
+    if (datastore->logFd == MANGOH_BRIDGE_DATASTORE_FD_INVALID)
+    {
+        goto cleanup;
+    }
+
+    ssize_t written = mangoh_bridge_datastore_writeRecord(datastore->logFd, op, key, value, len);
+    if (written < 0)
+    {
+        // Drop a partial record, the replay would stop there and lose the records appended after it
+        if (ftruncate(datastore->logFd, datastore->logBytes) < 0)
+        {
+            LE_ERROR("ERROR ftruncate() '%s' failed(%d)", datastore->logPath, errno);
+        }
+
+        res = LE_IO_ERROR;
+        goto cleanup;
+    }
+
+    datastore->logBytes += written;
+    datastore->dirty = true;
+
+cleanup:
+    return res;
+}
+
+static int mangoh_bridge_datastore_replay(mangoh_bridge_datastore_t* datastore, const uint8_t* data, uint32_t len, uint32_t* recordLen)
+{
+    char* key = NULL;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(datastore);
+    LE_ASSERT(data);
+    LE_ASSERT(recordLen);
+
+    mangoh_bridge_datastore_record_t hdr;
+    if (len < sizeof(hdr))
+    {
+        res = LE_UNDERFLOW;
+        goto cleanup;
+    }
+
+    memcpy(&hdr, data, sizeof(hdr));
+    if (!hdr.keyLen || (hdr.keyLen > MANGOH_BRIDGE_DATASTORE_KEY_MAX_LEN) || (hdr.valueLen > MANGOH_BRIDGE_DATASTORE_VALUE_MAX_LEN))
+    {
+        res = LE_FORMAT_ERROR;
+        goto cleanup;
+    }
+
+    *recordLen = sizeof(hdr) + hdr.keyLen + hdr.valueLen;
+    if (len < *recordLen)
+    {
+        res = LE_UNDERFLOW;
+        goto cleanup;
+    }
+
+    unsigned short crc = mangoh_bridge_packet_crcUpdate(MANGOH_BRIDGE_PACKET_CRC_RESET, data + sizeof(hdr.crc), *recordLen - sizeof(hdr.crc));
+    if (crc != hdr.crc)
+    {
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    key = strndup((const char*)data + sizeof(hdr), hdr.keyLen);
+    LE_ASSERT(key);
+
+    // The CRC vouches for the value, it is parsed only when a JSON client reads it
+    const uint8_t* value = data + sizeof(hdr) + hdr.keyLen;
+    switch (hdr.op)
+    {
+    case MANGOH_BRIDGE_DATASTORE_OP_PUT:
+        if (!hdr.valueLen || value[hdr.valueLen - 1])
+        {
+            res = LE_FORMAT_ERROR;
+            goto cleanup;
+        }
+
+        // Out of memory is not a bad record, the log must not be truncated for it
+        LE_ASSERT(mangoh_bridge_datastore_grow(datastore) == LE_OK);
+        mangoh_bridge_datastore_entry_t* entry = mangoh_bridge_datastore_createEntry(datastore, key, value, hdr.valueLen - 1);
+        LE_ASSERT(entry);
+
+        mangoh_bridge_datastore_insert(datastore, entry);
+        break;
+
+    case MANGOH_BRIDGE_DATASTORE_OP_DELETE:
+    {
+        int32_t slot = mangoh_bridge_datastore_find(datastore, key, mangoh_bridge_datastore_hash(key));
+        if (slot != MANGOH_BRIDGE_DATASTORE_SLOT_EMPTY)
+        {
+            mangoh_bridge_datastore_erase(datastore, slot);
+        }
+
+        break;
+    }
+
+    default:
+        res = LE_FORMAT_ERROR;
+        break;
+    }
+
+cleanup:
+    free(key);
+    return res;
+}
+
+static int mangoh_bridge_datastore_load(mangoh_bridge_datastore_t* datastore, const char* path, uint32_t* validLen)
+{
+    const uint8_t* map = MAP_FAILED;
+    struct stat st = {0};
+    int32_t res = LE_OK;
+    int fd = -1;
+
+    LE_ASSERT(datastore);
+    LE_ASSERT(path);
+    LE_ASSERT(validLen);
+
+    *validLen = 0;
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        if (errno != ENOENT)
+        {
+            LE_ERROR("ERROR open() '%s' failed(%d)", path, errno);
+            res = LE_IO_ERROR;
+        }
+
+        goto cleanup;
+    }
+
+    if (fstat(fd, &st) < 0)
+    {
+        LE_ERROR("ERROR fstat() '%s' failed(%d)", path, errno);
+        res = LE_IO_ERROR;
+        goto cleanup;
+    }
+
+    if (!st.st_size)
+    {
+        goto cleanup;
+    }
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        LE_ERROR("ERROR mmap() '%s' failed(%d)", path, errno);
+        res = LE_IO_ERROR;
+        goto cleanup;
+    }
+
+    uint32_t count = 0;
+    while (*validLen < st.st_size)
+    {
+        uint32_t recordLen = 0;
+        int32_t err = mangoh_bridge_datastore_replay(datastore, map + *validLen, st.st_size - *validLen, &recordLen);
+        if (err != LE_OK)
+        {
+            LE_WARN("WARNING '%s' invalid record(%d) at offset(%u), %u bytes ignored", path, err, *validLen, (uint32_t)st.st_size - *validLen);
+            break;
+        }
+
+        *validLen += recordLen;
+        count++;
+    }
+
+    LE_INFO("'%s' replayed %u records", path, count);
+
+cleanup:
+    if (map != MAP_FAILED) munmap((void*)map, st.st_size);
+    if (fd >= 0) close(fd);
+    return res;
+}
+
+static int mangoh_bridge_datastore_open(mangoh_bridge_datastore_t* datastore)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(datastore);
+
+    if ((mkdir(datastore->dir, S_IRWXU) < 0) && (errno != EEXIST))
+    {
+        LE_ERROR("ERROR mkdir() '%s' failed(%d)", datastore->dir, errno);
+        res = LE_IO_ERROR;
+        goto cleanup;
+    }
+
+    uint32_t snapBytes = 0;
+    res = mangoh_bridge_datastore_load(datastore, datastore->snapPath, &snapBytes);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_datastore_load() failed(%d)", res);
+        goto cleanup;
+    }
+
+    // Left by a compaction that did not finish, the snapshot may or may not cover it yet
+    uint32_t oldBytes = 0;
+    res = mangoh_bridge_datastore_load(datastore, datastore->oldLogPath, &oldBytes);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_datastore_load() failed(%d)", res);
+        goto cleanup;
+    }
+
+    datastore->oldLog = !access(datastore->oldLogPath, F_OK);
+
+    res = mangoh_bridge_datastore_load(datastore, datastore->logPath, &datastore->logBytes);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_datastore_load() failed(%d)", res);
+        goto cleanup;
+    }
+
+    datastore->logFd = open(datastore->logPath, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (datastore->logFd < 0)
+    {
+        LE_ERROR("ERROR open() '%s' failed(%d)", datastore->logPath, errno);
+        datastore->logFd = MANGOH_BRIDGE_DATASTORE_FD_INVALID;
+        res = LE_IO_ERROR;
+        goto cleanup;
+    }
+
+    // Appends go after the last valid record
+    if (ftruncate(datastore->logFd, datastore->logBytes) < 0)
+    {
+        LE_ERROR("ERROR ftruncate() '%s' failed(%d)", datastore->logPath, errno);
+        res = LE_IO_ERROR;
+        goto cleanup;
+    }
+
+    LE_DEBUG("'%s' snapshot(%u) old log(%u) log(%u)", datastore->dir, snapBytes, oldBytes, datastore->logBytes);
+
+cleanup:
+    if ((res != LE_OK) && (datastore->logFd != MANGOH_BRIDGE_DATASTORE_FD_INVALID))
+    {
+        close(datastore->logFd);
+        datastore->logFd = MANGOH_BRIDGE_DATASTORE_FD_INVALID;
+    }
+
+    return res;
+}
+
+static int mangoh_bridge_datastore_rotate(mangoh_bridge_datastore_t* datastore)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(datastore);
+    LE_ASSERT(!datastore->oldLog);
+
+    // Only a rename on the event loop, the snapshot that covers the old log is written by the worker
+    if (rename(datastore->logPath, datastore->oldLogPath) < 0)
+    {
+        LE_ERROR("ERROR rename() '%s' failed(%d)", datastore->logPath, errno);
+        res = LE_IO_ERROR;
+        goto cleanup;
+    }
+
+    int fd = open(datastore->logPath, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+    {
+        LE_ERROR("ERROR open() '%s' failed(%d)", datastore->logPath, errno);
+        res = LE_IO_ERROR;
+
+        // The appends go on in the old log, it must not be removed by a compaction
+        if (rename(datastore->oldLogPath, datastore->logPath) < 0)
+        {
+            LE_ERROR("ERROR rename() '%s' failed(%d), datastore kept in memory only", datastore->oldLogPath, errno);
+            close(datastore->logFd);
+            datastore->logFd = MANGOH_BRIDGE_DATASTORE_FD_INVALID;
+        }
+
+        goto cleanup;
+    }
+
+    LE_DEBUG("'%s' rotated log(%u)", datastore->logPath, datastore->logBytes);
+    close(datastore->logFd);
+    datastore->logFd = fd;
+    datastore->logBytes = 0;
+    datastore->oldLog = true;
+
+cleanup:
+    return res;
+}
+
+static int mangoh_bridge_datastore_syncDir(const char* dir)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(dir);
+
+    int fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if ((fd < 0) || (fsync(fd) < 0))
+    {
+        res = LE_IO_ERROR;
+    }
+
+    if (fd >= 0) close(fd);
+    return res;
+}
+
+static void mangoh_bridge_datastore_compactWork(void* param)
+{
+    mangoh_bridge_datastore_compact_job_t* job = (mangoh_bridge_datastore_compact_job_t*)param;
+    int fd = -1;
+
+    LE_ASSERT(job);
+
+    // The rotation must be on disk before the new log is committed by an fdatasync()
+    if (mangoh_bridge_datastore_syncDir(job->dir) != LE_OK)
+    {
+        job->op = "fsync";
+        goto cleanup;
+    }
+
+    fd = open(job->tmpPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+    {
+        job->op = "open";
+        goto cleanup;
+    }
+
+    uint32_t written = 0;
+    while (written < job->len)
+    {
+        ssize_t len = write(fd, job->snapshot + written, job->len - written);
+        if (len < 0)
+        {
+            job->op = "write";
+            goto cleanup;
+        }
+
+        written += len;
+    }
+
+    // The snapshot must be on disk before it replaces the old one, and replaced before the old log is removed
+    if (fsync(fd) < 0)
+    {
+        job->op = "fsync";
+        goto cleanup;
+    }
+
+    if (rename(job->tmpPath, job->snapPath) < 0)
+    {
+        job->op = "rename";
+        goto cleanup;
+    }
+
+    if (mangoh_bridge_datastore_syncDir(job->dir) != LE_OK)
+    {
+        job->op = "fsync";
+        goto cleanup;
+    }
+
+    if ((unlink(job->oldLogPath) < 0) && (errno != ENOENT))
+    {
+        job->op = "unlink";
+        goto cleanup;
+    }
+
+cleanup:
+    job->err = job->op ? errno:0;
+    if (fd >= 0) close(fd);
+}
+
+static void mangoh_bridge_datastore_compactDone(void* param)
+{
+    mangoh_bridge_datastore_compact_job_t* job = (mangoh_bridge_datastore_compact_job_t*)param;
+
+    LE_ASSERT(job);
+
+    mangoh_bridge_datastore_t* datastore = job->datastore;
+    if (!datastore)
+    {
+        LE_DEBUG("datastore destroyed, compaction(%s/%d) dropped", job->op ? job->op:"", job->err);
+        goto cleanup;
+    }
+
+    datastore->compactJob = NULL;
+    if (job->op)
+    {
+        // The old log is still replayed, the next compaction writes a snapshot covering it without rotating again
+        LE_ERROR("ERROR %s() '%s' failed(%d)", job->op, job->snapPath, job->err);
+        goto cleanup;
+    }
+
+    LE_INFO("'%s' compacted to %u entries(%u)", job->snapPath, job->count, job->len);
+    datastore->oldLog = false;
+
+cleanup:
+    free(job->snapshot);
+    free(job);
+}
+
+static int mangoh_bridge_datastore_compact(mangoh_bridge_datastore_t* datastore)
+{
+    mangoh_bridge_datastore_compact_job_t* job = NULL;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(datastore);
+    LE_ASSERT(!datastore->compactJob);
+
+    job = calloc(1, sizeof(mangoh_bridge_datastore_compact_job_t));
+    if (!job || !(job->snapshot = malloc(datastore->liveBytes ? datastore->liveBytes:1)))
+    {
+        LE_ERROR("ERROR malloc() failed");
+        res = LE_NO_MEMORY;
+        goto cleanup;
+    }
+
+    // Written least recently used first, the replay restores the eviction order
+    le_dls_Link_t* link = le_dls_Peek(&datastore->lru);
+    for (; link; link = le_dls_PeekNext(&datastore->lru, link))
+    {
+        const mangoh_bridge_datastore_entry_t* entry = CONTAINER_OF(link, mangoh_bridge_datastore_entry_t, lruLink);
+        mangoh_bridge_datastore_record_t hdr;
+        struct iovec iov[MANGOH_BRIDGE_DATASTORE_RECORD_IOV];
+
+        mangoh_bridge_datastore_initRecord(&hdr, iov, MANGOH_BRIDGE_DATASTORE_OP_PUT, entry->key, entry->serialized, entry->serializedLen);
+
+        uint32_t idx = 0;
+        for (idx = 0; idx < NUM_ARRAY_MEMBERS(iov); idx++)
+        {
+            LE_ASSERT(job->len + iov[idx].iov_len <= datastore->liveBytes);
+            memcpy(job->snapshot + job->len, iov[idx].iov_base, iov[idx].iov_len);
+            job->len += iov[idx].iov_len;
+        }
+
+        job->count++;
+    }
+
+    // Appends after this point go to a new log, a previous old log is kept when the last compaction failed
+    if (!datastore->oldLog)
+    {
+        res = mangoh_bridge_datastore_rotate(datastore);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_datastore_rotate() failed(%d)", res);
+            goto cleanup;
+        }
+    }
+
+    job->datastore = datastore;
+    memcpy(job->dir, datastore->dir, sizeof(job->dir));
+    memcpy(job->snapPath, datastore->snapPath, sizeof(job->snapPath));
+    memcpy(job->tmpPath, datastore->tmpPath, sizeof(job->tmpPath));
+    memcpy(job->oldLogPath, datastore->oldLogPath, sizeof(job->oldLogPath));
+
+    res = mangoh_bridge_worker_submit(datastore, mangoh_bridge_datastore_compactWork, mangoh_bridge_datastore_compactDone, job);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_worker_submit() failed(%d)", res);
+        goto cleanup;
+    }
+
+    datastore->compactJob = job;
+    job = NULL;
+
+cleanup:
+    if (job)
+    {
+        free(job->snapshot);
+        free(job);
+    }
+
+    return res;
+}
+
+static bool mangoh_bridge_datastore_needsCompact(const mangoh_bridge_datastore_t* datastore)
+{
+    LE_ASSERT(datastore);
+
+    if (!mangoh_bridge_datastore_isPersistent(datastore) || datastore->compactJob)
+    {
+        return false;
+    }
+
+    return datastore->oldLog ||
+           ((datastore->logBytes > MANGOH_BRIDGE_DATASTORE_COMPACT_MIN_BYTES) && (datastore->logBytes > datastore->liveBytes));
+}
+
+static void mangoh_bridge_datastore_notify(le_sls_List_t* list, int32_t result)
+{
+    LE_ASSERT(list);
+
+    le_sls_Link_t* link = le_sls_Pop(list);
+    while (link)
+    {
+        mangoh_bridge_datastore_waiter_t* waiter = CONTAINER_OF(link, mangoh_bridge_datastore_waiter_t, link);
+        waiter->func(waiter->context, result);
+        link = le_sls_Pop(list);
+    }
+}
+
+static void mangoh_bridge_datastore_syncWork(void* param)
+{
+    mangoh_bridge_datastore_sync_job_t* job = (mangoh_bridge_datastore_sync_job_t*)param;
+
+    LE_ASSERT(job);
+
+    job->err = (fdatasync(job->fd) < 0) ? errno:0;
+}
+
+static void mangoh_bridge_datastore_syncDone(void* param)
+{
+    mangoh_bridge_datastore_sync_job_t* job = (mangoh_bridge_datastore_sync_job_t*)param;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(job);
+
+    if (job->fd >= 0) close(job->fd);
+
+    mangoh_bridge_datastore_t* datastore = job->datastore;
+    if (!datastore)
+    {
+        LE_DEBUG("datastore destroyed, fdatasync() result(%d) dropped", job->err);
+        goto cleanup;
+    }
+
+    if (job->err)
+    {
+        LE_ERROR("ERROR fdatasync() '%s' failed(%d)", datastore->logPath, job->err);
+        res = LE_IO_ERROR;
+    }
+
+    datastore->syncJob = NULL;
+    mangoh_bridge_datastore_notify(&datastore->syncWaiters, res);
+
+    if (datastore->dirty || !le_sls_IsEmpty(&datastore->waiters))
+    {
+        mangoh_bridge_datastore_startSync(datastore);
+    }
+    else if (mangoh_bridge_datastore_needsCompact(datastore))
+    {
+        res = mangoh_bridge_datastore_compact(datastore);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_datastore_compact() failed(%d)", res);
+        }
+    }
+
+cleanup:
+    free(job);
+}
+
+static void mangoh_bridge_datastore_startSync(mangoh_bridge_datastore_t* datastore)
+{
+    LE_ASSERT(datastore);
+    LE_ASSERT(!datastore->syncJob);
+
+    // Everything appended so far is covered by this fdatasync()
+    le_sls_Link_t* link = le_sls_Pop(&datastore->waiters);
+    while (link)
+    {
+        le_sls_Queue(&datastore->syncWaiters, link);
+        link = le_sls_Pop(&datastore->waiters);
+    }
+
+    datastore->dirty = false;
+
+    mangoh_bridge_datastore_sync_job_t* job = calloc(1, sizeof(mangoh_bridge_datastore_sync_job_t));
+    if (!job)
+    {
+        LE_ERROR("ERROR calloc() failed");
+        mangoh_bridge_datastore_notify(&datastore->syncWaiters, LE_NO_MEMORY);
+        goto cleanup;
+    }
+
+    job->datastore = datastore;
+    job->fd = dup(datastore->logFd);
+    datastore->syncJob = job;
+    if (job->fd < 0)
+    {
+        job->err = errno;
+        LE_ERROR("ERROR dup() '%s' failed(%d)", datastore->logPath, job->err);
+        mangoh_bridge_datastore_syncDone(job);
+        goto cleanup;
+    }
+
+    int32_t res = mangoh_bridge_worker_submit(datastore, mangoh_bridge_datastore_syncWork, mangoh_bridge_datastore_syncDone, job);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_worker_submit() failed(%d)", res);
+        job->err = EIO;
+        mangoh_bridge_datastore_syncDone(job);
+    }
+
+cleanup:
+    return;
+}
+
+bool mangoh_bridge_datastore_isPersistent(const mangoh_bridge_datastore_t* datastore)
+{
+    LE_ASSERT(datastore);
+    return (datastore->logFd != MANGOH_BRIDGE_DATASTORE_FD_INVALID);
+}
+
+int mangoh_bridge_datastore_get(mangoh_bridge_datastore_t* datastore, const char* key, mangoh_bridge_json_data_t** value)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(datastore);
+    LE_ASSERT(key);
+    LE_ASSERT(value);
+
+    int32_t slot = mangoh_bridge_datastore_find(datastore, key, mangoh_bridge_datastore_hash(key));
+    if (slot == MANGOH_BRIDGE_DATASTORE_SLOT_EMPTY)
+    {
+        res = LE_NOT_FOUND;
+        goto cleanup;
+    }
+
+    mangoh_bridge_datastore_entry_t* entry = datastore->table[slot];
+    mangoh_bridge_datastore_touch(datastore, entry);
+
+    res = mangoh_bridge_json_readValue((const char*)entry->serialized, value);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_json_readValue() failed(%d)", res);
+        goto cleanup;
+    }
+
+cleanup:
+    return res;
+}
+
+int mangoh_bridge_datastore_getSerialized(mangoh_bridge_datastore_t* datastore, const char* key, const uint8_t** data, uint32_t* len)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(datastore);
+    LE_ASSERT(key);
+    LE_ASSERT(data);
+    LE_ASSERT(len);
+
+    int32_t slot = mangoh_bridge_datastore_find(datastore, key, mangoh_bridge_datastore_hash(key));
+    if (slot == MANGOH_BRIDGE_DATASTORE_SLOT_EMPTY)
+    {
+        res = LE_NOT_FOUND;
+        goto cleanup;
+    }
+
+    mangoh_bridge_datastore_entry_t* entry = datastore->table[slot];
+    mangoh_bridge_datastore_touch(datastore, entry);
+
+    *data = entry->serialized;
+    *len = entry->serializedLen;
+
+cleanup:
+    return res;
+}
+
+int mangoh_bridge_datastore_put(mangoh_bridge_datastore_t* datastore, const char* key, mangoh_bridge_json_data_t* value)
+{
+    mangoh_bridge_datastore_entry_t* entry = NULL;
+    uint8_t* buff = NULL;
+    uint32_t len = 0;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(datastore);
+    LE_ASSERT(key);
+    LE_ASSERT(value);
+
+    const uint32_t keyLen = strlen(key);
+    if (!keyLen || (keyLen > MANGOH_BRIDGE_DATASTORE_KEY_MAX_LEN))
+    {
+        LE_ERROR("ERROR key length(%u) invalid", keyLen);
+        res = LE_BAD_PARAMETER;
+        goto cleanup;
+    }
+
+    res = mangoh_bridge_json_write(value, &buff, &len);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_json_write() failed(%d)", res);
+        goto cleanup;
+    }
+
+    if (len >= MANGOH_BRIDGE_DATASTORE_VALUE_MAX_LEN)
+    {
+        LE_ERROR("ERROR value('%s') length(%u) too long", key, len);
+        res = LE_OVERFLOW;
+        goto cleanup;
+    }
+
+    entry = mangoh_bridge_datastore_createEntry(datastore, key, buff, len);
+    if (!entry)
+    {
+        res = LE_NO_MEMORY;
+        goto cleanup;
+    }
+
+    int32_t slot = mangoh_bridge_datastore_find(datastore, key, entry->hash);
+    const mangoh_bridge_datastore_entry_t* replaced = (slot != MANGOH_BRIDGE_DATASTORE_SLOT_EMPTY) ? datastore->table[slot]:NULL;
+    uint32_t used = 0;
+    res = mangoh_bridge_datastore_reserve(datastore, replaced, entry->bytes, &used);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR value('%s') bytes(%u) over budget(%u)", key, entry->bytes, datastore->maxBytes);
+        goto cleanup;
+    }
+
+    if (!replaced)
+    {
+        res = mangoh_bridge_datastore_grow(datastore);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_datastore_grow() failed(%d)", res);
+            goto cleanup;
+        }
+    }
+
+    res = mangoh_bridge_datastore_append(datastore, MANGOH_BRIDGE_DATASTORE_OP_PUT, key, buff, len);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_datastore_append() failed(%d)", res);
+        goto cleanup;
+    }
+
+    // Evict only once the value is in the log, a failed put leaves every other key in place
+    mangoh_bridge_datastore_evict(datastore, replaced, used);
+    mangoh_bridge_datastore_insert(datastore, entry);
+    entry = NULL;
+
+cleanup:
+    mangoh_bridge_json_destroy(&value);
+    free(entry);
+    free(buff);
+    return res;
+}
+
+int mangoh_bridge_datastore_remove(mangoh_bridge_datastore_t* datastore, const char* key, mangoh_bridge_json_data_t** value)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(datastore);
+    LE_ASSERT(key);
+
+    int32_t slot = mangoh_bridge_datastore_find(datastore, key, mangoh_bridge_datastore_hash(key));
+    if (slot == MANGOH_BRIDGE_DATASTORE_SLOT_EMPTY)
+    {
+        res = LE_NOT_FOUND;
+        goto cleanup;
+    }
+
+    if (value)
+    {
+        res = mangoh_bridge_json_readValue((const char*)datastore->table[slot]->serialized, value);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_json_readValue() failed(%d)", res);
+            goto cleanup;
+        }
+    }
+
+    res = mangoh_bridge_datastore_append(datastore, MANGOH_BRIDGE_DATASTORE_OP_DELETE, key, NULL, 0);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_datastore_append() failed(%d)", res);
+        if (value) mangoh_bridge_json_destroy(value);
+        goto cleanup;
+    }
+
+    mangoh_bridge_datastore_erase(datastore, slot);
+
+cleanup:
+    return res;
+}
+
+int mangoh_bridge_datastore_forEach(const mangoh_bridge_datastore_t* datastore, mangoh_bridge_datastore_iter_func_t func, void* context)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(datastore);
+    LE_ASSERT(func);
+
+    le_dls_Link_t* link = le_dls_Peek(&datastore->lru);
+    for (; link; link = le_dls_PeekNext(&datastore->lru, link))
+    {
+        const mangoh_bridge_datastore_entry_t* entry = CONTAINER_OF(link, mangoh_bridge_datastore_entry_t, lruLink);
+        res = func(entry->key, entry->serialized, entry->serializedLen, context);
+        if (res != LE_OK)
+        {
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    return res;
+}
+
+int mangoh_bridge_datastore_sync(mangoh_bridge_datastore_t* datastore, mangoh_bridge_datastore_waiter_t* waiter)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(datastore);
+
+    if (datastore->logFd == MANGOH_BRIDGE_DATASTORE_FD_INVALID)
+    {
+        res = LE_UNSUPPORTED;
+        goto cleanup;
+    }
+
+    if (waiter)
+    {
+        LE_ASSERT(waiter->func);
+        waiter->link = LE_SLS_LINK_INIT;
+        le_sls_Queue(&datastore->waiters, &waiter->link);
+    }
+
+    // A running fdatasync() may miss the latest appends, the waiters are committed by the next one
+    if (!datastore->syncJob)
+    {
+        mangoh_bridge_datastore_startSync(datastore);
+    }
+
+cleanup:
+    return res;
+}
+
+int mangoh_bridge_datastore_init(mangoh_bridge_datastore_t* datastore, const char* name)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(datastore);
+    LE_ASSERT(name);
+
+    memset(datastore, 0, sizeof(mangoh_bridge_datastore_t));
+    datastore->logFd = MANGOH_BRIDGE_DATASTORE_FD_INVALID;
+    datastore->waiters = LE_SLS_LIST_INIT;
+    datastore->syncWaiters = LE_SLS_LIST_INIT;
+    datastore->lru = LE_DLS_LIST_INIT;
+    datastore->maxBytes = MANGOH_BRIDGE_DATASTORE_MAX_BYTES_DEFAULT;
+
+    res = mangoh_bridge_datastore_resize(datastore, MANGOH_BRIDGE_DATASTORE_TABLE_MIN_SIZE);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_datastore_resize() failed(%d)", res);
+        goto cleanup;
+    }
+
+    const char* maxBytes = getenv(MANGOH_BRIDGE_DATASTORE_MAX_BYTES_ENV);
+    if (maxBytes)
+    {
+        char* end = NULL;
+        unsigned long val = strtoul(maxBytes, &end, 0);
+        if (*end || !val || (val > MANGOH_BRIDGE_DATASTORE_MAX_BYTES_LIMIT))
+        {
+            LE_WARN("WARNING %s('%s') invalid, using %u", MANGOH_BRIDGE_DATASTORE_MAX_BYTES_ENV, maxBytes, datastore->maxBytes);
+        }
+        else
+        {
+            datastore->maxBytes = val;
+        }
+    }
+
+    const char* pinned = getenv(MANGOH_BRIDGE_DATASTORE_PINNED_ENV);
+    if (pinned && *pinned)
+    {
+        datastore->pinned = strdup(pinned);
+        LE_ASSERT(datastore->pinned);
+
+        char* save = NULL;
+        char* prefix = strtok_r(datastore->pinned, MANGOH_BRIDGE_DATASTORE_PINNED_SEPARATOR, &save);
+        while (prefix)
+        {
+            if (datastore->numPinned >= MANGOH_BRIDGE_DATASTORE_PINNED_MAX)
+            {
+                LE_WARN("WARNING %s too many prefixes, '%s' and after ignored", MANGOH_BRIDGE_DATASTORE_PINNED_ENV, prefix);
+                break;
+            }
+
+            LE_DEBUG("pinned prefix('%s')", prefix);
+            datastore->pinnedPrefix[datastore->numPinned++] = prefix;
+            prefix = strtok_r(NULL, MANGOH_BRIDGE_DATASTORE_PINNED_SEPARATOR, &save);
+        }
+    }
+
+    const char* dir = getenv(MANGOH_BRIDGE_DATASTORE_DIR_ENV);
+    dir = dir ? dir:MANGOH_BRIDGE_DATASTORE_DIR_DEFAULT;
+    if (!*dir)
+    {
+        LE_INFO("datastore kept in memory only");
+        goto cleanup;
+    }
+
+    // A truncated path would name another file
+    int len[] =
+    {
+        snprintf(datastore->dir, sizeof(datastore->dir), "%s", dir),
+        snprintf(datastore->logPath, sizeof(datastore->logPath), "%s/%s%s", dir, name, MANGOH_BRIDGE_DATASTORE_LOG_SUFFIX),
+        snprintf(datastore->snapPath, sizeof(datastore->snapPath), "%s/%s%s", dir, name, MANGOH_BRIDGE_DATASTORE_SNAPSHOT_SUFFIX),
+        snprintf(datastore->tmpPath, sizeof(datastore->tmpPath), "%s/%s%s%s", dir, name, MANGOH_BRIDGE_DATASTORE_SNAPSHOT_SUFFIX, MANGOH_BRIDGE_DATASTORE_TEMP_SUFFIX),
+        snprintf(datastore->oldLogPath, sizeof(datastore->oldLogPath), "%s/%s%s%s", dir, name, MANGOH_BRIDGE_DATASTORE_LOG_SUFFIX, MANGOH_BRIDGE_DATASTORE_OLD_SUFFIX),
+    };
+
+    uint32_t idx = 0;
+    for (idx = 0; idx < NUM_ARRAY_MEMBERS(len); idx++)
+    {
+        if ((len[idx] < 0) || (len[idx] >= MANGOH_BRIDGE_DATASTORE_PATH_MAX_LEN))
+        {
+            LE_ERROR("ERROR datastore '%s' path in '%s' too long(%d)", name, dir, len[idx]);
+            res = LE_OVERFLOW;
+            goto cleanup;
+        }
+    }
+
+    res = mangoh_bridge_datastore_open(datastore);
+    if (res != LE_OK)
+    {
+        // The bridge is still usable without the files, the data is lost at the next start
+        LE_ERROR("ERROR mangoh_bridge_datastore_open() failed(%d), datastore '%s' kept in memory only", res, name);
+        datastore->logBytes = 0;
+        res = LE_OK;
+    }
+
+    LE_INFO("datastore '%s' loaded entries(%u) bytes(%u) log(%u)", name, datastore->count, datastore->usedBytes, datastore->logBytes);
+
+    // The budget may have been lowered since the entries were stored
+    if (mangoh_bridge_datastore_evict(datastore, NULL, datastore->usedBytes) > datastore->maxBytes)
+    {
+        LE_WARN("WARNING datastore '%s' pinned entries over budget(%u)", name, datastore->maxBytes);
+    }
+
+    // The log is kept as it is when the compaction fails, it is retried after the next fdatasync()
+    if (mangoh_bridge_datastore_needsCompact(datastore))
+    {
+        int32_t err = mangoh_bridge_datastore_compact(datastore);
+        if (err != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_datastore_compact() failed(%d)", err);
+        }
+    }
+
+cleanup:
+    if (res != LE_OK)
+    {
+        mangoh_bridge_datastore_destroy(datastore);
+    }
+
+    return res;
+}
+
+int mangoh_bridge_datastore_destroy(mangoh_bridge_datastore_t* datastore)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(datastore);
+
+    // A running fdatasync() completes on its own descriptor without the datastore
+    if (datastore->syncJob)
+    {
+        datastore->syncJob->datastore = NULL;
+        datastore->syncJob = NULL;
+    }
+
+    if (datastore->compactJob)
+    {
+        datastore->compactJob->datastore = NULL;
+        datastore->compactJob = NULL;
+    }
+
+    if (datastore->logFd != MANGOH_BRIDGE_DATASTORE_FD_INVALID)
+    {
+        if (fdatasync(datastore->logFd) < 0)
+        {
+            LE_ERROR("ERROR fdatasync() '%s' failed(%d)", datastore->logPath, errno);
+            res = LE_IO_ERROR;
+        }
+
+        close(datastore->logFd);
+        datastore->logFd = MANGOH_BRIDGE_DATASTORE_FD_INVALID;
+    }
+
+    // The last fdatasync() covers every append, the waiters get its result instead of being left pending
+    mangoh_bridge_datastore_notify(&datastore->syncWaiters, res);
+    mangoh_bridge_datastore_notify(&datastore->waiters, res);
+    datastore->dirty = false;
+
+    le_dls_Link_t* link = le_dls_Pop(&datastore->lru);
+    while (link)
+    {
+        free(CONTAINER_OF(link, mangoh_bridge_datastore_entry_t, lruLink));
+        link = le_dls_Pop(&datastore->lru);
+    }
+
+    free(datastore->table);
+    datastore->table = NULL;
+    datastore->tableSize = 0;
+    datastore->count = 0;
+    datastore->usedBytes = 0;
+    datastore->liveBytes = 0;
+
+    free(datastore->pinned);
+    datastore->pinned = NULL;
+    datastore->numPinned = 0;
+
+    return res;
+}
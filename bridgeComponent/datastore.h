@@ -0,0 +1,146 @@
+/*
+ * @file mangoh_bridge_datastore.h
+ *
+ * Arduino bridge mailbox datastore module.
+ *
+ * The key/value store behind the mailbox datastore commands and the JSON put/get/delete requests.  An entry holds its
+ * key and its value in the serialized form written to the log, in one allocation, an MCU read is a copy and a JSON
+ * client read parses the value again.  Entries are kept in an open addressing table grown and shrunk with the number of
+ * keys.  The memory used by the entries is capped by BRIDGE_DATASTORE_MAX_BYTES, a put that does not fit evicts the
+ * least recently read or written keys, except the keys starting with one of the comma separated BRIDGE_DATASTORE_PINNED
+ * prefixes, and is refused when evicting is not enough.  An evicted key is deleted from the log too.  Every put and
+ * delete is appended to a log file, the log is replayed over a snapshot file when the bridge starts so an application
+ * restart does not lose the data the MCU uploaded.  Both files are mapped with mmap(), a log record cut short by a crash
+ * or with a bad CRC ends the replay and is truncated away.  Once the log is larger than the data it holds it is
+ * compacted: the log is renamed aside and a new one started, the entries are written on the worker pool to a new
+ * snapshot renamed over the old one, and the old log is removed once the snapshot is on disk.  Until then the old log is
+ * replayed between the snapshot and the log, replaying it again over the new snapshot changes nothing.  Appends reach
+ * the page cache at once, fdatasync() runs on the worker pool and commits every change waiting for it as a group,
+ * changes made meanwhile wait for the next one.  The files are kept in BRIDGE_DATASTORE_DIR, an empty value keeps the
+ * store in memory only, as does a directory or a file that cannot be read or opened when the bridge starts.
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+#include "legato.h"
+#include "json.h"
+
+#ifndef MANGOH_BRIDGE_DATASTORE_INCLUDE_GUARD
+#define MANGOH_BRIDGE_DATASTORE_INCLUDE_GUARD
+
+#define MANGOH_BRIDGE_DATASTORE_DIR_ENV           "BRIDGE_DATASTORE_DIR"
+#define MANGOH_BRIDGE_DATASTORE_DIR_DEFAULT       "/datastore"
+#define MANGOH_BRIDGE_DATASTORE_LOG_SUFFIX        ".log"
+#define MANGOH_BRIDGE_DATASTORE_SNAPSHOT_SUFFIX   ".snapshot"
+#define MANGOH_BRIDGE_DATASTORE_TEMP_SUFFIX       ".tmp"
+#define MANGOH_BRIDGE_DATASTORE_OLD_SUFFIX        ".old"
+#define MANGOH_BRIDGE_DATASTORE_PATH_MAX_LEN      256
+#define MANGOH_BRIDGE_DATASTORE_MAX_BYTES_ENV     "BRIDGE_DATASTORE_MAX_BYTES"
+#define MANGOH_BRIDGE_DATASTORE_MAX_BYTES_DEFAULT 0x40000
+#define MANGOH_BRIDGE_DATASTORE_MAX_BYTES_LIMIT   0x4000000
+#define MANGOH_BRIDGE_DATASTORE_PINNED_ENV        "BRIDGE_DATASTORE_PINNED"
+#define MANGOH_BRIDGE_DATASTORE_PINNED_SEPARATOR  ","
+#define MANGOH_BRIDGE_DATASTORE_PINNED_MAX        8
+#define MANGOH_BRIDGE_DATASTORE_TABLE_MIN_SIZE    16
+#define MANGOH_BRIDGE_DATASTORE_SLOT_EMPTY        -1
+#define MANGOH_BRIDGE_DATASTORE_KEY_MAX_LEN       1024
+#define MANGOH_BRIDGE_DATASTORE_VALUE_MAX_LEN     0x100000
+#define MANGOH_BRIDGE_DATASTORE_COMPACT_MIN_BYTES 0x10000
+#define MANGOH_BRIDGE_DATASTORE_FD_INVALID        -1
+#define MANGOH_BRIDGE_DATASTORE_RECORD_IOV        4
+
+#define MANGOH_BRIDGE_DATASTORE_OP_PUT            1
+#define MANGOH_BRIDGE_DATASTORE_OP_DELETE         2
+
+typedef void (*mangoh_bridge_datastore_sync_func_t)(void*, int32_t);
+typedef int (*mangoh_bridge_datastore_iter_func_t)(const char*, const uint8_t*, uint32_t, void*);
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Log and snapshot record header, followed by the key and the serialized value with its terminator
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_datastore_record_t
+{
+    uint16_t crc;      ///< CRC of the rest of the header, the key and the value
+    uint8_t  op;       ///< PUT or DELETE
+    uint8_t  reserved;
+    uint32_t keyLen;   ///< Key length without terminator
+    uint32_t valueLen; ///< Value length with terminator, 0 for a delete
+} __attribute__((packed)) mangoh_bridge_datastore_record_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Datastore entry
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_datastore_entry_t
+{
+    le_dls_Link_t lruLink;       ///< Recently used list link
+    char*         key;           ///< Key, follows the entry
+    uint8_t*      serialized;    ///< Serialized value with terminator, follows the key
+    uint32_t      serializedLen; ///< Serialized value length without terminator
+    uint32_t      recordLen;     ///< Size of the entry as a PUT record
+    uint32_t      bytes;         ///< Size of the allocation
+    uint32_t      hash;          ///< Key hash
+    bool          pinned;        ///< Never evicted
+} mangoh_bridge_datastore_entry_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Commit waiter, owned by the caller until its function is called
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_datastore_waiter_t
+{
+    mangoh_bridge_datastore_sync_func_t func;    ///< Called with the fdatasync() result
+    void*                               context; ///< Owner data
+    le_sls_Link_t                       link;    ///< Waiting list link
+} mangoh_bridge_datastore_waiter_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Datastore
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_datastore_t
+{
+    mangoh_bridge_datastore_entry_t**              table;                                            ///< Entries by key hash, linear probing
+    uint32_t                                       tableSize;                                        ///< Number of slots, a power of 2
+    uint32_t                                       count;                                            ///< Number of entries
+    le_dls_List_t                                  lru;                                              ///< Entries, least recently used first
+    uint32_t                                       usedBytes;                                        ///< Memory used by the entries
+    uint32_t                                       maxBytes;                                         ///< Memory budget
+    char*                                          pinned;                                           ///< Pinned key prefixes storage
+    const char*                                    pinnedPrefix[MANGOH_BRIDGE_DATASTORE_PINNED_MAX]; ///< Pinned key prefixes
+    uint32_t                                       numPinned;                                        ///< Number of pinned key prefixes
+    le_sls_List_t                                  waiters;                                          ///< Waiting for the next fdatasync()
+    le_sls_List_t                                  syncWaiters;                                      ///< Waiting for the running fdatasync()
+    char                                           dir[MANGOH_BRIDGE_DATASTORE_PATH_MAX_LEN];        ///< Files directory
+    char                                           logPath[MANGOH_BRIDGE_DATASTORE_PATH_MAX_LEN];    ///< Log file
+    char                                           snapPath[MANGOH_BRIDGE_DATASTORE_PATH_MAX_LEN];   ///< Snapshot file
+    char                                           tmpPath[MANGOH_BRIDGE_DATASTORE_PATH_MAX_LEN];    ///< Snapshot being written
+    char                                           oldLogPath[MANGOH_BRIDGE_DATASTORE_PATH_MAX_LEN]; ///< Log renamed aside by a compaction
+    int                                            logFd;                                            ///< Log file, INVALID when kept in memory only
+    uint32_t                                       logBytes;                                         ///< Log file size
+    uint32_t                                       liveBytes;                                        ///< Size of the entries as PUT records
+    struct _mangoh_bridge_datastore_sync_job_t*    syncJob;                                          ///< Running fdatasync(), NULL if none
+    struct _mangoh_bridge_datastore_compact_job_t* compactJob;                                       ///< Running compaction, NULL if none
+    bool                                           oldLog;                                           ///< Old log not yet covered by a snapshot
+    bool                                           dirty;                                            ///< Log appended since the last fdatasync() started
+} mangoh_bridge_datastore_t;
+
+bool mangoh_bridge_datastore_isPersistent(const mangoh_bridge_datastore_t*);
+
+int mangoh_bridge_datastore_get(mangoh_bridge_datastore_t*, const char*, mangoh_bridge_json_data_t**);
+int mangoh_bridge_datastore_getSerialized(mangoh_bridge_datastore_t*, const char*, const uint8_t**, uint32_t*);
+int mangoh_bridge_datastore_put(mangoh_bridge_datastore_t*, const char*, mangoh_bridge_json_data_t*);
+int mangoh_bridge_datastore_remove(mangoh_bridge_datastore_t*, const char*, mangoh_bridge_json_data_t**);
+int mangoh_bridge_datastore_forEach(const mangoh_bridge_datastore_t*, mangoh_bridge_datastore_iter_func_t, void*);
+int mangoh_bridge_datastore_sync(mangoh_bridge_datastore_t*, mangoh_bridge_datastore_waiter_t*);
+
+int mangoh_bridge_datastore_init(mangoh_bridge_datastore_t*, const char*);
+int mangoh_bridge_datastore_destroy(mangoh_bridge_datastore_t*);
+
+#endif
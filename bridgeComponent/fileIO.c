@@ -14,6 +14,27 @@
 #include "bridge.h"
 #include "fileIO.h"
 
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Deferred file command, run on a worker thread
+ *
+ * Every command on a file is submitted with the same worker key so they run in the order received, the duplicate
+ * descriptors share the file offset.
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_fileio_job_t
+{
+    mangoh_bridge_pending_t pending;                                      ///< Deferred response
+    uint8_t                 buffer[MANGOH_BRIDGE_FILEIO_WRITE_BUFF_SIZE]; ///< Data written or read
+    void*                   bridge;                                       ///< Bridge module
+    ssize_t                 result;                                       ///< System call result
+    int32_t                 err;                                          ///< System call errno
+    int                     fd;                                           ///< Duplicate of the file descriptor, the MCU may close the file meanwhile
+    off_t                   pos;                                          ///< Seek position, file position or size
+    uint32_t                len;                                          ///< Bytes to transfer
+    int8_t                  id;                                           ///< File ID
+} mangoh_bridge_fileio_job_t;
+
 static int mangoh_bridge_fileio_getMode(unsigned char, int*);
 static int mangoh_bridge_fileio_open(void*, const unsigned char*, uint32_t);
 static int mangoh_bridge_fileio_write(void*, const unsigned char*, uint32_t);
@@ -24,6 +45,22 @@ static int mangoh_bridge_fileio_position(void*, const unsigned char*, uint32_t);
 static int mangoh_bridge_fileio_size(void*, const unsigned char*, uint32_t);
 static int mangoh_bridge_fileio_close(void*, const unsigned char*, uint32_t);
 
+static mangoh_bridge_fileio_job_t* mangoh_bridge_fileio_createJob(const mangoh_bridge_fileio_t*, int8_t, uint32_t);
+static int mangoh_bridge_fileio_submitJob(const mangoh_bridge_fileio_t*, mangoh_bridge_fileio_job_t*, mangoh_bridge_worker_func_t, mangoh_bridge_worker_func_t);
+static void mangoh_bridge_fileio_completeNack(mangoh_bridge_fileio_job_t*, const char*);
+static void mangoh_bridge_fileio_writeWork(void*);
+static void mangoh_bridge_fileio_writeDone(void*);
+static void mangoh_bridge_fileio_readWork(void*);
+static void mangoh_bridge_fileio_readDone(void*);
+static void mangoh_bridge_fileio_seekWork(void*);
+static void mangoh_bridge_fileio_seekDone(void*);
+static void mangoh_bridge_fileio_positionWork(void*);
+static void mangoh_bridge_fileio_positionDone(void*);
+static void mangoh_bridge_fileio_sizeWork(void*);
+static void mangoh_bridge_fileio_sizeDone(void*);
+static void mangoh_bridge_fileio_closeWork(void*);
+static void mangoh_bridge_fileio_closeDone(void*);
+
 static int mangoh_bridge_fileio_reset(void*);
 
 static int mangoh_bridge_fileio_getMode(unsigned char mode, int* retMode)
@@ -100,7 +137,7 @@ static int mangoh_bridge_fileio_open(void* param, const unsigned char* data, uin
 
     LE_DEBUG("file('%s') fd[%u](%d)", filename, fileio->nextId, fileio->fdList[fileio->nextId]);
 
-    mangoh_bridge_fileio_open_rsp_t* const rsp = (mangoh_bridge_fileio_open_rsp_t*)((mangoh_bridge_t*)fileio->bridge)->packet.msg.data;
+    mangoh_bridge_fileio_open_rsp_t* const rsp = (mangoh_bridge_fileio_open_rsp_t*)((mangoh_bridge_t*)fileio->bridge)->packet.tx.data;
     rsp->result = res;
     rsp->fd = fileio->nextId;
     LE_DEBUG("open(%d), result(%d)", rsp->fd, rsp->result);
@@ -118,6 +155,117 @@ cleanup:
     return res;
 }
 
+static mangoh_bridge_fileio_job_t* mangoh_bridge_fileio_createJob(const mangoh_bridge_fileio_t* fileio, int8_t id, uint32_t len)
+{
+    LE_ASSERT(fileio);
+
+    mangoh_bridge_fileio_job_t* job = calloc(1, sizeof(mangoh_bridge_fileio_job_t));
+    if (!job)
+    {
+        LE_ERROR("ERROR calloc() failed");
+        goto cleanup;
+    }
+
+    job->fd = dup(fileio->fdList[id]);
+    if (job->fd < 0)
+    {
+        LE_ERROR("ERROR dup() fd[%u](%d) failed(%d/%d)", id, fileio->fdList[id], job->fd, errno);
+        free(job);
+        job = NULL;
+        goto cleanup;
+    }
+
+    job->bridge = fileio->bridge;
+    job->id = id;
+    job->len = len;
+
+cleanup:
+    return job;
+}
+
+static int mangoh_bridge_fileio_submitJob(const mangoh_bridge_fileio_t* fileio, mangoh_bridge_fileio_job_t* job, mangoh_bridge_worker_func_t work, mangoh_bridge_worker_func_t done)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(fileio);
+
+    if (!job)
+    {
+        res = LE_IO_ERROR;
+        goto cleanup;
+    }
+
+    // Keyed by the file so a seek, position or size cannot overtake the reads and writes queued before it
+    res = mangoh_bridge_worker_submit(&fileio->fdList[job->id], work, done, job);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_worker_submit() failed(%d)", res);
+        close(job->fd);
+        free(job);
+        goto cleanup;
+    }
+
+    mangoh_bridge_deferResult(fileio->bridge, &job->pending);
+
+cleanup:
+    if ((res != LE_OK) && (mangoh_bridge_sendNack(fileio->bridge) != LE_OK))
+    {
+        LE_ERROR("ERROR mangoh_bridge_sendNack() failed");
+    }
+
+    return res;
+}
+
+static void mangoh_bridge_fileio_completeNack(mangoh_bridge_fileio_job_t* job, const char* op)
+{
+    LE_ASSERT(job);
+
+    LE_ERROR("ERROR %s() fd[%u](%d) failed(%zd/%d)", op, job->id, job->fd, job->result, job->err);
+
+    int32_t res = mangoh_bridge_completeNack(job->bridge, &job->pending);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_completeNack() failed(%d)", res);
+    }
+}
+
+static void mangoh_bridge_fileio_writeWork(void* param)
+{
+    mangoh_bridge_fileio_job_t* job = (mangoh_bridge_fileio_job_t*)param;
+
+    LE_ASSERT(job);
+
+    job->result = write(job->fd, job->buffer, job->len);
+    job->err = errno;
+}
+
+static void mangoh_bridge_fileio_writeDone(void* param)
+{
+    mangoh_bridge_fileio_job_t* job = (mangoh_bridge_fileio_job_t*)param;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(job);
+
+    if (job->result != job->len)
+    {
+        mangoh_bridge_fileio_completeNack(job, "write");
+        goto cleanup;
+    }
+
+    LE_DEBUG("fd[%u](%d), result(%zd)", job->id, job->fd, job->result);
+    mangoh_bridge_fileio_write_rsp_t rsp = { .result = LE_OK };
+    res = mangoh_bridge_completeResult(job->bridge, &job->pending, &rsp, sizeof(rsp));
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_completeResult() failed(%d)", res);
+        goto cleanup;
+    }
+
+cleanup:
+    close(job->fd);
+    free(job);
+}
+
 static int mangoh_bridge_fileio_write(void* param, const unsigned char* data, uint32_t size)
 {
     const mangoh_bridge_fileio_t* fileio = (mangoh_bridge_fileio_t*)param;
@@ -128,32 +276,23 @@ static int mangoh_bridge_fileio_write(void* param, const unsigned char* data, ui
 
     const mangoh_bridge_fileio_write_req_t* const req = (mangoh_bridge_fileio_write_req_t*)data;
     const uint32_t numBytes = size - sizeof(req->fd);
-    mangoh_bridge_packet_dumpBuffer(req->buffer, numBytes);
+    if (LE_IS_TRACE_ENABLED(mangoh_bridge_getTraceRef()))
+    {
+        mangoh_bridge_packet_dumpBuffer(req->buffer, numBytes);
+    }
 
     LE_DEBUG("---> WRITE fd[%u](%d) size(%u)", req->fd, fileio->fdList[req->fd], numBytes);
-    ssize_t bytesWrite = write(fileio->fdList[req->fd], req->buffer, numBytes);
-    if (bytesWrite != numBytes)
+    mangoh_bridge_fileio_job_t* job = mangoh_bridge_fileio_createJob(fileio, req->fd, numBytes);
+    if (job)
     {
-        LE_ERROR("ERROR write() fd[%u](%d) failed(%zd/%d)",  req->fd, fileio->fdList[req->fd], bytesWrite, errno);
-
-        res = mangoh_bridge_sendNack(fileio->bridge);
-        if (res != LE_OK)
-        {
-            LE_ERROR("ERROR mangoh_bridge_sendNack() failed(%d)", res);
-            goto cleanup;
-        }
-
-        res = LE_IO_ERROR;
-        goto cleanup;
+        // The request buffer is reused by the next frame
+        memcpy(job->buffer, req->buffer, numBytes);
     }
 
-    LE_DEBUG("fd[%u](%d), result(%zd/%d)", req->fd, fileio->fdList[req->fd], bytesWrite, res);
-    mangoh_bridge_fileio_write_rsp_t* const rsp = (mangoh_bridge_fileio_write_rsp_t*)((mangoh_bridge_t*)fileio->bridge)->packet.msg.data;
-    rsp->result = res;
-    res = mangoh_bridge_sendResult(fileio->bridge, sizeof(mangoh_bridge_fileio_write_rsp_t));
+    res = mangoh_bridge_fileio_submitJob(fileio, job, mangoh_bridge_fileio_writeWork, mangoh_bridge_fileio_writeDone);
     if (res != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_sendResult() failed(%d)", res);
+        LE_ERROR("ERROR mangoh_bridge_fileio_submitJob() failed(%d)", res);
         goto cleanup;
     }
 
@@ -175,7 +314,7 @@ static int mangoh_bridge_fileio_isDir(void* param, const unsigned char* data, ui
     memcpy(filename, req->filename, size);
     LE_DEBUG("---> IS DIRECTORY '%s'", filename);
 
-    mangoh_bridge_fileio_is_dir_rsp_t* const rsp = (mangoh_bridge_fileio_is_dir_rsp_t*)((mangoh_bridge_t*)fileio->bridge)->packet.msg.data;
+    mangoh_bridge_fileio_is_dir_rsp_t* const rsp = (mangoh_bridge_fileio_is_dir_rsp_t*)((mangoh_bridge_t*)fileio->bridge)->packet.tx.data;
 
     DIR* dir = opendir(filename);
     if (dir)
@@ -215,6 +354,43 @@ cleanup:
     return res;
 }
 
+static void mangoh_bridge_fileio_seekWork(void* param)
+{
+    mangoh_bridge_fileio_job_t* job = (mangoh_bridge_fileio_job_t*)param;
+
+    LE_ASSERT(job);
+
+    job->result = lseek(job->fd, job->pos, SEEK_SET);
+    job->err = errno;
+}
+
+static void mangoh_bridge_fileio_seekDone(void* param)
+{
+    mangoh_bridge_fileio_job_t* job = (mangoh_bridge_fileio_job_t*)param;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(job);
+
+    if (job->result != job->pos)
+    {
+        mangoh_bridge_fileio_completeNack(job, "lseek");
+        goto cleanup;
+    }
+
+    LE_DEBUG("fd[%u](%d) result(%zd)", job->id, job->fd, job->result);
+    mangoh_bridge_fileio_seek_rsp_t rsp = { .result = LE_OK };
+    res = mangoh_bridge_completeResult(job->bridge, &job->pending, &rsp, sizeof(rsp));
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_completeResult() failed(%d)", res);
+        goto cleanup;
+    }
+
+cleanup:
+    close(job->fd);
+    free(job);
+}
+
 static int mangoh_bridge_fileio_seek(void* param, const unsigned char* data, uint32_t size)
 {
     const mangoh_bridge_fileio_t* fileio = (mangoh_bridge_fileio_t*)param;
@@ -230,35 +406,59 @@ static int mangoh_bridge_fileio_seek(void* param, const unsigned char* data, uin
     pos = ntohl(pos);
 
     LE_DEBUG("---> SEEK fd[%u](%d) pos(%u)", req->fd, fileio->fdList[req->fd], pos);
-    res = lseek(fileio->fdList[req->fd], pos, SEEK_SET);
-    if (res != pos)
+    mangoh_bridge_fileio_job_t* job = mangoh_bridge_fileio_createJob(fileio, req->fd, 0);
+    if (job)
     {
-        LE_ERROR("ERROR lseek() fd[%u](%d) failed(%d/%d)", req->fd, fileio->fdList[req->fd], res, errno);
-
-        res = mangoh_bridge_sendNack(fileio->bridge);
-        if (res != LE_OK)
-        {
-            LE_ERROR("ERROR mangoh_bridge_sendNack() failed(%d)", res);
-            goto cleanup;
-        }
+        job->pos = pos;
+    }
 
-        res = LE_IO_ERROR;
+    res = mangoh_bridge_fileio_submitJob(fileio, job, mangoh_bridge_fileio_seekWork, mangoh_bridge_fileio_seekDone);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_fileio_submitJob() failed(%d)", res);
         goto cleanup;
     }
 
-    LE_DEBUG("fd[%u](%d) result(%u)", req->fd, fileio->fdList[req->fd], res);
-    mangoh_bridge_fileio_seek_rsp_t* const rsp = (mangoh_bridge_fileio_seek_rsp_t*)((mangoh_bridge_t*)fileio->bridge)->packet.msg.data;
-    rsp->result = LE_OK;
+cleanup:
+    return res;
+}
+
+static void mangoh_bridge_fileio_positionWork(void* param)
+{
+    mangoh_bridge_fileio_job_t* job = (mangoh_bridge_fileio_job_t*)param;
+
+    LE_ASSERT(job);
+
+    job->result = lseek(job->fd, 0, SEEK_CUR);
+    job->err = errno;
+    job->pos = job->result;
+}
+
+static void mangoh_bridge_fileio_positionDone(void* param)
+{
+    mangoh_bridge_fileio_job_t* job = (mangoh_bridge_fileio_job_t*)param;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(job);
 
-    res = mangoh_bridge_sendResult(fileio->bridge, sizeof(mangoh_bridge_fileio_seek_rsp_t));
+    if (job->result < 0)
+    {
+        mangoh_bridge_fileio_completeNack(job, "lseek");
+        goto cleanup;
+    }
+
+    LE_DEBUG("fd[%u](%d) result(%u)", job->id, job->fd, (uint32_t)job->pos);
+    mangoh_bridge_fileio_pos_rsp_t rsp = { .result = 0, .pos = htonl(job->pos) };
+    res = mangoh_bridge_completeResult(job->bridge, &job->pending, &rsp, sizeof(rsp));
     if (res != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_sendResult() failed(%d)", res);
+        LE_ERROR("ERROR mangoh_bridge_completeResult() failed(%d)", res);
         goto cleanup;
     }
 
 cleanup:
-    return res;
+    close(job->fd);
+    free(job);
 }
 
 static int mangoh_bridge_fileio_position(void* param, const unsigned char* data, uint32_t size)
@@ -272,36 +472,56 @@ static int mangoh_bridge_fileio_position(void* param, const unsigned char* data,
     const mangoh_bridge_fileio_position_req_t* const req = (mangoh_bridge_fileio_position_req_t*)data;
     LE_DEBUG("---> POSITION fd[%u](%d)", req->fd, fileio->fdList[req->fd]);
 
-    const int32_t pos = lseek(fileio->fdList[req->fd], 0, SEEK_CUR);
-    if (pos < 0)
+    mangoh_bridge_fileio_job_t* job = mangoh_bridge_fileio_createJob(fileio, req->fd, 0);
+    res = mangoh_bridge_fileio_submitJob(fileio, job, mangoh_bridge_fileio_positionWork, mangoh_bridge_fileio_positionDone);
+    if (res != LE_OK)
     {
-        LE_ERROR("ERROR lseek() fd(%d) failed(%d/%d)", req->fd, res, errno);
+        LE_ERROR("ERROR mangoh_bridge_fileio_submitJob() failed(%d)", res);
+        goto cleanup;
+    }
 
-        res = mangoh_bridge_sendNack(fileio->bridge);
-        if (res != LE_OK)
-        {
-            LE_ERROR("ERROR mangoh_bridge_sendNack() failed(%d)", res);
-            goto cleanup;
-        }
+cleanup:
+    return res;
+}
 
-        res = LE_IO_ERROR;
+static void mangoh_bridge_fileio_sizeWork(void* param)
+{
+    mangoh_bridge_fileio_job_t* job = (mangoh_bridge_fileio_job_t*)param;
+
+    LE_ASSERT(job);
+
+    struct stat buf = {0};
+    job->result = fstat(job->fd, &buf);
+    job->err = errno;
+    job->pos = buf.st_size;
+}
+
+static void mangoh_bridge_fileio_sizeDone(void* param)
+{
+    mangoh_bridge_fileio_job_t* job = (mangoh_bridge_fileio_job_t*)param;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(job);
+
+    if (job->result < 0)
+    {
+        mangoh_bridge_fileio_completeNack(job, "fstat");
         goto cleanup;
     }
 
-    LE_DEBUG("fd[%u](%d) result(%u)", req->fd, fileio->fdList[req->fd], pos);
-    mangoh_bridge_fileio_pos_rsp_t* const rsp = (mangoh_bridge_fileio_pos_rsp_t*)((mangoh_bridge_t*)fileio->bridge)->packet.msg.data;
-    rsp->result = 0;
-    rsp->pos = htonl(pos);
-
-    res = mangoh_bridge_sendResult(fileio->bridge, sizeof(mangoh_bridge_fileio_pos_rsp_t));
+    const uint32_t fileSize = job->pos;
+    LE_INFO("fd[%u](%d) size(%u)", job->id, job->fd, fileSize);
+    mangoh_bridge_fileio_size_rsp_t rsp = { .result = LE_OK, .size = htonl(fileSize) };
+    res = mangoh_bridge_completeResult(job->bridge, &job->pending, &rsp, sizeof(rsp));
     if (res != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_sendResult() failed(%d)", res);
+        LE_ERROR("ERROR mangoh_bridge_completeResult() failed(%d)", res);
         goto cleanup;
     }
 
 cleanup:
-    return res;
+    close(job->fd);
+    free(job);
 }
 
 static int mangoh_bridge_fileio_size(void* param, const unsigned char* data, uint32_t size)
@@ -315,55 +535,59 @@ static int mangoh_bridge_fileio_size(void* param, const unsigned char* data, uin
     const mangoh_bridge_fileio_size_req_t* const req = (mangoh_bridge_fileio_size_req_t*)data;
     LE_DEBUG("---> SIZE fd[%u](%d)", req->fd, fileio->fdList[req->fd]);
 
-    res = lseek(fileio->fdList[req->fd], 0, SEEK_CUR);
-    if (res < 0)
+    mangoh_bridge_fileio_job_t* job = mangoh_bridge_fileio_createJob(fileio, req->fd, 0);
+    res = mangoh_bridge_fileio_submitJob(fileio, job, mangoh_bridge_fileio_sizeWork, mangoh_bridge_fileio_sizeDone);
+    if (res != LE_OK)
     {
-        LE_ERROR("ERROR lseek() fd[%u](%d) failed(%d/%d)", req->fd, fileio->fdList[req->fd], res, errno);
-
-        res = mangoh_bridge_sendNack(fileio->bridge);
-        if (res != LE_OK)
-        {
-            LE_ERROR("ERROR mangoh_bridge_sendNack() failed(%d)", res);
-            goto cleanup;
-        }
-
-        res = LE_IO_ERROR;
+        LE_ERROR("ERROR mangoh_bridge_fileio_submitJob() failed(%d)", res);
         goto cleanup;
     }
 
-    struct stat buf = {0};
-    res = fstat(fileio->fdList[req->fd], &buf);
-    if (res < 0)
-    {
-        LE_ERROR("ERROR fstat() fd[%u](%d) failed(%d/%d)", req->fd, fileio->fdList[req->fd], res, errno);
+cleanup:
+    return res;
+}
 
-        res = mangoh_bridge_sendNack(fileio->bridge);
-        if (res != LE_OK)
-        {
-            LE_ERROR("ERROR mangoh_bridge_sendNack() failed(%d)", res);
-            goto cleanup;
-        }
+static void mangoh_bridge_fileio_readWork(void* param)
+{
+    mangoh_bridge_fileio_job_t* job = (mangoh_bridge_fileio_job_t*)param;
 
-        res = LE_IO_ERROR;
+    LE_ASSERT(job);
+
+    job->result = read(job->fd, job->buffer, job->len);
+    job->err = errno;
+}
+
+static void mangoh_bridge_fileio_readDone(void* param)
+{
+    mangoh_bridge_fileio_job_t* job = (mangoh_bridge_fileio_job_t*)param;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(job);
+
+    if (job->result < 0)
+    {
+        mangoh_bridge_fileio_completeNack(job, "read");
         goto cleanup;
     }
 
-    const uint32_t fileSize = buf.st_size;
-    LE_INFO("fd[%u](%d) size(%u)", req->fd, fileio->fdList[req->fd], fileSize);
-
-    mangoh_bridge_fileio_size_rsp_t* const rsp = (mangoh_bridge_fileio_size_rsp_t*)((mangoh_bridge_t*)fileio->bridge)->packet.msg.data;
+    mangoh_bridge_fileio_read_rsp_t rsp = { .len = job->result };
+    memcpy(rsp.data, job->buffer, rsp.len);
+    LE_DEBUG("fd[%u](%d), result(%d)", job->id, job->fd, rsp.len);
+    if (LE_IS_TRACE_ENABLED(mangoh_bridge_getTraceRef()))
+    {
+        mangoh_bridge_packet_dumpBuffer(rsp.data, rsp.len);
+    }
 
-    rsp->result = LE_OK;
-    rsp->size = htonl(fileSize);
-    res = mangoh_bridge_sendResult(fileio->bridge, sizeof(mangoh_bridge_fileio_size_rsp_t));
+    res = mangoh_bridge_completeResult(job->bridge, &job->pending, &rsp, sizeof(rsp.len) + rsp.len);
     if (res != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_sendResult() failed(%d)", res);
+        LE_ERROR("ERROR mangoh_bridge_completeResult() failed(%d)", res);
         goto cleanup;
     }
 
 cleanup:
-    return res;
+    close(job->fd);
+    free(job);
 }
 
 static int mangoh_bridge_fileio_read(void* param, const unsigned char* data, uint32_t size)
@@ -377,36 +601,55 @@ static int mangoh_bridge_fileio_read(void* param, const unsigned char* data, uin
     const mangoh_bridge_fileio_read_req_t* const req = (mangoh_bridge_fileio_read_req_t*)data;
     LE_DEBUG("---> READ fd[%u](%d) bytes(%u)", req->fd, fileio->fdList[req->fd], req->size);
 
-    mangoh_bridge_fileio_read_rsp_t* const rsp = (mangoh_bridge_fileio_read_rsp_t*)((mangoh_bridge_t*)fileio->bridge)->packet.msg.data;
-    const ssize_t bytesRead = read(fileio->fdList[req->fd], rsp->data, req->size);
-    if (bytesRead < 0)
+    // Read no more than the response can carry, the rest stays in the file for the next read
+    const uint32_t maxLen = ((mangoh_bridge_t*)fileio->bridge)->packet.dataSize - sizeof(uint8_t);
+    mangoh_bridge_fileio_job_t* job = mangoh_bridge_fileio_createJob(fileio, req->fd, (req->size > maxLen) ? maxLen:req->size);
+    res = mangoh_bridge_fileio_submitJob(fileio, job, mangoh_bridge_fileio_readWork, mangoh_bridge_fileio_readDone);
+    if (res != LE_OK)
     {
-        LE_ERROR("ERROR read() fd[%u](%d) failed(%zd/%d)",  req->fd, fileio->fdList[req->fd], bytesRead, errno);
+        LE_ERROR("ERROR mangoh_bridge_fileio_submitJob() failed(%d)", res);
+        goto cleanup;
+    }
 
-        res = mangoh_bridge_sendNack(fileio->bridge);
-        if (res != LE_OK)
-        {
-            LE_ERROR("ERROR mangoh_bridge_sendNack() failed(%d)", res);
-            goto cleanup;
-        }
+cleanup:
+    return res;
+}
 
-        res = LE_IO_ERROR;
+static void mangoh_bridge_fileio_closeWork(void* param)
+{
+    mangoh_bridge_fileio_job_t* job = (mangoh_bridge_fileio_job_t*)param;
+
+    LE_ASSERT(job);
+
+    // The job owns the descriptor itself, not a duplicate
+    job->result = close(job->fd);
+    job->err = errno;
+}
+
+static void mangoh_bridge_fileio_closeDone(void* param)
+{
+    mangoh_bridge_fileio_job_t* job = (mangoh_bridge_fileio_job_t*)param;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(job);
+
+    if ((job->result < 0) && (job->err != EBADF))
+    {
+        mangoh_bridge_fileio_completeNack(job, "close");
         goto cleanup;
     }
 
-    rsp->len = bytesRead;
-    LE_DEBUG("fd[%u](%d), result(%d)", req->fd, fileio->fdList[req->fd], rsp->len);
-    mangoh_bridge_packet_dumpBuffer(rsp->data, rsp->len);
-
-    res = mangoh_bridge_sendResult(fileio->bridge, sizeof(rsp->len) + rsp->len);
+    LE_DEBUG("fd[%u](%d) result(%zd)", job->id, job->fd, job->result);
+    mangoh_bridge_fileio_close_rsp_t rsp = { .result = LE_OK };
+    res = mangoh_bridge_completeResult(job->bridge, &job->pending, &rsp, sizeof(rsp));
     if (res != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_sendResult() failed(%d)", res);
+        LE_ERROR("ERROR mangoh_bridge_completeResult() failed(%d)", res);
         goto cleanup;
     }
 
 cleanup:
-    return res;
+    free(job);
 }
 
 static int mangoh_bridge_fileio_close(void* param, const unsigned char* data, uint32_t size)
@@ -420,42 +663,43 @@ static int mangoh_bridge_fileio_close(void* param, const unsigned char* data, ui
     const mangoh_bridge_fileio_close_req_t* const req = (mangoh_bridge_fileio_close_req_t*)data;
     LE_DEBUG("---> CLOSE fd[%u](%d)", req->fd, fileio->fdList[req->fd]);
 
-    res = close(fileio->fdList[req->fd]);
-    if (res != LE_OK)
+    if (fileio->fdList[req->fd] == MANGOH_BRIDGE_FILEIO_INVALID_FD)
     {
-        if (errno == EBADF)
+        LE_WARN("WARNING fd[%u] not open", req->fd);
+
+        mangoh_bridge_fileio_close_rsp_t* const rsp = (mangoh_bridge_fileio_close_rsp_t*)((mangoh_bridge_t*)fileio->bridge)->packet.tx.data;
+        rsp->result = LE_OK;
+        res = mangoh_bridge_sendResult(fileio->bridge, sizeof(mangoh_bridge_fileio_close_rsp_t));
+        if (res != LE_OK)
         {
-            LE_WARN("WARNING close() fd[%u](%d) failed(%d/%d)", req->fd, fileio->fdList[req->fd], res, errno);
-            res = LE_OK;
+            LE_ERROR("ERROR mangoh_bridge_sendResult() failed(%d)", res);
+            goto cleanup;
         }
-        else
-        {
-            LE_ERROR("ERROR close() fd[%u](%d) failed(%d/%d)", req->fd, fileio->fdList[req->fd], res, errno);
 
-            res = mangoh_bridge_sendNack(fileio->bridge);
-            if (res != LE_OK)
-            {
-                LE_ERROR("ERROR mangoh_bridge_sendNack() failed(%d)", res);
-                goto cleanup;
-            }
+        goto cleanup;
+    }
 
-            res = LE_IO_ERROR;
-            goto cleanup;
-        }
+    mangoh_bridge_fileio_job_t* job = calloc(1, sizeof(mangoh_bridge_fileio_job_t));
+    if (job)
+    {
+        // Closed once the commands queued before it are done, later commands on this ID fail at once
+        job->bridge = fileio->bridge;
+        job->id = req->fd;
+        job->fd = fileio->fdList[req->fd];
+        fileio->fdList[req->fd] = MANGOH_BRIDGE_FILEIO_INVALID_FD;
+    }
+    else
+    {
+        LE_ERROR("ERROR calloc() failed");
     }
 
-    mangoh_bridge_fileio_close_rsp_t* const rsp = (mangoh_bridge_fileio_close_rsp_t*)((mangoh_bridge_t*)fileio->bridge)->packet.msg.data;
-    rsp->result = res;
-    LE_DEBUG("fd[%u](%d) result(%u)", req->fd, fileio->fdList[req->fd], rsp->result);
-    res = mangoh_bridge_sendResult(fileio->bridge, sizeof(mangoh_bridge_fileio_close_rsp_t));
+    res = mangoh_bridge_fileio_submitJob(fileio, job, mangoh_bridge_fileio_closeWork, mangoh_bridge_fileio_closeDone);
     if (res != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_sendResult() failed(%d)", res);
+        LE_ERROR("ERROR mangoh_bridge_fileio_submitJob() failed(%d)", res);
         goto cleanup;
     }
 
-    fileio->fdList[req->fd] = MANGOH_BRIDGE_FILEIO_INVALID_FD;
-
 cleanup:
     return res;
 }
@@ -1706,7 +1706,7 @@ int mangoh_bridge_json_copyObject(mangoh_bridge_json_data_t** dest, const mangoh
     int32_t res = LE_OK;
 
     LE_ASSERT(src);
-    LE_ASSERT(dest && !dest);
+    LE_ASSERT(dest && !*dest);
 
     res = mangoh_bridge_json_write(src, &buff, &len);
     if (res != LE_OK)
@@ -1715,10 +1715,21 @@ int mangoh_bridge_json_copyObject(mangoh_bridge_json_data_t** dest, const mangoh
         goto cleanup;
     }
 
-    res = mangoh_bridge_json_read(buff, &len, dest);
+    uint8_t* str = realloc(buff, len + 1);
+    if (!str)
+    {
+        LE_ERROR("ERROR realloc() failed");
+        res = LE_NO_MEMORY;
+        goto cleanup;
+    }
+
+    buff = str;
+    buff[len] = 0;
+
+    res = mangoh_bridge_json_readValue((const char*)buff, dest);
     if (res != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_json_read() failed(%d)", res);
+        LE_ERROR("ERROR mangoh_bridge_json_readValue() failed(%d)", res);
         goto cleanup;
     }
 
@@ -1771,6 +1782,38 @@ cleanup:
     return res;
 }
 
+int mangoh_bridge_json_createString(mangoh_bridge_json_data_t** jsonStrData, const char* str)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(jsonStrData && (*jsonStrData == NULL));
+    LE_ASSERT(str);
+
+    *jsonStrData = calloc(1, sizeof(mangoh_bridge_json_data_t));
+    if (!*jsonStrData)
+    {
+        LE_ERROR("ERROR calloc() failed");
+        res = LE_NO_MEMORY;
+        goto cleanup;
+    }
+
+    (*jsonStrData)->type = MANGOH_BRIDGE_JSON_DATA_TYPE_STRING;
+    (*jsonStrData)->len = strlen(str) + 1;
+    (*jsonStrData)->data.strVal = calloc(1, (*jsonStrData)->len);
+    if (!(*jsonStrData)->data.strVal)
+    {
+        LE_ERROR("ERROR calloc() failed");
+        free(*jsonStrData);
+        *jsonStrData = NULL;
+        res = LE_NO_MEMORY;
+        goto cleanup;
+    }
+    strcpy((*jsonStrData)->data.strVal, str);
+
+cleanup:
+    return res;
+}
+
 int mangoh_bridge_json_setResponseCommand(mangoh_bridge_json_data_t* jsonRspData, const char* cmd)
 {
     int32_t res = LE_OK;
@@ -1977,6 +2020,36 @@ cleanup:
     return res;
 }
 
+int mangoh_bridge_json_readValue(const char* str, mangoh_bridge_json_data_t** jsonData)
+{
+    int res = LE_OK;
+
+    LE_ASSERT(str);
+    LE_ASSERT(jsonData && !*jsonData);
+
+    // Unlike a message any value type is accepted, the terminator ends numbers and literals
+    const uint8_t* ptr = (const uint8_t*)str;
+    uint32_t len = strlen(str) + 1;
+    res = mangoh_bridge_json_readData(&ptr, &len, jsonData);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_json_readData() failed(%d)", res);
+        goto cleanup;
+    }
+
+cleanup:
+    if (res && *jsonData)
+    {
+        int32_t err = mangoh_bridge_json_destroy(jsonData);
+        if (err != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_json_destroy() failed(%d)", err);
+        }
+    }
+
+    return res;
+}
+
 int mangoh_bridge_json_write(const mangoh_bridge_json_data_t* jsonData, uint8_t** buff, uint32_t* len)
 {
     int res = LE_OK;
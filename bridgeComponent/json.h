@@ -118,12 +118,14 @@ int mangoh_bridge_json_setKey(mangoh_bridge_json_data_t*, const char*);
 int mangoh_bridge_json_setValue(mangoh_bridge_json_data_t*, const mangoh_bridge_json_data_t*);
 
 int mangoh_bridge_json_createArray(mangoh_bridge_json_data_t**);
+int mangoh_bridge_json_createString(mangoh_bridge_json_data_t**, const char*);
 int mangoh_bridge_json_copyObject(mangoh_bridge_json_data_t**, const mangoh_bridge_json_data_t*);
 int mangoh_bridge_json_addObject(mangoh_bridge_json_data_t*, const mangoh_bridge_json_data_t*);
 
 int mangoh_bridge_json_createObject(mangoh_bridge_json_data_t**);
 
 int mangoh_bridge_json_read(const uint8_t* const, uint32_t*, mangoh_bridge_json_data_t**);
+int mangoh_bridge_json_readValue(const char*, mangoh_bridge_json_data_t**);
 int mangoh_bridge_json_write(const mangoh_bridge_json_data_t*, uint8_t**, uint32_t*);
 int mangoh_bridge_json_destroy(mangoh_bridge_json_data_t**);
 
@@ -15,22 +15,40 @@
 #include "tcpServer.h"
 #include "bridge.h"
 #include "json.h"
+#include "datastore.h"
 #include "mailbox.h"
 
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Datastore put waiting for its commit
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_mailbox_put_job_t
+{
+    mangoh_bridge_datastore_waiter_t waiter;  ///< Datastore commit waiter
+    mangoh_bridge_pending_t          pending; ///< Deferred response
+    void*                            bridge;  ///< Bridge module
+} mangoh_bridge_mailbox_put_job_t;
+
 static int mangoh_bridge_mailbox_send(void*, const unsigned char*, uint32_t);
 static int mangoh_bridge_mailbox_send_json(void*, const unsigned char*, uint32_t);
 static int mangoh_bridge_mailbox_recv(void*, const unsigned char*, uint32_t);
 static int mangoh_bridge_mailbox_available(void*, const unsigned char*, uint32_t);
 static int mangoh_bridge_mailbox_datastorePut(void*, const unsigned char*, uint32_t);
 static int mangoh_bridge_mailbox_datastoreGet(void*, const unsigned char*, uint32_t);
+static void mangoh_bridge_mailbox_datastoreCommitted(void*, int32_t);
+static int mangoh_bridge_mailbox_addValue(const char*, const uint8_t*, uint32_t, void*);
+
+static void mangoh_bridge_mailbox_nextMessage(mangoh_bridge_mailbox_t*);
+static int mangoh_bridge_mailbox_enqueue(mangoh_bridge_mailbox_t*, const uint8_t*, uint32_t, uint32_t*);
+static int mangoh_bridge_mailbox_sendRawResult(mangoh_bridge_mailbox_t*, uint32_t, const char*);
 
-static int mangoh_bridge_mailbox_processRawCommand(mangoh_bridge_mailbox_t*, const mangoh_bridge_json_data_t*);
+static int mangoh_bridge_mailbox_processRawCommand(mangoh_bridge_mailbox_t*, uint32_t, const mangoh_bridge_json_data_t*);
 static int mangoh_bridge_mailbox_processGetCommand(mangoh_bridge_mailbox_t*, const mangoh_bridge_json_data_t*);
 static int mangoh_bridge_mailbox_processPutCommand(mangoh_bridge_mailbox_t*, const mangoh_bridge_json_data_t*);
 static int mangoh_bridge_mailbox_processDeleteCommand(mangoh_bridge_mailbox_t*, const mangoh_bridge_json_data_t*);
-static int mangoh_bridge_mailbox_processCommands(mangoh_bridge_mailbox_t*);
+static int mangoh_bridge_mailbox_processCommands(void*);
 
-static int mangoh_bridge_mailbox_runner(void*);
 static int mangoh_bridge_mailbox_reset(void*);
 
 static int mangoh_bridge_mailbox_send(void* param, const unsigned char* data, uint32_t size)
@@ -209,15 +227,17 @@ static int mangoh_bridge_mailbox_recv(void* param, const unsigned char* data, ui
 
     LE_DEBUG("---> RECV");
 
-    if (mailbox->rxBuffLen)
+    if (mailbox->rxMsgCount)
     {
-        mangoh_bridge_mailbox_recv_rsp_t* const rsp = (mangoh_bridge_mailbox_recv_rsp_t*)((mangoh_bridge_t*)mailbox->bridge)->packet.msg.data;
-        uint8_t rdLen = (sizeof(rsp->data) > mailbox->rxBuffLen) ? mailbox->rxBuffLen:sizeof(rsp->data);
-
-        memcpy(rsp->data, (const char*)mailbox->rxBuffer, rdLen);
-        memmove(mailbox->rxBuffer, &mailbox->rxBuffer[rdLen], mailbox->rxBuffLen - rdLen);
-        memset(&mailbox->rxBuffer[mailbox->rxBuffLen - rdLen], 0, rdLen);
-        mailbox->rxBuffLen -= rdLen;
+        // A message larger than a frame is returned in chunks, it is removed once completely read
+        mangoh_bridge_mailbox_recv_rsp_t* const rsp = (mangoh_bridge_mailbox_recv_rsp_t*)((mangoh_bridge_t*)mailbox->bridge)->packet.tx.data;
+        const uint32_t maxLen = ((mangoh_bridge_t*)mailbox->bridge)->packet.dataSize;
+        uint32_t rdLen = mangoh_bridge_queue_read(&mailbox->rxQueue, rsp->data, (mailbox->rxMsgLen > maxLen) ? maxLen:mailbox->rxMsgLen);
+        mailbox->rxMsgLen -= rdLen;
+        if (!mailbox->rxMsgLen)
+        {
+            mangoh_bridge_mailbox_nextMessage(mailbox);
+        }
 
         LE_DEBUG("result(%u)", rdLen);
         res = mangoh_bridge_sendResult(mailbox->bridge, rdLen);
@@ -251,10 +271,11 @@ static int mangoh_bridge_mailbox_available(void* param, const unsigned char* dat
 
     LE_DEBUG("---> AVAILABLE");
 
-    mangoh_bridge_mailbox_available_rsp_t* const rsp = (mangoh_bridge_mailbox_available_rsp_t*)((mangoh_bridge_t*)mailbox->bridge)->packet.msg.data;
+    mangoh_bridge_mailbox_available_rsp_t* const rsp = (mangoh_bridge_mailbox_available_rsp_t*)((mangoh_bridge_t*)mailbox->bridge)->packet.tx.data;
 
-    rsp->len = htons(mailbox->rxBuffLen);
-    LE_DEBUG("result(%u)", mailbox->rxBuffLen);
+    rsp->len = htons((mailbox->rxMsgLen > UINT16_MAX) ? UINT16_MAX:mailbox->rxMsgLen);
+    rsp->count = htons((mailbox->rxMsgCount > UINT16_MAX) ? UINT16_MAX:mailbox->rxMsgCount);
+    LE_DEBUG("result(%u) messages(%u)", mailbox->rxMsgLen, mailbox->rxMsgCount);
     res = mangoh_bridge_sendResult(mailbox->bridge, sizeof(mangoh_bridge_mailbox_available_rsp_t));
     if (res != LE_OK)
     {
@@ -289,7 +310,7 @@ static int mangoh_bridge_mailbox_datastorePut(void* param, const unsigned char*
         token = strtok(NULL, search);
     }
 
-    mangoh_bridge_mailbox_datastore_put_rsp_t* const rsp = (mangoh_bridge_mailbox_datastore_put_rsp_t*)((mangoh_bridge_t*)mailbox->bridge)->packet.msg.data;
+    mangoh_bridge_mailbox_datastore_put_rsp_t* const rsp = (mangoh_bridge_mailbox_datastore_put_rsp_t*)((mangoh_bridge_t*)mailbox->bridge)->packet.tx.data;
     if (idx == MANGOH_BRIDGE_MAILBOX_DATASTORE_PARAMS)
     {
         mangoh_bridge_json_data_t* jsonData = NULL;
@@ -303,12 +324,13 @@ static int mangoh_bridge_mailbox_datastorePut(void* param, const unsigned char*
         }
         else
         {
-            if (le_hashmap_Put(mailbox->database, params[MANGOH_BRIDGE_MAILBOX_DATASTORE_KEY_IDX], jsonData))
+            res = mangoh_bridge_datastore_put(&mailbox->datastore, params[MANGOH_BRIDGE_MAILBOX_DATASTORE_KEY_IDX], jsonData);
+            if (res != LE_OK)
             {
-                LE_WARN("WARNING object replaced");
+                LE_ERROR("ERROR mangoh_bridge_datastore_put() failed(%d)", res);
             }
 
-            rsp->result = true;
+            rsp->result = (res == LE_OK);
         }
     }
     else
@@ -317,6 +339,29 @@ static int mangoh_bridge_mailbox_datastorePut(void* param, const unsigned char*
         rsp->result = false;
     }
 
+    // Acknowledge a stored value once it is on disk, it is committed with the other puts waiting
+    if (rsp->result && mangoh_bridge_datastore_isPersistent(&mailbox->datastore))
+    {
+        mangoh_bridge_mailbox_put_job_t* job = calloc(1, sizeof(mangoh_bridge_mailbox_put_job_t));
+        if (job)
+        {
+            job->bridge = mailbox->bridge;
+            job->waiter.func = mangoh_bridge_mailbox_datastoreCommitted;
+            job->waiter.context = job;
+            mangoh_bridge_deferResult(mailbox->bridge, &job->pending);
+
+            res = mangoh_bridge_datastore_sync(&mailbox->datastore, &job->waiter);
+            if (res != LE_OK)
+            {
+                LE_ERROR("ERROR mangoh_bridge_datastore_sync() failed(%d)", res);
+            }
+
+            goto cleanup;
+        }
+
+        LE_ERROR("ERROR calloc() failed");
+    }
+
     LE_DEBUG("result(%d)", rsp->result);
     res = mangoh_bridge_sendResult(mailbox->bridge, sizeof(mangoh_bridge_mailbox_datastore_put_rsp_t));
     if (res != LE_OK)
@@ -340,23 +385,21 @@ static int mangoh_bridge_mailbox_datastoreGet(void* param, const unsigned char*
     const mangoh_bridge_mailbox_datastore_get_req_t* const req = (mangoh_bridge_mailbox_datastore_get_req_t*)data;
     LE_DEBUG("---> DATASTORE GET('%s')", req->key);
 
-    mangoh_bridge_mailbox_datastore_get_rsp_t* const rsp = (mangoh_bridge_mailbox_datastore_get_rsp_t*)((mangoh_bridge_t*)mailbox->bridge)->packet.msg.data;
-    mangoh_bridge_json_data_t* jsonData = NULL;
-
-    jsonData = le_hashmap_Get(mailbox->database, req->key);
-    if (jsonData)
+    mangoh_bridge_mailbox_datastore_get_rsp_t* const rsp = (mangoh_bridge_mailbox_datastore_get_rsp_t*)((mangoh_bridge_t*)mailbox->bridge)->packet.tx.data;
+    const uint8_t* value = NULL;
+    uint32_t len = 0;
+    if (mangoh_bridge_datastore_getSerialized(&mailbox->datastore, (const char*)req->key, &value, &len) == LE_OK)
     {
-        LE_ASSERT(!mailbox->jsonMsg);
-        res = mangoh_bridge_json_write(jsonData, &mailbox->jsonMsg, &mailbox->jsonMsgLen);
-        if (res != LE_OK)
+        if (len > ((mangoh_bridge_t*)mailbox->bridge)->packet.dataSize)
         {
-            LE_ERROR("ERROR mangoh_bridge_json_write() failed(%d)", res);
-            goto cleanup;
+            LE_ERROR("ERROR value('%s') length(%u) exceeds payload size(%u)",
+                     req->key, len, ((mangoh_bridge_t*)mailbox->bridge)->packet.dataSize);
+            len = 0;
         }
 
-        memcpy(rsp->data, mailbox->jsonMsg, mailbox->jsonMsgLen);
-        LE_DEBUG("result(%u)", mailbox->jsonMsgLen);
-        res = mangoh_bridge_sendResult(mailbox->bridge, mailbox->jsonMsgLen);
+        memcpy(rsp->data, value, len);
+        LE_DEBUG("result(%u)", len);
+        res = mangoh_bridge_sendResult(mailbox->bridge, len);
         if (res != LE_OK)
         {
             LE_ERROR("ERROR mangoh_bridge_sendResult() failed(%d)", res);
@@ -377,7 +420,189 @@ cleanup:
     return res;
 }
 
-static int mangoh_bridge_mailbox_processRawCommand(mangoh_bridge_mailbox_t* mailbox, const mangoh_bridge_json_data_t* jsonReqData)
+static void mangoh_bridge_mailbox_datastoreCommitted(void* param, int32_t result)
+{
+    mangoh_bridge_mailbox_put_job_t* job = (mangoh_bridge_mailbox_put_job_t*)param;
+
+    LE_ASSERT(job);
+
+    mangoh_bridge_mailbox_datastore_put_rsp_t rsp = { .result = (result == LE_OK) };
+    LE_DEBUG("result(%d)", rsp.result);
+    int32_t res = mangoh_bridge_completeResult(job->bridge, &job->pending, &rsp, sizeof(rsp));
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_completeResult() failed(%d)", res);
+    }
+
+    free(job);
+}
+
+static int mangoh_bridge_mailbox_addValue(const char* key, const uint8_t* serialized, uint32_t len, void* context)
+{
+    mangoh_bridge_json_data_t* jsonArrayData = (mangoh_bridge_json_data_t*)context;
+    mangoh_bridge_json_data_t* value = NULL;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(key);
+    LE_ASSERT(serialized);
+    LE_ASSERT(jsonArrayData);
+
+    LE_DEBUG("key('%s') len(%u)", key, len);
+    res = mangoh_bridge_json_readValue((const char*)serialized, &value);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_json_readValue() failed(%d)", res);
+        goto cleanup;
+    }
+
+    res = mangoh_bridge_json_addObject(jsonArrayData, value);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_json_addObject() failed(%d)", res);
+        goto cleanup;
+    }
+
+cleanup:
+    if (value) mangoh_bridge_json_destroy(&value);
+    return res;
+}
+
+static void mangoh_bridge_mailbox_nextMessage(mangoh_bridge_mailbox_t* mailbox)
+{
+    LE_ASSERT(mailbox);
+    LE_ASSERT(mailbox->rxMsgCount);
+
+    mangoh_bridge_queue_consume(&mailbox->rxQueue, mailbox->rxMsgLen);
+    mailbox->rxMsgLen = 0;
+    mailbox->rxMsgCount--;
+
+    if (mailbox->rxMsgCount)
+    {
+        uint32_t len = 0;
+        mangoh_bridge_queue_read(&mailbox->rxQueue, &len, sizeof(len));
+        mailbox->rxMsgLen = len;
+    }
+}
+
+static int mangoh_bridge_mailbox_enqueue(mangoh_bridge_mailbox_t* mailbox, const uint8_t* msg, uint32_t len, uint32_t* dropped)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(mailbox);
+    LE_ASSERT(msg);
+    LE_ASSERT(dropped);
+
+    *dropped = 0;
+    if (sizeof(len) + len > mailbox->rxMaxBytes)
+    {
+        LE_ERROR("ERROR message length(%u) exceeds mailbox size(%u)", len, mailbox->rxMaxBytes);
+        res = LE_OVERFLOW;
+        goto cleanup;
+    }
+
+    while (mangoh_bridge_queue_len(&mailbox->rxQueue) + sizeof(len) + len > mailbox->rxMaxBytes)
+    {
+        if (!mailbox->rxDropOldest)
+        {
+            LE_ERROR("ERROR mailbox full, messages(%u) length(%u)", mailbox->rxMsgCount, len);
+            res = LE_OVERFLOW;
+            goto cleanup;
+        }
+
+        mangoh_bridge_mailbox_nextMessage(mailbox);
+        (*dropped)++;
+    }
+
+    // The first message length is kept aside so the MCU can be told its size without touching the queue
+    if (mailbox->rxMsgCount)
+    {
+        mangoh_bridge_queue_write(&mailbox->rxQueue, &len, sizeof(len));
+    }
+    else
+    {
+        mailbox->rxMsgLen = len;
+    }
+
+    mangoh_bridge_queue_write(&mailbox->rxQueue, msg, len);
+    mailbox->rxMsgCount++;
+
+cleanup:
+    return res;
+}
+
+static int mangoh_bridge_mailbox_sendRawResult(mangoh_bridge_mailbox_t* mailbox, uint32_t idx, const char* result)
+{
+    mangoh_bridge_json_data_t* jsonRspData = NULL;
+    mangoh_bridge_json_data_t* jsonValue = NULL;
+    uint8_t* msg = NULL;
+    uint32_t msgLen = 0;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(mailbox);
+    LE_ASSERT(result);
+
+    res = mangoh_bridge_json_createObject(&jsonRspData);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_json_createObject() failed(%d)", res);
+        goto cleanup;
+    }
+
+    res = mangoh_bridge_json_setResponseCommand(jsonRspData, MANGOH_BRIDGE_MAILBOX_RAW_COMMAND);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_json_setResponseCommand() failed(%d)", res);
+        goto cleanup;
+    }
+
+    res = mangoh_bridge_json_createString(&jsonValue, result);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_json_createString() failed(%d)", res);
+        goto cleanup;
+    }
+
+    res = mangoh_bridge_json_setValue(jsonRspData, jsonValue);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_json_setValue() failed(%d)", res);
+        mangoh_bridge_json_destroy(&jsonValue);
+        goto cleanup;
+    }
+
+    res = mangoh_bridge_json_write(jsonRspData, &msg, &msgLen);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_json_write() failed(%d)", res);
+        goto cleanup;
+    }
+
+    res = mangoh_bridge_tcp_client_writeTo(&mailbox->clients, idx, msg, msgLen);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_tcp_client_writeTo() failed(%d)", res);
+        goto cleanup;
+    }
+
+cleanup:
+    if (jsonRspData)
+    {
+        int32_t err = mangoh_bridge_json_destroy(&jsonRspData);
+        if (err != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_json_destroy() failed(%d)", err);
+        }
+    }
+
+    if (msg)
+    {
+        free(msg);
+    }
+
+    return res;
+}
+
+static int mangoh_bridge_mailbox_processRawCommand(mangoh_bridge_mailbox_t* mailbox, uint32_t idx, const mangoh_bridge_json_data_t* jsonReqData)
 {
     int32_t res = LE_OK;
 
@@ -407,16 +632,30 @@ static int mangoh_bridge_mailbox_processRawCommand(mangoh_bridge_mailbox_t* mail
     }
 
     LE_DEBUG("RAW response(%u)", mailbox->jsonMsgLen);
-    if (mailbox->rxBuffLen + mailbox->jsonMsgLen > sizeof(mailbox->rxBuffer))
+    uint32_t dropped = 0;
+    res = mangoh_bridge_mailbox_enqueue(mailbox, mailbox->jsonMsg, mailbox->jsonMsgLen, &dropped);
+    if (res == LE_OVERFLOW)
     {
-        LE_ERROR("ERROR mailbox Rx buffer overflow");
-        res = LE_OVERFLOW;
+        res = mangoh_bridge_mailbox_sendRawResult(mailbox, idx, MANGOH_BRIDGE_MAILBOX_RAW_REJECTED);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_mailbox_sendRawResult() failed(%d)", res);
+        }
+
         goto cleanup;
     }
+    else if (dropped)
+    {
+        LE_WARN("WARNING mailbox full, oldest messages(%u) dropped", dropped);
+        res = mangoh_bridge_mailbox_sendRawResult(mailbox, idx, MANGOH_BRIDGE_MAILBOX_RAW_DROPPED);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_mailbox_sendRawResult() failed(%d)", res);
+            goto cleanup;
+        }
+    }
 
-    memcpy(&mailbox->rxBuffer[mailbox->rxBuffLen], mailbox->jsonMsg, mailbox->jsonMsgLen);
-    mailbox->rxBuffLen += mailbox->jsonMsgLen;
-    LE_DEBUG("Rx buffer(%u)", mailbox->rxBuffLen);
+    LE_DEBUG("messages(%u) queued(%u)", mailbox->rxMsgCount, mangoh_bridge_queue_len(&mailbox->rxQueue));
 
 cleanup:
     if (mailbox->jsonMsg)
@@ -471,22 +710,19 @@ static int mangoh_bridge_mailbox_processGetCommand(mangoh_bridge_mailbox_t* mail
         }
 
         mangoh_bridge_json_data_t* jsonDataCopy = NULL;
-        mangoh_bridge_json_data_t* value = NULL;
-
-        value = le_hashmap_Get(mailbox->database, key);
-        if (!value)
+        res = mangoh_bridge_datastore_get(&mailbox->datastore, key, &jsonDataCopy);
+        if (res == LE_NOT_FOUND)
         {
             LE_WARN("WARNING JSON object('%s') not found", key);
+            res = LE_OK;
+        }
+        else if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_datastore_get() failed(%d)", res);
+            goto cleanup;
         }
         else
         {
-            res = mangoh_bridge_json_copyObject(&jsonDataCopy, value);
-            if (res != LE_OK)
-            {
-                LE_ERROR("ERROR mangoh_bridge_json_copyObject() failed(%d)", res);
-                goto cleanup;
-            }
-
             res = mangoh_bridge_json_setValue(jsonRspData, jsonDataCopy);
             if (res != LE_OK)
             {
@@ -505,36 +741,12 @@ static int mangoh_bridge_mailbox_processGetCommand(mangoh_bridge_mailbox_t* mail
             goto cleanup;
         }
 
-        le_hashmap_It_Ref_t iter = le_hashmap_GetIterator(mailbox->database);
-        res =  le_hashmap_NextNode(iter);
-        while (res == LE_OK)
+        res = mangoh_bridge_datastore_forEach(&mailbox->datastore, mangoh_bridge_mailbox_addValue, jsonArrayData);
+        if (res != LE_OK)
         {
-            const char* key = (char*)le_hashmap_GetKey(iter);
-            if (!key)
-            {
-                LE_ERROR("ERROR le_hashmap_GetKey() failed");
-                res = LE_NOT_FOUND;
-                goto cleanup;
-            }
-
-            LE_DEBUG("key('%s')", key);
-
-            const mangoh_bridge_json_data_t* value = (mangoh_bridge_json_data_t*)le_hashmap_GetValue(iter);
-            if (!value)
-            {
-                LE_ERROR("ERROR le_hashmap_GetValue() failed");
-                res = LE_NOT_FOUND;
-                goto cleanup;
-            }
-
-            res = mangoh_bridge_json_addObject(jsonArrayData, value);
-            if (res != LE_OK)
-            {
-                LE_ERROR("ERROR mangoh_bridge_json_addObject() failed(%d)", res);
-                goto cleanup;
-            }
-
-            res = le_hashmap_NextNode(iter);
+            LE_ERROR("ERROR mangoh_bridge_datastore_forEach() failed(%d)", res);
+            mangoh_bridge_json_destroy(&jsonArrayData);
+            goto cleanup;
         }
 
         res = mangoh_bridge_json_setValue(jsonRspData, jsonArrayData);
@@ -619,15 +831,23 @@ static int mangoh_bridge_mailbox_processPutCommand(mangoh_bridge_mailbox_t* mail
         goto cleanup;
     }
 
-    if (le_hashmap_Put(mailbox->database, key, value))
+    mangoh_bridge_json_data_t* storedValue = NULL;
+    res = mangoh_bridge_json_copyObject(&storedValue, value);
+    if (res != LE_OK)
     {
-        LE_DEBUG("REPLACED('%s')", key);
+        LE_ERROR("ERROR mangoh_bridge_json_copyObject() failed(%d)", res);
+        goto cleanup;
     }
-    else
+
+    res = mangoh_bridge_datastore_put(&mailbox->datastore, key, storedValue);
+    if (res != LE_OK)
     {
-        LE_DEBUG("ADDED('%s')", key);
+        LE_ERROR("ERROR mangoh_bridge_datastore_put() failed(%d)", res);
+        goto cleanup;
     }
 
+    mangoh_bridge_datastore_sync(&mailbox->datastore, NULL);
+
     res = mangoh_bridge_json_createObject(&jsonRspData);
     if (res != LE_OK)
     {
@@ -649,20 +869,11 @@ static int mangoh_bridge_mailbox_processPutCommand(mangoh_bridge_mailbox_t* mail
         goto cleanup;
     }
 
-    mangoh_bridge_json_data_t* putValue = NULL;
-    putValue = le_hashmap_Get(mailbox->database, key);
-    if (!putValue)
-    {
-        LE_ERROR("ERROR JSON object('%s') not found", key);
-        res = LE_NOT_FOUND;
-        goto cleanup;
-    }
-
     mangoh_bridge_json_data_t* jsonDataCopy = NULL;
-    res = mangoh_bridge_json_copyObject(&jsonDataCopy, putValue);
+    res = mangoh_bridge_datastore_get(&mailbox->datastore, key, &jsonDataCopy);
     if (res != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_json_copyObject() failed(%d)", res);
+        LE_ERROR("ERROR mangoh_bridge_datastore_get('%s') failed(%d)", key, res);
         goto cleanup;
     }
 
@@ -755,26 +966,28 @@ static int mangoh_bridge_mailbox_processDeleteCommand(mangoh_bridge_mailbox_t* m
     }
 
     mangoh_bridge_json_data_t* value = NULL;
-    value = le_hashmap_Get(mailbox->database, key);
-    if (value)
+    res = mangoh_bridge_datastore_remove(&mailbox->datastore, key, &value);
+    if (res == LE_OK)
     {
-        if (!le_hashmap_Remove(mailbox->database, key))
-        {
-            LE_ERROR("ERROR le_hashmap_Remove() failed");
-            res = LE_FAULT;
-            goto cleanup;
-        }
+        mangoh_bridge_datastore_sync(&mailbox->datastore, NULL);
 
         res = mangoh_bridge_json_setValue(jsonRspData, value);
         if (res != LE_OK)
         {
             LE_ERROR("ERROR mangoh_bridge_json_setValue() failed(%d)", res);
+            mangoh_bridge_json_destroy(&value);
             goto cleanup;
         }
     }
-    else
+    else if (res == LE_NOT_FOUND)
     {
         LE_DEBUG("key('%s') not found", key);
+        res = LE_OK;
+    }
+    else
+    {
+        LE_ERROR("ERROR mangoh_bridge_datastore_remove() failed(%d)", res);
+        goto cleanup;
     }
 
     res = mangoh_bridge_json_write(jsonRspData, &mailbox->jsonMsg, &mailbox->jsonMsgLen);
@@ -799,11 +1012,19 @@ cleanup:
         res = res ? res:err;
     }
 
+    if (mailbox->jsonMsg)
+    {
+        free(mailbox->jsonMsg);
+        mailbox->jsonMsg = NULL;
+        mailbox->jsonMsgLen = 0;
+    }
+
     return res;
 }
 
-static int mangoh_bridge_mailbox_processCommands(mangoh_bridge_mailbox_t* mailbox)
+static int mangoh_bridge_mailbox_processCommands(void* param)
 {
+    mangoh_bridge_mailbox_t* mailbox = (mangoh_bridge_mailbox_t*)param;
     mangoh_bridge_json_data_t* jsonReqData = NULL;
     int32_t res = LE_OK;
 
@@ -840,7 +1061,7 @@ static int mangoh_bridge_mailbox_processCommands(mangoh_bridge_mailbox_t* mailbo
                 if (!strcmp(command, MANGOH_BRIDGE_MAILBOX_RAW_COMMAND))
                 {
                     LE_DEBUG("--> RAW");
-                    res = mangoh_bridge_mailbox_processRawCommand(mailbox, jsonReqData);
+                    res = mangoh_bridge_mailbox_processRawCommand(mailbox, idx, jsonReqData);
                     if (res != LE_OK)
                     {
                         LE_ERROR("ERROR mangoh_bridge_mailbox_processRawCommand() failed(%d)", res);
@@ -924,150 +1145,153 @@ cleanup:
     return res;
 }
 
-static int mangoh_bridge_mailbox_runner(void* param)
+static int mangoh_bridge_mailbox_reset(void* param)
 {
     mangoh_bridge_mailbox_t* mailbox = (mangoh_bridge_mailbox_t*)param;
     int32_t res = LE_OK;
 
     LE_ASSERT(mailbox);
 
-    res = mangoh_bridge_tcp_server_acceptNewConnections(&mailbox->server, &mailbox->clients);
+    res = mangoh_bridge_tcp_client_closeAll(&mailbox->clients);
     if (res != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_tcp_server_acceptNewConnections() failed(%d)", res);
+        LE_ERROR("ERROR mangoh_bridge_tcp_client_closeAll() failed(%d)", res);
         goto cleanup;
     }
 
-    res = mangoh_bridge_tcp_client_run(&mailbox->clients);
-    if (res != LE_OK)
-    {
-        LE_ERROR("ERROR mangoh_bridge_tcp_client_run() failed(%d)", res);
-        goto cleanup;
-    }
-
-    res = mangoh_bridge_mailbox_processCommands(mailbox);
-    if (res != LE_OK)
-    {
-        LE_ERROR("ERROR mangoh_bridge_mailbox_processCommands() failed(%d)", res);
-        goto cleanup;
-    }
+    mailbox->clients.nextId = 0;
+    mailbox->clients.broadcast = 0;
 
 cleanup:
     return res;
 }
 
-static int mangoh_bridge_mailbox_reset(void* param)
+int mangoh_bridge_mailbox_init(mangoh_bridge_mailbox_t* mailbox, void* bridge)
 {
-    mangoh_bridge_mailbox_t* mailbox = (mangoh_bridge_mailbox_t*)param;
     int32_t res = LE_OK;
 
     LE_ASSERT(mailbox);
+    LE_ASSERT(bridge);
 
-    uint8_t idx = 0;
-    for (idx = 0; idx < MANGOH_BRIDGE_SOCKETS_MAX_CLIENTS; idx++)
+    LE_DEBUG("init");
+
+    mailbox->bridge = bridge;
+
+    mailbox->rxMaxBytes = MANGOH_BRIDGE_MAILBOX_RX_BUFF_SIZE;
+    const char* maxBytes = getenv(MANGOH_BRIDGE_MAILBOX_MAX_BYTES_ENV);
+    if (maxBytes)
     {
-        if (mailbox->clients.info[idx].sockFd != MANGOH_BRIDGE_SOCKETS_INVALID)
+        char* end = NULL;
+        unsigned long val = strtoul(maxBytes, &end, 0);
+        if (*end || !val || (val > MANGOH_BRIDGE_MAILBOX_RX_BUFF_MAX_SIZE))
         {
-            LE_DEBUG("close socket[%u](%d)", idx, mailbox->clients.info[idx].sockFd);
-            res = close(mailbox->clients.info[idx].sockFd);
-            if (res < 0)
-            {
-                LE_ERROR("ERROR close() failed(%d/%d)", res, errno);
-                res = LE_IO_ERROR;
-                goto cleanup;
-            }
-
-            mailbox->clients.info[idx].sockFd = MANGOH_BRIDGE_SOCKETS_INVALID;
-            mailbox->clients.info[idx].recvBuffLen = 0;
-            mailbox->clients.info[idx].sendBuffLen = 0;
+            LE_WARN("WARNING invalid %s('%s'), using(%u)", MANGOH_BRIDGE_MAILBOX_MAX_BYTES_ENV, maxBytes, mailbox->rxMaxBytes);
+        }
+        else
+        {
+            mailbox->rxMaxBytes = val;
         }
     }
 
-    mailbox->clients.nextId = 0;
-    mailbox->clients.broadcast = 0;
-    mailbox->clients.maxSockFd = 0;
-
-cleanup:
-    return res;
-}
+    const char* overflow = getenv(MANGOH_BRIDGE_MAILBOX_OVERFLOW_ENV);
+    mailbox->rxDropOldest = overflow && !strcmp(overflow, MANGOH_BRIDGE_MAILBOX_OVERFLOW_DROP);
 
-int mangoh_bridge_mailbox_init(mangoh_bridge_mailbox_t* mailbox, void* bridge)
-{
-    int32_t res = LE_OK;
+    uint32_t size = 1;
+    while (size < mailbox->rxMaxBytes)
+    {
+        size <<= 1;
+    }
 
-    LE_ASSERT(mailbox);
-    LE_ASSERT(bridge);
+    mailbox->rxBuffer = malloc(size);
+    if (!mailbox->rxBuffer)
+    {
+        LE_ERROR("ERROR malloc() failed");
+        res = LE_NO_MEMORY;
+        goto cleanup;
+    }
 
-    LE_DEBUG("init");
+    mangoh_bridge_queue_init(&mailbox->rxQueue, mailbox->rxBuffer, size);
+    LE_INFO("mailbox size(%u) %s oldest messages when full", mailbox->rxMaxBytes, mailbox->rxDropOldest ? "drop":"keep");
 
-    mailbox->bridge = bridge;
-    mailbox->database = le_hashmap_Create("Bridge Mbox", MANGOH_BRIDGE_MAILBOX_DATA_STORE_SIZE, le_hashmap_HashString, le_hashmap_EqualsString);
+    char name[MANGOH_BRIDGE_TRANSPORT_NAME_MAX_LEN] = {0};
+    mangoh_bridge_getFileName(mailbox->bridge, name, sizeof(name));
+    res = mangoh_bridge_datastore_init(&mailbox->datastore, name);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_datastore_init() failed(%d)", res);
+        goto freeBuffer;
+    }
 
     mangoh_bridge_tcp_client_init(&mailbox->clients, false);
+    mangoh_bridge_tcp_client_setRecvHandler(&mailbox->clients, mangoh_bridge_mailbox_processCommands, mailbox);
 
-    res = mangoh_bridge_tcp_server_start(&mailbox->server, MANGOH_BRIDGE_MAILBOX_SERVER_IP_ADDR, MANGOH_BRIDGE_MAILBOX_JSON_SERVER_PORT, MANGOH_BRIDGE_MAILBOX_SERVER_BACKLOG);
+    res = mangoh_bridge_tcp_server_start(&mailbox->server, &mailbox->clients, MANGOH_BRIDGE_MAILBOX_SERVER_IP_ADDR,
+            MANGOH_BRIDGE_MAILBOX_JSON_SERVER_PORT + ((mangoh_bridge_t*)bridge)->instance, MANGOH_BRIDGE_MAILBOX_SERVER_BACKLOG);
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_tcp_server_start() failed(%d)", res);
-        goto cleanup;
+        goto destroyDatastore;
     }
 
     res = mangoh_bridge_registerCommandProcessor(mailbox->bridge, MANGOH_BRIDGE_MAILBOX_SEND, mailbox, mangoh_bridge_mailbox_send);
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_registerCommandProcessor() failed(%d)", res);
-        goto cleanup;
+        goto stopServer;
     }
 
     res = mangoh_bridge_registerCommandProcessor(mailbox->bridge, MANGOH_BRIDGE_MAILBOX_SEND_JSON, mailbox, mangoh_bridge_mailbox_send_json);
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_registerCommandProcessor() failed(%d)", res);
-        goto cleanup;
+        goto stopServer;
     }
 
     res = mangoh_bridge_registerCommandProcessor(mailbox->bridge, MANGOH_BRIDGE_MAILBOX_RECV, mailbox, mangoh_bridge_mailbox_recv);
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_registerCommandProcessor() failed(%d)", res);
-        goto cleanup;
+        goto stopServer;
     }
 
     res = mangoh_bridge_registerCommandProcessor(mailbox->bridge, MANGOH_BRIDGE_MAILBOX_AVAILABLE, mailbox, mangoh_bridge_mailbox_available);
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_registerCommandProcessor() failed(%d)", res);
-        goto cleanup;
+        goto stopServer;
     }
 
     res = mangoh_bridge_registerCommandProcessor(mailbox->bridge, MANGOH_BRIDGE_MAILBOX_DATASTORE_PUT, mailbox, mangoh_bridge_mailbox_datastorePut);
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_registerCommandProcessor() failed(%d)", res);
-        goto cleanup;
+        goto stopServer;
     }
 
     res = mangoh_bridge_registerCommandProcessor(mailbox->bridge, MANGOH_BRIDGE_MAILBOX_DATASTORE_GET, mailbox, mangoh_bridge_mailbox_datastoreGet);
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_registerCommandProcessor() failed(%d)", res);
-        goto cleanup;
-    }
-
-    res = mangoh_bridge_registerRunner(mailbox->bridge, mailbox, mangoh_bridge_mailbox_runner);
-    if (res != LE_OK)
-    {
-        LE_ERROR("ERROR mangoh_bridge_registerRunner() failed(%d)", res);
-        goto cleanup;
+        goto stopServer;
     }
 
     res = mangoh_bridge_registerReset(mailbox->bridge, mailbox, mangoh_bridge_mailbox_reset);
     if (res != LE_OK)
     {
         LE_ERROR("ERROR mangoh_bridge_registerReset() failed(%d)", res);
-        goto cleanup;
+        goto stopServer;
     }
 
+    goto cleanup;
+
+stopServer:
+    mangoh_bridge_tcp_server_stop(&mailbox->server);
+    mangoh_bridge_tcp_client_destroy(&mailbox->clients);
+destroyDatastore:
+    mangoh_bridge_datastore_destroy(&mailbox->datastore);
+freeBuffer:
+    free(mailbox->rxBuffer);
+    mailbox->rxBuffer = NULL;
 cleanup:
     LE_DEBUG("init completed(%d)", res);
     return res;
@@ -1090,6 +1314,18 @@ int mangoh_bridge_mailbox_destroy(mangoh_bridge_mailbox_t* mailbox)
         LE_ERROR("ERROR mangoh_bridge_tcp_server_stop() failed(%d)", res);
     }
 
+    res = mangoh_bridge_datastore_destroy(&mailbox->datastore);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_datastore_destroy() failed(%d)", res);
+    }
+
+    free(mailbox->rxBuffer);
+    mailbox->rxBuffer = NULL;
+    mangoh_bridge_queue_init(&mailbox->rxQueue, NULL, 0);
+    mailbox->rxMsgLen = 0;
+    mailbox->rxMsgCount = 0;
+
 cleanup:
     return res;
 }
@@ -7,6 +7,12 @@
  * bridge protocol.  Callback functions are provided to support optional functionality with
  * Air Vantage.
  *
+ * Raw messages received from the JSON clients are queued whole for the MCU: 'n' returns the size of the next message
+ * and the number of queued messages, 'm' returns the next message, in several chunks when it does not fit in a frame.
+ * The queue memory is capped by BRIDGE_MAILBOX_MAX_BYTES, when full a new message is rejected or the oldest messages
+ * are dropped (BRIDGE_MAILBOX_OVERFLOW=reject|drop) and the sender is told with a "rejected" or "dropped" response.
+ * The datastore survives a restart, see datastore.h, a datastore put from the MCU is acknowledged once committed.
+ *
  * <HR>
  *
  * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
@@ -14,7 +20,9 @@
 #include "legato.h"
 #include "tcpServer.h"
 #include "tcpClient.h"
+#include "queue.h"
 #include "json.h"
+#include "datastore.h"
 
 #ifndef MANGOH_BRIDGE_MAILBOX_INCLUDE_GUARD
 #define MANGOH_BRIDGE_MAILBOX_INCLUDE_GUARD
@@ -27,9 +35,15 @@
 #define MANGOH_BRIDGE_MAILBOX_DATASTORE_GET                   'd'
 
 #define MANGOH_BRIDGE_MAILBOX_SERVER_IP_ADDR                  "127.0.0.1"
-#define MANGOH_BRIDGE_MAILBOX_JSON_SERVER_PORT                "5700"
+#define MANGOH_BRIDGE_MAILBOX_JSON_SERVER_PORT                5700
 #define MANGOH_BRIDGE_MAILBOX_SERVER_BACKLOG                  5
 #define MANGOH_BRIDGE_MAILBOX_RX_BUFF_SIZE                    0x4000
+#define MANGOH_BRIDGE_MAILBOX_RX_BUFF_MAX_SIZE                0x100000
+#define MANGOH_BRIDGE_MAILBOX_MAX_BYTES_ENV                   "BRIDGE_MAILBOX_MAX_BYTES"
+#define MANGOH_BRIDGE_MAILBOX_OVERFLOW_ENV                    "BRIDGE_MAILBOX_OVERFLOW"
+#define MANGOH_BRIDGE_MAILBOX_OVERFLOW_DROP                   "drop"
+#define MANGOH_BRIDGE_MAILBOX_RAW_REJECTED                    "rejected"
+#define MANGOH_BRIDGE_MAILBOX_RAW_DROPPED                     "dropped"
 
 #define MANGOH_BRIDGE_MAILBOX_GET_WILDCARD                    "*"
 #define MANGOH_BRIDGE_MAILBOX_RAW_COMMAND                     "raw"
@@ -38,7 +52,6 @@
 #define MANGOH_BRIDGE_MAILBOX_DELETE_COMMAND                  "delete"
 
 #define MANGOH_BRIDGE_MAILBOX_SEPARATOR                        0xFE
-#define MANGOH_BRIDGE_MAILBOX_DATA_STORE_SIZE                  31
 #define MANGOH_BRIDGE_MAILBOX_DATASTORE_KEY_IDX                0
 #define MANGOH_BRIDGE_MAILBOX_DATASTORE_VALUE_IDX              1
 #define MANGOH_BRIDGE_MAILBOX_DATASTORE_PARAMS                 2
@@ -81,6 +94,7 @@ typedef struct _mangoh_bridge_mailbox_recv_rsp_t
 typedef struct _mangoh_bridge_mailbox_available_rsp_t
 {
     uint16_t len;
+    uint16_t count;
 } __attribute__((packed)) mangoh_bridge_mailbox_available_rsp_t;
 
 typedef struct _mangoh_bridge_mailbox_datastore_put_rsp_t
@@ -100,14 +114,18 @@ typedef struct _mangoh_bridge_mailbox_datastore_get_rsp_t
 //--------------------------------------------------------------------------------------------------
 typedef struct _mangoh_bridge_mailbox_t
 {
-    int8_t                     rxBuffer[MANGOH_BRIDGE_MAILBOX_RX_BUFF_SIZE]; ///< Receive buffer
-    mangoh_bridge_tcp_server_t server;                                       ///< Server module
-    mangoh_bridge_tcp_client_t clients;                                      ///< Clients
-    le_hashmap_Ref_t           database;                                     ///< Datastore data
-    void*                      bridge;                                       ///< Bridge module
-    uint8_t*                   jsonMsg;                                      ///< JSON message
-    uint32_t                   rxBuffLen;                                    ///< Number of bytes in Rx buffer
-    uint32_t                   jsonMsgLen;                                   ///< JSON message length
+    mangoh_bridge_queue_t      rxQueue;      ///< Received messages waiting for the MCU, each after its length
+    mangoh_bridge_tcp_server_t server;       ///< Server module
+    mangoh_bridge_tcp_client_t clients;      ///< Clients
+    mangoh_bridge_datastore_t  datastore;    ///< Datastore data
+    void*                      bridge;       ///< Bridge module
+    uint8_t*                   rxBuffer;     ///< Receive queue storage
+    uint8_t*                   jsonMsg;      ///< JSON message
+    uint32_t                   jsonMsgLen;   ///< JSON message length
+    uint32_t                   rxMsgLen;     ///< Unread bytes of the first message, its length is not in the queue
+    uint32_t                   rxMsgCount;   ///< Number of queued messages
+    uint32_t                   rxMaxBytes;   ///< Receive queue memory cap
+    bool                       rxDropOldest; ///< Drop the oldest messages rather than reject a new one when full
 } mangoh_bridge_mailbox_t;
 
 int mangoh_bridge_mailbox_init(mangoh_bridge_mailbox_t*, void*);
@@ -10,7 +10,23 @@
 #include "packet.h"
 #include "bridge.h"
 
-unsigned short mangoh_bridge_packet_crcUpdate(unsigned short crc, const unsigned char* data, unsigned int len)
+static unsigned short mangoh_bridge_packet_crcUpdateTable(unsigned short, const unsigned char*, unsigned int);
+static unsigned short mangoh_bridge_packet_crcUpdateSlice4(unsigned short, const unsigned char*, unsigned int);
+static unsigned short mangoh_bridge_packet_crcUpdateSlice8(unsigned short, const unsigned char*, unsigned int);
+static int mangoh_bridge_packet_crcSelfTest(mangoh_bridge_packet_crc_func_t);
+
+static uint16_t mangoh_bridge_packet_crcTable[MANGOH_BRIDGE_PACKET_CRC_SLICES][MANGOH_BRIDGE_PACKET_CRC_TABLE_SIZE];
+static mangoh_bridge_packet_crc_func_t mangoh_bridge_packet_crcFunc = mangoh_bridge_packet_crcUpdateBitwise;
+
+static const mangoh_bridge_packet_crc_func_t mangoh_bridge_packet_crcEngines[] =
+{
+    [MANGOH_BRIDGE_PACKET_CRC_BITWISE]    = mangoh_bridge_packet_crcUpdateBitwise,
+    [MANGOH_BRIDGE_PACKET_CRC_TABLE]      = mangoh_bridge_packet_crcUpdateTable,
+    [MANGOH_BRIDGE_PACKET_CRC_SLICE_BY_4] = mangoh_bridge_packet_crcUpdateSlice4,
+    [MANGOH_BRIDGE_PACKET_CRC_SLICE_BY_8] = mangoh_bridge_packet_crcUpdateSlice8,
+};
+
+unsigned short mangoh_bridge_packet_crcUpdateBitwise(unsigned short crc, const unsigned char* data, unsigned int len)
 {
     unsigned char* ptr = (unsigned char*)data;
     unsigned int idx = 0;
@@ -30,25 +46,171 @@ unsigned short mangoh_bridge_packet_crcUpdate(unsigned short crc, const unsigned
     return crc;
 }
 
+static unsigned short mangoh_bridge_packet_crcUpdateTable(unsigned short crc, const unsigned char* data, unsigned int len)
+{
+    const uint16_t* table = mangoh_bridge_packet_crcTable[0];
+    const unsigned char* ptr = data;
+
+    LE_ASSERT(data);
+
+    while (len--)
+    {
+        crc = table[(crc ^ *ptr++) & 0xFF] ^ (crc >> 8);
+    }
+
+    return crc;
+}
+
+static unsigned short mangoh_bridge_packet_crcUpdateSlice4(unsigned short crc, const unsigned char* data, unsigned int len)
+{
+    const uint16_t (*table)[MANGOH_BRIDGE_PACKET_CRC_TABLE_SIZE] = (const uint16_t (*)[MANGOH_BRIDGE_PACKET_CRC_TABLE_SIZE])mangoh_bridge_packet_crcTable;
+    const unsigned char* ptr = data;
+
+    LE_ASSERT(data);
+
+    // The 16-bit CRC only overlaps the first two bytes of each block
+    for (; len >= 4; len -= 4, ptr += 4)
+    {
+        crc = table[3][(ptr[0] ^ crc) & 0xFF] ^ table[2][(ptr[1] ^ (crc >> 8)) & 0xFF] ^
+              table[1][ptr[2]] ^ table[0][ptr[3]];
+    }
+
+    return mangoh_bridge_packet_crcUpdateTable(crc, ptr, len);
+}
+
+static unsigned short mangoh_bridge_packet_crcUpdateSlice8(unsigned short crc, const unsigned char* data, unsigned int len)
+{
+    const uint16_t (*table)[MANGOH_BRIDGE_PACKET_CRC_TABLE_SIZE] = (const uint16_t (*)[MANGOH_BRIDGE_PACKET_CRC_TABLE_SIZE])mangoh_bridge_packet_crcTable;
+    const unsigned char* ptr = data;
+
+    LE_ASSERT(data);
+
+    for (; len >= 8; len -= 8, ptr += 8)
+    {
+        crc = table[7][(ptr[0] ^ crc) & 0xFF] ^ table[6][(ptr[1] ^ (crc >> 8)) & 0xFF] ^
+              table[5][ptr[2]] ^ table[4][ptr[3]] ^ table[3][ptr[4]] ^ table[2][ptr[5]] ^
+              table[1][ptr[6]] ^ table[0][ptr[7]];
+    }
+
+    return mangoh_bridge_packet_crcUpdateSlice4(crc, ptr, len);
+}
+
+static int mangoh_bridge_packet_crcSelfTest(mangoh_bridge_packet_crc_func_t crcFunc)
+{
+    unsigned char buff[MANGOH_BRIDGE_PACKET_CRC_TEST_SIZE] = {0};
+    unsigned int idx = 0;
+    unsigned int len = 0;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(crcFunc);
+
+    for (idx = 0; idx < sizeof(buff); idx++)
+    {
+        buff[idx] = (idx * 167 + 13) & 0xFF;
+    }
+
+    // Cover every tail length and unaligned start so all slice/table paths are exercised
+    for (idx = 0; idx < 8; idx++)
+    {
+        for (len = 0; len <= sizeof(buff) - idx; len++)
+        {
+            unsigned short expected = mangoh_bridge_packet_crcUpdateBitwise(MANGOH_BRIDGE_PACKET_CRC_RESET, &buff[idx], len);
+            unsigned short crc = crcFunc(MANGOH_BRIDGE_PACKET_CRC_RESET, &buff[idx], len);
+            if (crc != expected)
+            {
+                LE_ERROR("ERROR CRC mismatch offset(%u) length(%u) (0x%04x != 0x%04x)", idx, len, crc, expected);
+                res = LE_FAULT;
+                goto cleanup;
+            }
+        }
+    }
+
+cleanup:
+    return res;
+}
+
+int mangoh_bridge_packet_crcInit(mangoh_bridge_packet_crc_engine_t engine)
+{
+    unsigned int idx = 0;
+    unsigned int slice = 0;
+    int32_t res = LE_OK;
+
+    for (idx = 0; idx < MANGOH_BRIDGE_PACKET_CRC_TABLE_SIZE; idx++)
+    {
+        unsigned char val = idx;
+        mangoh_bridge_packet_crcTable[0][idx] = mangoh_bridge_packet_crcUpdateBitwise(0, &val, sizeof(val));
+    }
+
+    for (slice = 1; slice < MANGOH_BRIDGE_PACKET_CRC_SLICES; slice++)
+    {
+        for (idx = 0; idx < MANGOH_BRIDGE_PACKET_CRC_TABLE_SIZE; idx++)
+        {
+            uint16_t prev = mangoh_bridge_packet_crcTable[slice - 1][idx];
+            mangoh_bridge_packet_crcTable[slice][idx] = mangoh_bridge_packet_crcTable[0][prev & 0xFF] ^ (prev >> 8);
+        }
+    }
+
+    res = mangoh_bridge_packet_crcSelect(engine);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_packet_crcSelect() failed(%d)", res);
+        goto cleanup;
+    }
+
+cleanup:
+    return res;
+}
+
+int mangoh_bridge_packet_crcSelect(mangoh_bridge_packet_crc_engine_t engine)
+{
+    int32_t res = LE_OK;
+
+    if (engine >= NUM_ARRAY_MEMBERS(mangoh_bridge_packet_crcEngines))
+    {
+        LE_ERROR("ERROR invalid CRC engine(%d)", engine);
+        res = LE_BAD_PARAMETER;
+        goto cleanup;
+    }
+
+    res = mangoh_bridge_packet_crcSelfTest(mangoh_bridge_packet_crcEngines[engine]);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR CRC engine(%d) self-test failed(%d), using bitwise CRC", engine, res);
+        mangoh_bridge_packet_crcFunc = mangoh_bridge_packet_crcUpdateBitwise;
+        goto cleanup;
+    }
+
+    LE_INFO("CRC engine(%d)", engine);
+    mangoh_bridge_packet_crcFunc = mangoh_bridge_packet_crcEngines[engine];
+
+cleanup:
+    return res;
+}
+
+unsigned short mangoh_bridge_packet_crcUpdate(unsigned short crc, const unsigned char* data, unsigned int len)
+{
+    return mangoh_bridge_packet_crcFunc(crc, data, len);
+}
+
 void mangoh_bridge_packet_initResponse(mangoh_bridge_packet_t* packet, uint32_t len)
 {
     LE_ASSERT(packet);
 
     le_log_TraceRef_t traceRef = mangoh_bridge_getTraceRef();
 
-    packet->msg.start = MANGOH_BRIDGE_PACKET_START;
-    packet->msg.crc = MANGOH_BRIDGE_PACKET_CRC_RESET;
-    packet->msg.len = htons(len);
+    packet->tx.start = MANGOH_BRIDGE_PACKET_START;
+    packet->tx.crc = MANGOH_BRIDGE_PACKET_CRC_RESET;
+    packet->tx.len = htons(len);
 
-    packet->msg.crc = mangoh_bridge_packet_crcUpdate(packet->msg.crc, &packet->msg.start, sizeof(packet->msg.start));
-    LE_TRACE(traceRef, "message index(%u)", packet->msg.idx);
-    packet->msg.crc = mangoh_bridge_packet_crcUpdate(packet->msg.crc, &packet->msg.idx, sizeof(packet->msg.idx));
+    packet->tx.crc = mangoh_bridge_packet_crcUpdate(packet->tx.crc, &packet->tx.start, sizeof(packet->tx.start));
+    LE_TRACE(traceRef, "message index(%u)", packet->tx.idx);
+    packet->tx.crc = mangoh_bridge_packet_crcUpdate(packet->tx.crc, &packet->tx.idx, sizeof(packet->tx.idx));
 
     LE_TRACE(traceRef, "payload length(%u)", len);
-    packet->msg.crc = mangoh_bridge_packet_crcUpdate(packet->msg.crc, (unsigned char*)&packet->msg.len, sizeof(packet->msg.len));
+    packet->tx.crc = mangoh_bridge_packet_crcUpdate(packet->tx.crc, (unsigned char*)&packet->tx.len, sizeof(packet->tx.len));
 
-    packet->msg.crc = len ? mangoh_bridge_packet_crcUpdate(packet->msg.crc, packet->msg.data, len):packet->msg.crc;
-    packet->msg.crc = htons(packet->msg.crc);
+    packet->tx.crc = len ? mangoh_bridge_packet_crcUpdate(packet->tx.crc, packet->tx.data, len):packet->tx.crc;
+    packet->tx.crc = htons(packet->tx.crc);
 }
 
 void mangoh_bridge_packet_dumpBuffer(const unsigned char* buff, unsigned int len)
@@ -16,20 +16,48 @@
 #define MANGOH_BRIDGE_PACKET_INCLUDE_GUARD
 
 #define MANGOH_BRIDGE_PACKET_CMD_SIZE             sizeof(uint8_t)
-#define MANGOH_BRIDGE_PACKET_DATA_SIZE            128
+#define MANGOH_BRIDGE_PACKET_DATA_SIZE            4096
+#define MANGOH_BRIDGE_PACKET_DATA_SIZE_DEFAULT    128
+#define MANGOH_BRIDGE_PACKET_DATA_SIZE_LEN        sizeof(uint16_t)
 
 #define MANGOH_BRIDGE_PACKET_CRC_RESET            0xFFFF
+#define MANGOH_BRIDGE_PACKET_CRC_TABLE_SIZE       256
+#define MANGOH_BRIDGE_PACKET_CRC_SLICES           8
+#define MANGOH_BRIDGE_PACKET_CRC_TEST_SIZE        64
 #define MANGOH_BRIDGE_PACKET_START                0xFF
 #define MANGOH_BRIDGE_PACKET_ACK                  0x00
 #define MANGOH_BRIDGE_PACKET_NACK                 0xFF
 
 #define MANGOH_BRIDGE_PACKET_VERSION              {'1','0','0'}
+#define MANGOH_BRIDGE_PACKET_VERSION_LARGE        {'2','0','0'}
 #define MANGOH_BRIDGE_PACKET_VERSION_SIZE         3
 #define MANGOH_BRIDGE_PACKET_RESET                {'X','X'}
 #define MANGOH_BRIDGE_PACKET_RESET_SIZE           2
+#define MANGOH_BRIDGE_PACKET_BAUD_SIZE            sizeof(uint32_t)
+#define MANGOH_BRIDGE_PACKET_WINDOW_SIZE          sizeof(uint8_t)
+#define MANGOH_BRIDGE_PACKET_CODEC_SIZE           sizeof(uint8_t)
 #define MANGOH_BRIDGE_PACKET_CLOSE                {'X','X','X','X','X'}
 #define MANGOH_BRIDGE_PACKET_CLOSE_SIZE           5
 
+#ifndef MANGOH_BRIDGE_PACKET_CRC_ENGINE
+#define MANGOH_BRIDGE_PACKET_CRC_ENGINE           MANGOH_BRIDGE_PACKET_CRC_SLICE_BY_8
+#endif
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Bridge packet CRC implementations, all produce the same Yun CRC-16
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef enum _mangoh_bridge_packet_crc_engine_t
+{
+    MANGOH_BRIDGE_PACKET_CRC_BITWISE = 0, ///< Reference bit-twiddling implementation
+    MANGOH_BRIDGE_PACKET_CRC_TABLE,       ///< 256-entry table, one byte per step
+    MANGOH_BRIDGE_PACKET_CRC_SLICE_BY_4,  ///< Four tables, four bytes per step
+    MANGOH_BRIDGE_PACKET_CRC_SLICE_BY_8,  ///< Eight tables, eight bytes per step
+} mangoh_bridge_packet_crc_engine_t;
+
+typedef unsigned short (*mangoh_bridge_packet_crc_func_t)(unsigned short, const unsigned char*, unsigned int);
+
 //------------------------------------------------------------------------------------------------------------------
 /**
  * Bridge packet data
@@ -52,24 +80,33 @@ typedef struct _mangoh_bridge_packet_msg_t
     uint8_t  idx;                                  ///< Packet index
     uint16_t len;                                  ///< Packet length
     uint8_t  data[MANGOH_BRIDGE_PACKET_DATA_SIZE]; ///< Packet data
-    uint16_t crc;                                  ///< Rx 16-bit CRC
+    uint16_t crc;                                  ///< Packet 16-bit CRC
 } mangoh_bridge_packet_msg_t;
 
 //------------------------------------------------------------------------------------------------------------------
 /**
  * Brdige packet
+ *
+ * Requests are decoded into rx while responses are built in tx, a command processor can read its request while writing
+ * its response and the next frame is decoded while earlier responses are still queued for transmission.
  */
 //------------------------------------------------------------------------------------------------------------------
 typedef struct _mangoh_bridge_packet_t
 {
-    mangoh_bridge_packet_msg_t msg;                                        ///< Bridge packet
-    unsigned char              version[MANGOH_BRIDGE_PACKET_VERSION_SIZE]; ///< Bridge version
-    unsigned char              reset[MANGOH_BRIDGE_PACKET_RESET_SIZE];     ///< Reset packet
-    unsigned char              close[MANGOH_BRIDGE_PACKET_CLOSE_SIZE];     ///< Close packet
-    unsigned short             crc;                                        ///< Calculated 16-bit CRC
+    mangoh_bridge_packet_msg_t rx;                                              ///< Received request
+    mangoh_bridge_packet_msg_t tx;                                              ///< Response being built
+    unsigned char              version[MANGOH_BRIDGE_PACKET_VERSION_SIZE];      ///< Bridge version
+    unsigned char              versionLarge[MANGOH_BRIDGE_PACKET_VERSION_SIZE]; ///< Bridge version with negotiated payload size
+    unsigned char              reset[MANGOH_BRIDGE_PACKET_RESET_SIZE];          ///< Reset packet
+    unsigned char              close[MANGOH_BRIDGE_PACKET_CLOSE_SIZE];          ///< Close packet
+    unsigned short             crc;                                             ///< Calculated 16-bit CRC
+    uint16_t                   dataSize;                                        ///< Negotiated maximum payload size
 } mangoh_bridge_packet_t;
 
+int mangoh_bridge_packet_crcInit(mangoh_bridge_packet_crc_engine_t);
+int mangoh_bridge_packet_crcSelect(mangoh_bridge_packet_crc_engine_t);
 unsigned short mangoh_bridge_packet_crcUpdate(unsigned short, const unsigned char*, unsigned int);
+unsigned short mangoh_bridge_packet_crcUpdateBitwise(unsigned short, const unsigned char*, unsigned int);
 void mangoh_bridge_packet_initResponse(mangoh_bridge_packet_t*, uint32_t);
 void mangoh_bridge_packet_dumpBuffer(const unsigned char*, unsigned int);
 
@@ -7,11 +7,22 @@
  */
 
 #include <arpa/inet.h>
+#include <sys/wait.h>
 #include "legato.h"
 #include "utils.h"
 #include "processes.h"
 #include "bridge.h"
 
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Deferred wait, completed from the SIGCHLD handler on the event loop when the child exits
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_processes_wait_t
+{
+    mangoh_bridge_pending_t pending; ///< Deferred response
+} mangoh_bridge_processes_wait_t;
+
 static int mangoh_bridge_processes_run(void*, const unsigned char*, uint32_t);
 static int mangoh_bridge_processes_running(void*, const unsigned char*, uint32_t);
 static int mangoh_bridge_processes_wait(void*, const unsigned char*, uint32_t);
@@ -20,7 +31,10 @@ static int mangoh_bridge_processes_readOutput(void*, const unsigned char*, uint3
 static int mangoh_bridge_processes_availableOutput(void*, const unsigned char*, uint32_t);
 static int mangoh_bridge_processes_writeInput(void*, const unsigned char*, uint32_t);
 
+static void mangoh_bridge_processes_waitDone(mangoh_bridge_processes_t*, uint8_t);
+
 static int mangoh_bridge_processes_close(mangoh_bridge_process_t*);
+static int mangoh_bridge_processes_readPipe(mangoh_bridge_process_t*);
 static int mangoh_bridge_processes_reset(void*);
 
 static int mangoh_bridge_processes_close(mangoh_bridge_process_t* process)
@@ -46,8 +60,10 @@ static int mangoh_bridge_processes_close(mangoh_bridge_process_t* process)
     process->outfp = MANGOH_BRIDGE_PROCESSES_INVALID_FILE;
 
     process->pid = MANGOH_BRIDGE_PROCESSES_INVALID_PID;
-    process->outputBuffLen = 0;
+    mangoh_bridge_queue_clear(&process->outputQueue);
     process->status = 0;
+    free(process->wait);
+    process->wait = NULL;
 
     res = LE_OK;
 
@@ -55,6 +71,36 @@ cleanup:
     return res;
 }
 
+static int mangoh_bridge_processes_readPipe(mangoh_bridge_process_t* process)
+{
+    struct iovec iov[MANGOH_BRIDGE_QUEUE_NUM_IOVS];
+    int32_t res = LE_OK;
+
+    LE_ASSERT(process);
+
+    LE_DEBUG("output length(%u)", mangoh_bridge_queue_len(&process->outputQueue));
+    int iovcnt = mangoh_bridge_queue_writeIov(&process->outputQueue, iov);
+    if (!iovcnt)
+    {
+        goto cleanup;
+    }
+
+    ssize_t bytesRead = readv(process->outfp, iov, iovcnt);
+    LE_DEBUG("outfp(%d) read(%zd)", process->outfp, bytesRead);
+    if (bytesRead < 0)
+    {
+        LE_ERROR("ERROR read() failed(%zd/%d)", bytesRead, errno);
+        res = LE_IO_ERROR;
+        goto cleanup;
+    }
+
+    mangoh_bridge_queue_produce(&process->outputQueue, bytesRead);
+    LE_DEBUG("output length(%u)", mangoh_bridge_queue_len(&process->outputQueue));
+
+cleanup:
+    return res;
+}
+
 static int mangoh_bridge_processes_run(void* param, const unsigned char* data, uint32_t size)
 {
     mangoh_bridge_processes_t* processes = (mangoh_bridge_processes_t*)param;
@@ -78,7 +124,7 @@ static int mangoh_bridge_processes_run(void* param, const unsigned char* data, u
         token = strtok(NULL, search);
     }
 
-    mangoh_bridge_process_run_rsp_t* const rsp = (mangoh_bridge_process_run_rsp_t*)((mangoh_bridge_t*)processes->bridge)->packet.msg.data;
+    mangoh_bridge_process_run_rsp_t* const rsp = (mangoh_bridge_process_run_rsp_t*)((mangoh_bridge_t*)processes->bridge)->packet.tx.data;
 
     processes->list[processes->nextId].pid = popen2((char**)&cmdLine,
             &processes->list[processes->nextId].infp, &processes->list[processes->nextId].outfp);
@@ -119,7 +165,7 @@ static int mangoh_bridge_processes_running(void* param, const unsigned char* dat
     const mangoh_bridge_process_running_req_t* const req = (mangoh_bridge_process_running_req_t*)data;
     LE_DEBUG("---> RUNNING(%u)", req->id);
 
-    mangoh_bridge_process_running_rsp_t* const rsp = (mangoh_bridge_process_running_rsp_t*)((mangoh_bridge_t*)processes->bridge)->packet.msg.data;
+    mangoh_bridge_process_running_rsp_t* const rsp = (mangoh_bridge_process_running_rsp_t*)((mangoh_bridge_t*)processes->bridge)->packet.tx.data;
 
     if ((req->id >= MANGOH_BRIDGE_PROCESSES_NUM_IDS) || (processes->list[req->id].pid != MANGOH_BRIDGE_PROCESSES_INVALID_PID))
     {
@@ -176,6 +222,64 @@ cleanup:
     return res;
 }
 
+static void mangoh_bridge_processes_waitDone(mangoh_bridge_processes_t* processes, uint8_t id)
+{
+    mangoh_bridge_processes_wait_t* waiter = NULL;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(processes);
+
+    mangoh_bridge_process_t* process = &processes->list[id];
+    res = waitpid(process->pid, &process->status, WNOHANG);
+    if (!res)
+    {
+        goto cleanup;
+    }
+
+    waiter = process->wait;
+    process->wait = NULL;
+    if ((res < 0) || !WIFEXITED(process->status))
+    {
+        LE_ERROR("ERROR waitpid() process[%u](%u) failed(%d/%d) status(0x%x)", id, process->pid, res, errno, process->status);
+
+        res = mangoh_bridge_completeNack(processes->bridge, &waiter->pending);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_completeNack() failed(%d)", res);
+        }
+
+        goto cleanup;
+    }
+
+    int16_t exitCode = WEXITSTATUS(process->status);
+    LE_DEBUG("process[%u](%u) exit(%d)", id, process->pid, exitCode);
+    mangoh_bridge_process_wait_rsp_t rsp = { .exitCode = htons(exitCode) };
+    res = mangoh_bridge_completeResult(processes->bridge, &waiter->pending, &rsp, sizeof(rsp));
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_completeResult() failed(%d)", res);
+        goto cleanup;
+    }
+
+cleanup:
+    free(waiter);
+}
+
+void mangoh_bridge_processes_childExited(mangoh_bridge_processes_t* processes)
+{
+    LE_ASSERT(processes);
+
+    // SIGCHLD is not queued per child, every process waited for is checked
+    uint32_t idx = 0;
+    for (idx = 0; idx < MANGOH_BRIDGE_PROCESSES_NUM_IDS; idx++)
+    {
+        if (processes->list[idx].wait)
+        {
+            mangoh_bridge_processes_waitDone(processes, idx);
+        }
+    }
+}
+
 static int mangoh_bridge_processes_wait(void* param, const unsigned char* data, uint32_t size)
 {
     mangoh_bridge_processes_t* processes = (mangoh_bridge_processes_t*)param;
@@ -189,23 +293,33 @@ static int mangoh_bridge_processes_wait(void* param, const unsigned char* data,
 
     if ((req->id >= MANGOH_BRIDGE_PROCESSES_NUM_IDS) || (processes->list[req->id].pid != MANGOH_BRIDGE_PROCESSES_INVALID_PID))
     {
-        mangoh_bridge_process_wait_rsp_t* const rsp = (mangoh_bridge_process_wait_rsp_t*)((mangoh_bridge_t*)processes->bridge)->packet.msg.data;
-
         LE_DEBUG("wait process[%u](%u)", req->id, processes->list[req->id].pid);
         if (!WIFEXITED(processes->list[req->id].status))
         {
-            do
+            mangoh_bridge_process_t* process = &processes->list[req->id];
+            if (process->wait)
             {
-                res = waitpid(processes->list[req->id].pid, &processes->list[req->id].status, 0);
-                if (res < 0)
-                {
-                    LE_ERROR("ERROR waitpid() failed(%d/%d)", res, errno);
-                    res = LE_FAULT;
-                    goto cleanup;
-                }
-            } while (!WIFEXITED(processes->list[req->id].status));
+                LE_WARN("WARNING process[%u](%u) already waited for", req->id, process->pid);
+                mangoh_bridge_completeNack(processes->bridge, &process->wait->pending);
+                free(process->wait);
+                process->wait = NULL;
+            }
+
+            process->wait = calloc(1, sizeof(mangoh_bridge_processes_wait_t));
+            if (!process->wait)
+            {
+                LE_ERROR("ERROR calloc() failed");
+                res = LE_NO_MEMORY;
+                goto cleanup;
+            }
+
+            // Completed from the SIGCHLD handler, the child may also have exited before the request
+            mangoh_bridge_deferResult(processes->bridge, &process->wait->pending);
+            mangoh_bridge_processes_waitDone(processes, req->id);
+            goto cleanup;
         }
 
+        mangoh_bridge_process_wait_rsp_t* const rsp = (mangoh_bridge_process_wait_rsp_t*)((mangoh_bridge_t*)processes->bridge)->packet.tx.data;
         int16_t exitCode = WEXITSTATUS(processes->list[req->id].status);
         LE_DEBUG("process[%u](%u) exit(%d)", req->id, processes->list[req->id].pid, exitCode);
         rsp->exitCode = htons(exitCode);
@@ -306,31 +420,20 @@ static int mangoh_bridge_processes_readOutput(void* param, const unsigned char*
         uint8_t id = req->id;
         uint8_t reqLen = req->len;
 
-        LE_DEBUG("outputBuffLen(%u)", processes->list[id].outputBuffLen);
-        ssize_t bytesRead = read(processes->list[id].outfp,
-                &processes->list[id].outputBuff[processes->list[id].outputBuffLen],
-                sizeof(processes->list[id].outputBuff) - processes->list[id].outputBuffLen);
-        LE_DEBUG("outfp(%d) read(%zd)", processes->list[id].outfp, bytesRead);
-        if (bytesRead < 0)
+        res = mangoh_bridge_processes_readPipe(&processes->list[id]);
+        if (res != LE_OK)
         {
-            LE_ERROR("ERROR read() failed(%zd/%d)", bytesRead, errno);
-            res = LE_IO_ERROR;
+            LE_ERROR("ERROR mangoh_bridge_processes_readPipe() failed(%d)", res);
             goto cleanup;
         }
 
-        processes->list[id].outputBuffLen += bytesRead;
-        LE_DEBUG("outputBuffLen(%u)", processes->list[id].outputBuffLen);
-
-        if (processes->list[id].outputBuffLen)
+        if (mangoh_bridge_queue_len(&processes->list[id].outputQueue))
         {
-            mangoh_bridge_process_read_output_rsp_t* const rsp = (mangoh_bridge_process_read_output_rsp_t*)((mangoh_bridge_t*)processes->bridge)->packet.msg.data;
-
-            len = (processes->list[id].outputBuffLen > reqLen) ? reqLen:processes->list[id].outputBuffLen;
-            LE_DEBUG("len(%zu)", len);
-            memcpy(rsp->data, processes->list[id].outputBuff, len);
-            memmove(processes->list[id].outputBuff, &processes->list[id].outputBuff[len], processes->list[id].outputBuffLen - len);
-            processes->list[id].outputBuffLen -= len;
-            LE_DEBUG("outputBuffLen(%u)", processes->list[id].outputBuffLen);
+            mangoh_bridge_process_read_output_rsp_t* const rsp = (mangoh_bridge_process_read_output_rsp_t*)((mangoh_bridge_t*)processes->bridge)->packet.tx.data;
+
+            const uint32_t maxLen = ((mangoh_bridge_t*)processes->bridge)->packet.dataSize;
+            len = mangoh_bridge_queue_read(&processes->list[id].outputQueue, rsp->data, (reqLen > maxLen) ? maxLen:reqLen);
+            LE_DEBUG("len(%zu) output length(%u)", len, mangoh_bridge_queue_len(&processes->list[id].outputQueue));
         }
 
         res = mangoh_bridge_sendResult(processes->bridge, len);
@@ -362,23 +465,18 @@ static int mangoh_bridge_processes_availableOutput(void* param, const unsigned c
     const mangoh_bridge_process_available_output_req_t* const req = (mangoh_bridge_process_available_output_req_t*)data;
     LE_INFO("---> AVAILABLE OUTPUT(%u)", req->id);
 
-    mangoh_bridge_process_avail_output_rsp_t* const rsp = (mangoh_bridge_process_avail_output_rsp_t*)((mangoh_bridge_t*)processes->bridge)->packet.msg.data;
+    mangoh_bridge_process_avail_output_rsp_t* const rsp = (mangoh_bridge_process_avail_output_rsp_t*)((mangoh_bridge_t*)processes->bridge)->packet.tx.data;
 
     if ((req->id >= MANGOH_BRIDGE_PROCESSES_NUM_IDS) || (processes->list[req->id].pid != MANGOH_BRIDGE_PROCESSES_INVALID_PID))
     {
-        ssize_t bytesRead = read(processes->list[req->id].outfp,
-                &processes->list[req->id].outputBuff[processes->list[req->id].outputBuffLen],
-                sizeof(processes->list[req->id].outputBuff) - processes->list[req->id].outputBuffLen);
-        LE_DEBUG("outfp(%d) read(%zd)", processes->list[req->id].outfp, bytesRead);
-        if (bytesRead < 0)
+        res = mangoh_bridge_processes_readPipe(&processes->list[req->id]);
+        if (res != LE_OK)
         {
-            LE_ERROR("ERROR read() failed(%zd/%d)", bytesRead, errno);
-            res = LE_IO_ERROR;
+            LE_ERROR("ERROR mangoh_bridge_processes_readPipe() failed(%d)", res);
             goto cleanup;
         }
 
-        processes->list[req->id].outputBuffLen += bytesRead;
-        rsp->len = processes->list[req->id].outputBuffLen;
+        rsp->len = mangoh_bridge_queue_len(&processes->list[req->id].outputQueue);
     }
     else
     {
@@ -465,7 +563,7 @@ static int mangoh_bridge_processes_reset(void* param)
             }
         }
 
-        memset(processes->list[idx].outputBuff, 0, sizeof(processes->list[idx].outputBuff));
+        mangoh_bridge_queue_clear(&processes->list[idx].outputQueue);
     }
 
 cleanup:
@@ -487,6 +585,7 @@ int mangoh_bridge_processes_init(mangoh_bridge_processes_t* processes, void* bri
         processes->list[idx].pid = MANGOH_BRIDGE_PROCESSES_INVALID_PID;
         processes->list[idx].infp = MANGOH_BRIDGE_PROCESSES_INVALID_FILE;
         processes->list[idx].outfp = MANGOH_BRIDGE_PROCESSES_INVALID_FILE;
+        mangoh_bridge_queue_init(&processes->list[idx].outputQueue, processes->list[idx].outputBuff, sizeof(processes->list[idx].outputBuff));
     }
 
     processes->bridge = bridge;
@@ -11,6 +11,7 @@
  * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
  */
 #include "packet.h"
+#include "queue.h"
 
 #ifndef MANGOH_BRIDGE_PROCESSES_INCLUDE_GUARD
 #define MANGOH_BRIDGE_PROCESSES_INCLUDE_GUARD
@@ -30,6 +31,7 @@
 #define MANGOH_BRIDGE_PROCESSES_CMD_LINE_MAX_LEN         128
 #define MANGOH_BRIDGE_PROCESSES_CMD_LINE_MAX_ARGS        64
 #define MANGOH_BRIDGE_PROCESSES_WRITE_INPUT_BUFF_LEN    (MANGOH_BRIDGE_PACKET_DATA_SIZE - sizeof(int8_t))
+#define MANGOH_BRIDGE_PROCESSES_OUTPUT_BUFF_LEN         (UINT8_MAX + 1)
 #define MANGOH_BRIDGE_PROCESSES_SEPARATOR                0xFE
 
 typedef struct _mangoh_bridge_process_run_req_t
@@ -102,12 +104,13 @@ typedef struct _mangoh_bridge_process_avail_output_rsp_t
 //------------------------------------------------------------------------------------------------------------------
 typedef struct _mangoh_bridge_process_t
 {
-    uint8_t  outputBuff[MANGOH_BRIDGE_PACKET_DATA_SIZE]; ///< Output buffer
-    pid_t    pid;                                        ///< Process ID
-    int32_t  status;                                     ///< Process exit status
-    int32_t  infp;                                       ///< Process stdin
-    int32_t  outfp;                                      ///< Process stdout
-    uint32_t outputBuffLen;                              ///< Number of bytes in output buffer
+    uint8_t                                 outputBuff[MANGOH_BRIDGE_PROCESSES_OUTPUT_BUFF_LEN]; ///< Output buffer
+    mangoh_bridge_queue_t                   outputQueue;                                         ///< Output not read by the MCU yet
+    struct _mangoh_bridge_processes_wait_t* wait;                                                ///< Deferred wait, NULL if none
+    pid_t                                   pid;                                                 ///< Process ID
+    int32_t                                 status;                                              ///< Process exit status
+    int32_t                                 infp;                                                ///< Process stdin
+    int32_t                                 outfp;                                               ///< Process stdout
 } mangoh_bridge_process_t;
 
 //------------------------------------------------------------------------------------------------------------------
@@ -124,5 +127,6 @@ typedef struct _mangoh_bridge_processes_t
 
 int mangoh_bridge_processes_init(mangoh_bridge_processes_t*, void*);
 int mangoh_bridge_processes_destroy(mangoh_bridge_processes_t*);
+void mangoh_bridge_processes_childExited(mangoh_bridge_processes_t*);
 
 #endif
@@ -0,0 +1,157 @@
+/**
+ * @file
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless, Inc. Use of this work is subject to license.
+ */
+
+#include "legato.h"
+#include "queue.h"
+
+static int mangoh_bridge_queue_span(const mangoh_bridge_queue_t*, uint32_t, uint32_t, struct iovec*);
+
+static int mangoh_bridge_queue_span(const mangoh_bridge_queue_t* queue, uint32_t pos, uint32_t len, struct iovec* iov)
+{
+    const uint32_t offset = pos & (queue->size - 1);
+    const uint32_t first = (len < queue->size - offset) ? len : queue->size - offset;
+    int iovcnt = 0;
+
+    if (first)
+    {
+        iov[iovcnt].iov_base = &queue->data[offset];
+        iov[iovcnt].iov_len = first;
+        iovcnt++;
+    }
+
+    if (len > first)
+    {
+        iov[iovcnt].iov_base = queue->data;
+        iov[iovcnt].iov_len = len - first;
+        iovcnt++;
+    }
+
+    return iovcnt;
+}
+
+uint32_t mangoh_bridge_queue_len(const mangoh_bridge_queue_t* queue)
+{
+    LE_ASSERT(queue);
+    return queue->tail - queue->head;
+}
+
+uint32_t mangoh_bridge_queue_room(const mangoh_bridge_queue_t* queue)
+{
+    LE_ASSERT(queue);
+    return queue->size - (queue->tail - queue->head);
+}
+
+uint32_t mangoh_bridge_queue_write(mangoh_bridge_queue_t* queue, const void* data, uint32_t len)
+{
+    struct iovec iov[MANGOH_BRIDGE_QUEUE_NUM_IOVS];
+    const uint8_t* ptr = data;
+
+    LE_ASSERT(queue);
+    LE_ASSERT(data || !len);
+
+    len = (len < mangoh_bridge_queue_room(queue)) ? len:mangoh_bridge_queue_room(queue);
+
+    int iovcnt = mangoh_bridge_queue_span(queue, queue->tail, len, iov);
+    int idx = 0;
+    for (idx = 0; idx < iovcnt; idx++)
+    {
+        memcpy(iov[idx].iov_base, ptr, iov[idx].iov_len);
+        ptr += iov[idx].iov_len;
+    }
+
+    queue->tail += len;
+    return len;
+}
+
+uint32_t mangoh_bridge_queue_read(mangoh_bridge_queue_t* queue, void* data, uint32_t len)
+{
+    LE_ASSERT(queue);
+
+    len = mangoh_bridge_queue_peek(queue, 0, data, len);
+    queue->head += len;
+    return len;
+}
+
+uint32_t mangoh_bridge_queue_peek(const mangoh_bridge_queue_t* queue, uint32_t offset, void* data, uint32_t len)
+{
+    struct iovec iov[MANGOH_BRIDGE_QUEUE_NUM_IOVS];
+    uint8_t* ptr = data;
+
+    LE_ASSERT(queue);
+    LE_ASSERT(data || !len);
+
+    int iovcnt = mangoh_bridge_queue_peekIov(queue, offset, iov, len);
+    int idx = 0;
+    for (idx = 0; idx < iovcnt; idx++)
+    {
+        memcpy(ptr, iov[idx].iov_base, iov[idx].iov_len);
+        ptr += iov[idx].iov_len;
+    }
+
+    return ptr - (uint8_t*)data;
+}
+
+int mangoh_bridge_queue_readIov(const mangoh_bridge_queue_t* queue, struct iovec* iov, uint32_t maxLen)
+{
+    return mangoh_bridge_queue_peekIov(queue, 0, iov, maxLen);
+}
+
+int mangoh_bridge_queue_peekIov(const mangoh_bridge_queue_t* queue, uint32_t offset, struct iovec* iov, uint32_t maxLen)
+{
+    LE_ASSERT(queue);
+    LE_ASSERT(iov);
+
+    // Bytes offset from the head, left in the queue
+    const uint32_t queued = mangoh_bridge_queue_len(queue);
+    const uint32_t len = (offset < queued) ? queued - offset:0;
+    return mangoh_bridge_queue_span(queue, queue->head + offset, (len < maxLen) ? len:maxLen, iov);
+}
+
+int mangoh_bridge_queue_writeIov(const mangoh_bridge_queue_t* queue, struct iovec* iov)
+{
+    LE_ASSERT(queue);
+    LE_ASSERT(iov);
+
+    return mangoh_bridge_queue_span(queue, queue->tail, mangoh_bridge_queue_room(queue), iov);
+}
+
+void mangoh_bridge_queue_consume(mangoh_bridge_queue_t* queue, uint32_t len)
+{
+    LE_ASSERT(queue);
+    LE_ASSERT(len <= mangoh_bridge_queue_len(queue));
+
+    queue->head += len;
+}
+
+void mangoh_bridge_queue_produce(mangoh_bridge_queue_t* queue, uint32_t len)
+{
+    LE_ASSERT(queue);
+    LE_ASSERT(len <= mangoh_bridge_queue_room(queue));
+
+    queue->tail += len;
+}
+
+void mangoh_bridge_queue_clear(mangoh_bridge_queue_t* queue)
+{
+    LE_ASSERT(queue);
+
+    queue->head = 0;
+    queue->tail = 0;
+}
+
+void mangoh_bridge_queue_init(mangoh_bridge_queue_t* queue, void* data, uint32_t size)
+{
+    LE_ASSERT(queue);
+    LE_ASSERT(data || !size);
+    LE_ASSERT(!(size & (size - 1)));
+
+    queue->data = data;
+    queue->size = size;
+    queue->head = 0;
+    queue->tail = 0;
+}
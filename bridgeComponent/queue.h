@@ -0,0 +1,54 @@
+/*
+ * @file mangoh_bridge_queue.h
+ *
+ * Arduino bridge byte queue module.
+ *
+ * A FIFO of bytes over a power of two sized buffer owned by the caller.  Bytes are produced at the tail and consumed
+ * at the head in constant time, nothing is ever moved inside the buffer, so draining a queue costs only the bytes
+ * copied out.  The readable and writable spans are exposed as at most two iovecs so a socket or pipe can be read into
+ * or written from the queue directly with readv()/sendmsg().
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+#include <sys/uio.h>
+#include "legato.h"
+
+#ifndef MANGOH_BRIDGE_QUEUE_INCLUDE_GUARD
+#define MANGOH_BRIDGE_QUEUE_INCLUDE_GUARD
+
+#define MANGOH_BRIDGE_QUEUE_NUM_IOVS              2
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Byte queue
+ *
+ * Head and tail are free running counters masked on access.
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_queue_t
+{
+    uint8_t* data; ///< Queue storage
+    uint32_t size; ///< Storage size, a power of two
+    uint32_t head; ///< Next byte to consume
+    uint32_t tail; ///< Next byte to produce
+} mangoh_bridge_queue_t;
+
+uint32_t mangoh_bridge_queue_len(const mangoh_bridge_queue_t*);
+uint32_t mangoh_bridge_queue_room(const mangoh_bridge_queue_t*);
+
+uint32_t mangoh_bridge_queue_write(mangoh_bridge_queue_t*, const void*, uint32_t);
+uint32_t mangoh_bridge_queue_read(mangoh_bridge_queue_t*, void*, uint32_t);
+uint32_t mangoh_bridge_queue_peek(const mangoh_bridge_queue_t*, uint32_t, void*, uint32_t);
+
+int mangoh_bridge_queue_readIov(const mangoh_bridge_queue_t*, struct iovec*, uint32_t);
+int mangoh_bridge_queue_peekIov(const mangoh_bridge_queue_t*, uint32_t, struct iovec*, uint32_t);
+int mangoh_bridge_queue_writeIov(const mangoh_bridge_queue_t*, struct iovec*);
+void mangoh_bridge_queue_consume(mangoh_bridge_queue_t*, uint32_t);
+void mangoh_bridge_queue_produce(mangoh_bridge_queue_t*, uint32_t);
+
+void mangoh_bridge_queue_clear(mangoh_bridge_queue_t*);
+void mangoh_bridge_queue_init(mangoh_bridge_queue_t*, void*, uint32_t);
+
+#endif
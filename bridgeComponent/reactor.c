@@ -0,0 +1,194 @@
+/**
+ * @file
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless, Inc. Use of this work is subject to license.
+ */
+
+#include "legato.h"
+#include "reactor.h"
+
+static int mangoh_bridge_reactor_start(void);
+static int mangoh_bridge_reactor_update(mangoh_bridge_reactor_watch_t*, uint32_t);
+static void mangoh_bridge_reactor_eventHandler(int, short);
+
+static int mangoh_bridge_reactor_epollFd = MANGOH_BRIDGE_REACTOR_FD_INVALID;
+static le_fdMonitor_Ref_t mangoh_bridge_reactor_fdMonitor;
+
+// Events being dispatched, entries are cleared when their watch is removed by an earlier handler
+static struct epoll_event mangoh_bridge_reactor_ready[MANGOH_BRIDGE_REACTOR_MAX_EVENTS];
+static int mangoh_bridge_reactor_numReady;
+
+static int mangoh_bridge_reactor_start(void)
+{
+    int32_t res = LE_OK;
+
+    if (mangoh_bridge_reactor_epollFd != MANGOH_BRIDGE_REACTOR_FD_INVALID)
+    {
+        goto cleanup;
+    }
+
+    mangoh_bridge_reactor_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (mangoh_bridge_reactor_epollFd < 0)
+    {
+        LE_ERROR("ERROR epoll_create1() failed(%d)", errno);
+        mangoh_bridge_reactor_epollFd = MANGOH_BRIDGE_REACTOR_FD_INVALID;
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    mangoh_bridge_reactor_fdMonitor = le_fdMonitor_Create(MANGOH_BRIDGE_REACTOR_FD_MONITOR_NAME, mangoh_bridge_reactor_epollFd,
+                                                          mangoh_bridge_reactor_eventHandler, POLLIN);
+    LE_DEBUG("reactor started(%d)", mangoh_bridge_reactor_epollFd);
+
+cleanup:
+    return res;
+}
+
+static int mangoh_bridge_reactor_update(mangoh_bridge_reactor_watch_t* watch, uint32_t events)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(watch);
+
+    if (!watch->handler)
+    {
+        res = LE_NOT_FOUND;
+        goto cleanup;
+    }
+
+    if (watch->events == events)
+    {
+        goto cleanup;
+    }
+
+    struct epoll_event ev = { .events = events, .data.ptr = watch };
+    res = epoll_ctl(mangoh_bridge_reactor_epollFd, EPOLL_CTL_MOD, watch->fd, &ev);
+    if (res < 0)
+    {
+        LE_ERROR("ERROR epoll_ctl() fd(%d) failed(%d/%d)", watch->fd, res, errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    watch->events = events;
+
+cleanup:
+    return res;
+}
+
+static void mangoh_bridge_reactor_eventHandler(int fd, short events)
+{
+    int numReady = epoll_wait(mangoh_bridge_reactor_epollFd, mangoh_bridge_reactor_ready, MANGOH_BRIDGE_REACTOR_MAX_EVENTS, 0);
+    if (numReady < 0)
+    {
+        if (errno != EINTR)
+        {
+            LE_ERROR("ERROR epoll_wait() failed(%d)", errno);
+        }
+
+        return;
+    }
+
+    mangoh_bridge_reactor_numReady = numReady;
+
+    int idx = 0;
+    for (idx = 0; idx < numReady; idx++)
+    {
+        mangoh_bridge_reactor_watch_t* watch = mangoh_bridge_reactor_ready[idx].data.ptr;
+        if (watch)
+        {
+            watch->handler(watch, mangoh_bridge_reactor_ready[idx].events);
+        }
+    }
+
+    mangoh_bridge_reactor_numReady = 0;
+}
+
+bool mangoh_bridge_reactor_isRegistered(const mangoh_bridge_reactor_watch_t* watch)
+{
+    LE_ASSERT(watch);
+    return (watch->handler != NULL);
+}
+
+int mangoh_bridge_reactor_add(mangoh_bridge_reactor_watch_t* watch, int fd, uint32_t events, mangoh_bridge_reactor_handler_t handler, void* context)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(watch);
+    LE_ASSERT(handler);
+    LE_ASSERT(!watch->handler);
+
+    res = mangoh_bridge_reactor_start();
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_reactor_start() failed(%d)", res);
+        goto cleanup;
+    }
+
+    struct epoll_event ev = { .events = events, .data.ptr = watch };
+    res = epoll_ctl(mangoh_bridge_reactor_epollFd, EPOLL_CTL_ADD, fd, &ev);
+    if (res < 0)
+    {
+        LE_ERROR("ERROR epoll_ctl() fd(%d) failed(%d/%d)", fd, res, errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    watch->handler = handler;
+    watch->context = context;
+    watch->fd = fd;
+    watch->events = events;
+
+cleanup:
+    return res;
+}
+
+int mangoh_bridge_reactor_enable(mangoh_bridge_reactor_watch_t* watch, uint32_t events)
+{
+    LE_ASSERT(watch);
+    return mangoh_bridge_reactor_update(watch, watch->events | events);
+}
+
+int mangoh_bridge_reactor_disable(mangoh_bridge_reactor_watch_t* watch, uint32_t events)
+{
+    LE_ASSERT(watch);
+    return mangoh_bridge_reactor_update(watch, watch->events & ~events);
+}
+
+int mangoh_bridge_reactor_remove(mangoh_bridge_reactor_watch_t* watch)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(watch);
+
+    if (!watch->handler)
+    {
+        goto cleanup;
+    }
+
+    res = epoll_ctl(mangoh_bridge_reactor_epollFd, EPOLL_CTL_DEL, watch->fd, NULL);
+    if (res < 0)
+    {
+        LE_ERROR("ERROR epoll_ctl() fd(%d) failed(%d/%d)", watch->fd, res, errno);
+        res = LE_FAULT;
+    }
+
+    // Do not dispatch events already collected for this watch
+    int idx = 0;
+    for (idx = 0; idx < mangoh_bridge_reactor_numReady; idx++)
+    {
+        if (mangoh_bridge_reactor_ready[idx].data.ptr == watch)
+        {
+            mangoh_bridge_reactor_ready[idx].data.ptr = NULL;
+        }
+    }
+
+    watch->handler = NULL;
+    watch->context = NULL;
+    watch->events = 0;
+
+cleanup:
+    return res;
+}
@@ -0,0 +1,49 @@
+/*
+ * @file mangoh_bridge_reactor.h
+ *
+ * Arduino bridge socket reactor module.
+ *
+ * A single epoll instance shared by the TCP server, TCP client and sockets modules.  Sockets are registered once and
+ * their interest set is updated in place, the Legato event loop only watches the epoll descriptor and each wake up
+ * dispatches the ready sockets only.  A watch is embedded in the owner's data structure, no allocation is needed, and
+ * a zeroed watch is not registered.
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+#include <sys/epoll.h>
+#include "legato.h"
+
+#ifndef MANGOH_BRIDGE_REACTOR_INCLUDE_GUARD
+#define MANGOH_BRIDGE_REACTOR_INCLUDE_GUARD
+
+#define MANGOH_BRIDGE_REACTOR_FD_MONITOR_NAME     "BridgeReactor"
+#define MANGOH_BRIDGE_REACTOR_MAX_EVENTS          32
+#define MANGOH_BRIDGE_REACTOR_FD_INVALID          -1
+
+struct _mangoh_bridge_reactor_watch_t;
+
+typedef void (*mangoh_bridge_reactor_handler_t)(struct _mangoh_bridge_reactor_watch_t*, uint32_t);
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Registered descriptor
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_reactor_watch_t
+{
+    mangoh_bridge_reactor_handler_t handler; ///< Called with the ready events, NULL when not registered
+    void*                           context; ///< Owner data
+    int                             fd;      ///< Watched descriptor
+    uint32_t                        events;  ///< Current interest set (EPOLLIN/EPOLLOUT)
+} mangoh_bridge_reactor_watch_t;
+
+bool mangoh_bridge_reactor_isRegistered(const mangoh_bridge_reactor_watch_t*);
+
+int mangoh_bridge_reactor_add(mangoh_bridge_reactor_watch_t*, int, uint32_t, mangoh_bridge_reactor_handler_t, void*);
+int mangoh_bridge_reactor_enable(mangoh_bridge_reactor_watch_t*, uint32_t);
+int mangoh_bridge_reactor_disable(mangoh_bridge_reactor_watch_t*, uint32_t);
+int mangoh_bridge_reactor_remove(mangoh_bridge_reactor_watch_t*);
+
+#endif
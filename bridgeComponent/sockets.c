@@ -14,6 +14,23 @@
 #include "bridge.h"
 #include "sockets.h"
 
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Deferred connect, the host name is resolved on a worker thread
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_sockets_connect_job_t
+{
+    mangoh_bridge_pending_t  pending;                                     ///< Deferred response
+    char                     host[MANGOH_BRIDGE_SOCKETS_SERVER_IP_LEN];   ///< Server name or address
+    char                     port[MANGOH_BRIDGE_SOCKETS_PORT_STRING_LEN]; ///< Server port
+    mangoh_bridge_sockets_t* sockets;                                     ///< Sockets module
+    struct addrinfo*         servinfo;                                    ///< Resolved addresses
+    int32_t                  res;                                         ///< getaddrinfo() result
+    uint32_t                 generation;                                  ///< Client generation when submitted
+    uint8_t                  id;                                          ///< Client ID reserved for the connection
+} mangoh_bridge_sockets_connect_job_t;
+
 static int mangoh_bridge_sockets_listen(void*, const unsigned char*, uint32_t);
 static int mangoh_bridge_sockets_accept(void*, const unsigned char*, uint32_t);
 static int mangoh_bridge_sockets_read(void*, const unsigned char*, uint32_t);
@@ -24,12 +41,19 @@ static int mangoh_bridge_sockets_connecting(void*, const unsigned char*, uint32_
 static int mangoh_bridge_sockets_connect(void*, const unsigned char*, uint32_t);
 static int mangoh_bridge_sockets_writeToAll(void*, const unsigned char*, uint32_t);
 
+static void mangoh_bridge_sockets_resolveWork(void*);
+static void mangoh_bridge_sockets_resolveDone(void*);
+static int mangoh_bridge_sockets_connectClient(mangoh_bridge_sockets_connect_job_t*);
+
 static int mangoh_bridge_sockets_closeServer(mangoh_bridge_sockets_server_t*);
 static int mangoh_bridge_sockets_closeClient(mangoh_bridge_sockets_client_info_t*);
+static int mangoh_bridge_sockets_monitorClient(mangoh_bridge_sockets_client_info_t*);
+static void mangoh_bridge_sockets_stopMonitor(mangoh_bridge_sockets_client_info_t*);
+static void mangoh_bridge_sockets_updateEvents(mangoh_bridge_sockets_client_info_t*);
 static int mangoh_bridge_sockets_checkConnections(mangoh_bridge_sockets_client_info_t*);
-static int mangoh_bridge_sockets_checkClients(uint16_t, mangoh_bridge_sockets_client_t*);
+static int mangoh_bridge_sockets_checkClient(mangoh_bridge_sockets_client_info_t*, uint32_t);
+static void mangoh_bridge_sockets_eventHandler(mangoh_bridge_reactor_watch_t*, uint32_t);
 
-static int mangoh_bridge_sockets_runner(void*);
 static int mangoh_bridge_sockets_reset(void*);
 
 static int mangoh_bridge_sockets_listen(void* param, const unsigned char* data, uint32_t size)
@@ -158,7 +182,7 @@ static int mangoh_bridge_sockets_listen(void* param, const unsigned char* data,
         goto cleanup;
     }
 
-    mangoh_bridge_sockets_listen_rsp_t* const rsp = (mangoh_bridge_sockets_listen_rsp_t*)((mangoh_bridge_t*)sockets->bridge)->packet.msg.data;
+    mangoh_bridge_sockets_listen_rsp_t* const rsp = (mangoh_bridge_sockets_listen_rsp_t*)((mangoh_bridge_t*)sockets->bridge)->packet.tx.data;
     rsp->result = true;
     LE_DEBUG("result(%d)", rsp->result);
     res = mangoh_bridge_sendResult(sockets->bridge, sizeof(mangoh_bridge_sockets_listen_rsp_t));
@@ -177,7 +201,7 @@ cleanup:
             LE_ERROR("ERROR mangoh_bridge_sockets_closeServer() failed(%d)", err);
         }
 
-        mangoh_bridge_sockets_listen_rsp_t* const rsp = (mangoh_bridge_sockets_listen_rsp_t*)((mangoh_bridge_t*)sockets->bridge)->packet.msg.data;
+        mangoh_bridge_sockets_listen_rsp_t* const rsp = (mangoh_bridge_sockets_listen_rsp_t*)((mangoh_bridge_t*)sockets->bridge)->packet.tx.data;
         rsp->result = false;
         LE_DEBUG("result(%d)", rsp->result);
         err = mangoh_bridge_sendResult(sockets->bridge, sizeof(mangoh_bridge_sockets_listen_rsp_t));
@@ -207,85 +231,82 @@ static int mangoh_bridge_sockets_accept(void* param, const unsigned char* data,
         goto cleanup;
     }
 
-    mangoh_bridge_sockets_accept_rsp_t* const rsp = (mangoh_bridge_sockets_accept_rsp_t*)((mangoh_bridge_t*)sockets->bridge)->packet.msg.data;
-
-    FD_ZERO(&sockets->server.readfds);
-    FD_SET(sockets->server.sockFd, &sockets->server.readfds);
+    mangoh_bridge_sockets_accept_rsp_t* const rsp = (mangoh_bridge_sockets_accept_rsp_t*)((mangoh_bridge_t*)sockets->bridge)->packet.tx.data;
 
-    struct timeval tv  = {0};
-    res = select(sockets->server.sockFd + 1, &sockets->server.readfds, NULL, NULL, &tv);
-    if (res < 0)
+    // The listening socket is non-blocking, no pending connection is reported as EAGAIN
+    struct sockaddr_in clientAddr = {0};
+    socklen_t clientAddrSize = sizeof(clientAddr);
+    int32_t newFd = accept(sockets->server.sockFd, (struct sockaddr*)&clientAddr, &clientAddrSize);
+    if ((newFd < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)))
     {
-        LE_ERROR("ERROR select() failed(%d/%d)", errno, res);
-        res = LE_IO_ERROR;
-        goto cleanup;
-    }
-
-    if (FD_ISSET(sockets->server.sockFd, &sockets->server.readfds))
-    {
-        struct sockaddr_in clientAddr = {0};
-        uint32_t clientAddrSize = 0;
-        int32_t newFd = accept(sockets->server.sockFd, (struct sockaddr*)&clientAddr, &clientAddrSize);
-        if (newFd < 0)
-        {
-            LE_ERROR("ERROR accept() socket(%d) failed(%d/%d)", sockets->server.sockFd, newFd, errno);
-            res = LE_IO_ERROR;
-            goto cleanup;
-        }
-
-        char clientIPStr[INET_ADDRSTRLEN] = {0};
-        LE_INFO("connection -> '%s'", inet_ntop(AF_INET, &clientAddr.sin_addr, clientIPStr, INET_ADDRSTRLEN));
-
-        res = fcntl(newFd, F_SETFL, O_NONBLOCK);
-        if (res < 0)
+        res = mangoh_bridge_sendResult(sockets->bridge, 0);
+        if (res != LE_OK)
         {
-            LE_ERROR("ERROR fcntl() socket(%d) failed(%d/%d)", newFd, res, errno);
-            res = LE_FAULT;
+            LE_ERROR("ERROR mangoh_bridge_sendResult() failed(%d)", res);
             goto cleanup;
         }
 
-        if (sockets->clients.info[sockets->clients.nextId].sockFd == MANGOH_BRIDGE_SOCKETS_INVALID)
-        {
-            LE_INFO("add sockets[%u](%d)", sockets->clients.nextId, newFd);
-            sockets->clients.info[sockets->clients.nextId].sockFd = newFd;
-            sockets->clients.info[sockets->clients.nextId].connected = true;
-            rsp->result = sockets->clients.nextId;
-            sockets->clients.nextId = (sockets->clients.nextId + 1) % MANGOH_BRIDGE_SOCKETS_MAX_CLIENTS;
-        }
-        else
-        {
-            LE_ERROR("ERROR socket[%u](%d) not closed", sockets->clients.nextId, sockets->clients.info[sockets->clients.nextId].sockFd);
+        goto cleanup;
+    }
+    else if (newFd < 0)
+    {
+        LE_ERROR("ERROR accept() socket(%d) failed(%d/%d)", sockets->server.sockFd, newFd, errno);
+        res = LE_IO_ERROR;
+        goto cleanup;
+    }
 
-            res = close(newFd);
-            if (res < 0)
-            {
-                LE_ERROR("ERROR close() socket(%d) failed(%d/%d)", newFd, res, errno);
-                res = LE_IO_ERROR;
-                goto cleanup;
-            }
+    char clientIPStr[INET_ADDRSTRLEN] = {0};
+    LE_INFO("connection -> '%s'", inet_ntop(AF_INET, &clientAddr.sin_addr, clientIPStr, INET_ADDRSTRLEN));
 
-            res = LE_BAD_PARAMETER;
-            goto cleanup;
-        }
+    res = fcntl(newFd, F_SETFL, O_NONBLOCK);
+    if (res < 0)
+    {
+        LE_ERROR("ERROR fcntl() socket(%d) failed(%d/%d)", newFd, res, errno);
+        close(newFd);
+        res = LE_FAULT;
+        goto cleanup;
+    }
 
-        FD_CLR(sockets->server.sockFd, &sockets->server.readfds);
+    if ((sockets->clients.info[sockets->clients.nextId].sockFd == MANGOH_BRIDGE_SOCKETS_INVALID) &&
+        !sockets->clients.info[sockets->clients.nextId].resolving)
+    {
+        LE_INFO("add sockets[%u](%d)", sockets->clients.nextId, newFd);
+        sockets->clients.info[sockets->clients.nextId].sockFd = newFd;
+        sockets->clients.info[sockets->clients.nextId].connected = true;
 
-        LE_DEBUG("result(%d)", rsp->result);
-        res = mangoh_bridge_sendResult(sockets->bridge, sizeof(mangoh_bridge_sockets_accept_rsp_t));
+        res = mangoh_bridge_sockets_monitorClient(&sockets->clients.info[sockets->clients.nextId]);
         if (res != LE_OK)
         {
-            LE_ERROR("ERROR mangoh_bridge_sendResult() failed(%d)", res);
+            LE_ERROR("ERROR mangoh_bridge_sockets_monitorClient() failed(%d)", res);
+            mangoh_bridge_sockets_closeClient(&sockets->clients.info[sockets->clients.nextId]);
             goto cleanup;
         }
+
+        rsp->result = sockets->clients.nextId;
+        sockets->clients.nextId = (sockets->clients.nextId + 1) % MANGOH_BRIDGE_SOCKETS_MAX_CLIENTS;
     }
     else
     {
-        res = mangoh_bridge_sendResult(sockets->bridge, 0);
-        if (res != LE_OK)
+        LE_ERROR("ERROR socket[%u](%d) not closed", sockets->clients.nextId, sockets->clients.info[sockets->clients.nextId].sockFd);
+
+        res = close(newFd);
+        if (res < 0)
         {
-            LE_ERROR("ERROR mangoh_bridge_sendResult() failed(%d)", res);
+            LE_ERROR("ERROR close() socket(%d) failed(%d/%d)", newFd, res, errno);
+            res = LE_IO_ERROR;
             goto cleanup;
         }
+
+        res = LE_BAD_PARAMETER;
+        goto cleanup;
+    }
+
+    LE_DEBUG("result(%d)", rsp->result);
+    res = mangoh_bridge_sendResult(sockets->bridge, sizeof(mangoh_bridge_sockets_accept_rsp_t));
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_sendResult() failed(%d)", res);
+        goto cleanup;
     }
 
 cleanup:
@@ -311,8 +332,9 @@ static int mangoh_bridge_sockets_read(void* param, const unsigned char* data, ui
 
     const mangoh_bridge_sockets_read_req_t* const req = (mangoh_bridge_sockets_read_req_t*)data;
     const uint8_t id = req->id;
-    const uint8_t len = req->len;
-    LE_DEBUG("---> READ(%u) length(%u)", id, len);
+    const uint32_t maxLen = ((mangoh_bridge_t*)sockets->bridge)->packet.dataSize;
+    const uint32_t len = (req->len > maxLen) ? maxLen:req->len;
+    LE_DEBUG("---> READ(%u) length(%u)", id, req->len);
 
     if (id >= MANGOH_BRIDGE_SOCKETS_MAX_CLIENTS)
     {
@@ -321,25 +343,14 @@ static int mangoh_bridge_sockets_read(void* param, const unsigned char* data, ui
         goto cleanup;
     }
 
-    mangoh_bridge_sockets_read_rsp_t* const rsp = (mangoh_bridge_sockets_read_rsp_t*)((mangoh_bridge_t*)sockets->bridge)->packet.msg.data;
+    mangoh_bridge_sockets_read_rsp_t* const rsp = (mangoh_bridge_sockets_read_rsp_t*)((mangoh_bridge_t*)sockets->bridge)->packet.tx.data;
 
     uint32_t bytesRead = 0;
-    LE_DEBUG("socket[%u](%d) Rx buffer length(%u)", id, sockets->clients.info[id].sockFd, sockets->clients.info[id].rxBuff.len);
-    if (sockets->clients.info[id].rxBuff.len)
+    LE_DEBUG("socket[%u](%d) Rx buffer length(%u)", id, sockets->clients.info[id].sockFd, mangoh_bridge_queue_len(&sockets->clients.info[id].rxBuff.queue));
+    if (mangoh_bridge_queue_len(&sockets->clients.info[id].rxBuff.queue))
     {
-        if (sockets->clients.info[id].rxBuff.len < len)
-        {
-            memcpy(rsp->data, sockets->clients.info[id].rxBuff.data, sockets->clients.info[id].rxBuff.len);
-            bytesRead = sockets->clients.info[id].rxBuff.len;
-            sockets->clients.info[id].rxBuff.len = 0;
-        }
-        else
-        {
-            memcpy(rsp->data, sockets->clients.info[id].rxBuff.data, len);
-            memmove(sockets->clients.info[id].rxBuff.data, &sockets->clients.info[id].rxBuff.data[len], sockets->clients.info[id].rxBuff.len - len);
-            sockets->clients.info[id].rxBuff.len -=  len;
-            bytesRead = len;
-        }
+        bytesRead = mangoh_bridge_queue_read(&sockets->clients.info[id].rxBuff.queue, rsp->data, len);
+        mangoh_bridge_sockets_updateEvents(&sockets->clients.info[id]);
     }
 
     LE_DEBUG("result(%d)", bytesRead);
@@ -363,7 +374,7 @@ static int mangoh_bridge_sockets_write(void* param, const unsigned char* data, u
     LE_ASSERT(data);
 
     const mangoh_bridge_sockets_write_req_t* const req = (mangoh_bridge_sockets_write_req_t*)data;
-    const uint8_t len = size - sizeof(req->id);
+    const uint32_t len = size - sizeof(req->id);
     LE_DEBUG("---> WRITE(%u) len(%u)", req->id, len);
 
     if (req->id >= MANGOH_BRIDGE_SOCKETS_MAX_CLIENTS)
@@ -375,11 +386,11 @@ static int mangoh_bridge_sockets_write(void* param, const unsigned char* data, u
 
     if (sockets->clients.info[req->id].sockFd != MANGOH_BRIDGE_SOCKETS_INVALID)
     {
-        if (sockets->clients.info[req->id].txBuff.len + len < MANGOH_BRIDGE_SOCKETS_BUFF_LEN)
+        if (len <= mangoh_bridge_queue_room(&sockets->clients.info[req->id].txBuff.queue))
         {
-            memcpy(&sockets->clients.info[req->id].txBuff.data[sockets->clients.info[req->id].txBuff.len], req->data, len);
-            sockets->clients.info[req->id].txBuff.len += len;
-            LE_DEBUG("socket[%u](%d) Tx buffer length(%u)", req->id, sockets->clients.info[req->id].sockFd, sockets->clients.info[req->id].txBuff.len);
+            mangoh_bridge_queue_write(&sockets->clients.info[req->id].txBuff.queue, req->data, len);
+            LE_DEBUG("socket[%u](%d) Tx buffer length(%u)", req->id, sockets->clients.info[req->id].sockFd, mangoh_bridge_queue_len(&sockets->clients.info[req->id].txBuff.queue));
+            mangoh_bridge_sockets_updateEvents(&sockets->clients.info[req->id]);
         }
         else
         {
@@ -424,7 +435,7 @@ static int mangoh_bridge_sockets_connected(void* param, const unsigned char* dat
         goto cleanup;
     }
 
-    mangoh_bridge_sockets_connected_rsp_t* const rsp = (mangoh_bridge_sockets_connected_rsp_t*)((mangoh_bridge_t*)sockets->bridge)->packet.msg.data;
+    mangoh_bridge_sockets_connected_rsp_t* const rsp = (mangoh_bridge_sockets_connected_rsp_t*)((mangoh_bridge_t*)sockets->bridge)->packet.tx.data;
     rsp->result = ((sockets->clients.info[req->id].sockFd != MANGOH_BRIDGE_SOCKETS_INVALID) && sockets->clients.info[req->id].connected) ? true:false;
     LE_DEBUG("socket(%d) connected(%u)", sockets->clients.info[req->id].sockFd, sockets->clients.info[req->id].connected);
 
@@ -497,7 +508,7 @@ static int mangoh_bridge_sockets_connecting(void* param, const unsigned char* da
         goto cleanup;
     }
 
-    mangoh_bridge_sockets_connecting_rsp_t* const rsp = (mangoh_bridge_sockets_connecting_rsp_t*)((mangoh_bridge_t*)sockets->bridge)->packet.msg.data;
+    mangoh_bridge_sockets_connecting_rsp_t* const rsp = (mangoh_bridge_sockets_connecting_rsp_t*)((mangoh_bridge_t*)sockets->bridge)->packet.tx.data;
     rsp->result = ((sockets->clients.info[req->id].sockFd != MANGOH_BRIDGE_SOCKETS_INVALID) && sockets->clients.info[req->id].connecting) ? true:false;
     LE_DEBUG("socket(%d) connecting(%u)", sockets->clients.info[req->id].sockFd, sockets->clients.info[req->id].connecting);
 
@@ -513,119 +524,225 @@ cleanup:
     return res;
 }
 
-static int mangoh_bridge_sockets_connect(void* param, const unsigned char* data, uint32_t size)
+static void mangoh_bridge_sockets_resolveWork(void* param)
 {
-    mangoh_bridge_sockets_t* sockets = (mangoh_bridge_sockets_t*)param;
-    int32_t res = LE_OK;
+    mangoh_bridge_sockets_connect_job_t* job = (mangoh_bridge_sockets_connect_job_t*)param;
 
-    LE_ASSERT(sockets);
-    LE_ASSERT(data);
+    LE_ASSERT(job);
 
-    const mangoh_bridge_sockets_connect_req_t* const req = (mangoh_bridge_sockets_connect_req_t*)data;
-    const uint16_t port = ntohs(req->port);
-    LE_DEBUG("---> CONNECT('%s:%u')", req->serverIP, port);
+    struct addrinfo hints = {0};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    job->res = getaddrinfo(job->host, job->port, &hints, &job->servinfo);
+}
+
+static int mangoh_bridge_sockets_connectClient(mangoh_bridge_sockets_connect_job_t* job)
+{
+    int32_t res = LE_OK;
 
-    mangoh_bridge_sockets_connect_rsp_t* const rsp = (mangoh_bridge_sockets_connect_rsp_t*)((mangoh_bridge_t*)sockets->bridge)->packet.msg.data;
+    LE_ASSERT(job);
 
-    if (sockets->clients.info[sockets->clients.nextId].sockFd == MANGOH_BRIDGE_SOCKETS_INVALID)
+    mangoh_bridge_sockets_client_info_t* const clientInfo = &job->sockets->clients.info[job->id];
+    if (job->res)
     {
-        sockets->clients.info[sockets->clients.nextId].sockFd = socket(AF_INET, SOCK_STREAM, 0);
-        if (sockets->clients.info[sockets->clients.nextId].sockFd < 0)
+        if (job->res == EAI_AGAIN)
         {
-            LE_ERROR("ERROR socket() failed(%d/%d)", res, errno);
-            res = sockets->clients.info[sockets->clients.nextId].sockFd;
-            goto cleanup;
+            LE_WARN("WARNING getaddrinfo() name server temporary failure indication");
+            res = LE_COMM_ERROR;
         }
-
-        res = fcntl(sockets->clients.info[sockets->clients.nextId].sockFd, F_SETFL, O_NONBLOCK);
-        if (res < 0)
+        else
         {
-            LE_ERROR("ERROR fcntl() socket(%d) failed(%d/%d)",
-                    sockets->clients.info[sockets->clients.nextId].sockFd, res, errno);
-            goto cleanup;
+            LE_ERROR("ERROR getaddrinfo() failed(%d)", job->res);
+            res = LE_FAULT;
         }
 
-        struct addrinfo hints = {0};
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        hints.ai_flags = AI_PASSIVE;
+        goto cleanup;
+    }
 
-        struct addrinfo* servinfo = NULL;
-        char portStr[MANGOH_BRIDGE_SOCKETS_PORT_STRING_LEN] = {0};
-        snprintf(portStr, MANGOH_BRIDGE_SOCKETS_PORT_STRING_LEN, "%u", port);
-        res = getaddrinfo((const char*)req->serverIP, portStr, &hints, &servinfo);
-        if (res)
+    clientInfo->sockFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (clientInfo->sockFd < 0)
+    {
+        LE_ERROR("ERROR socket() failed(%d/%d)", clientInfo->sockFd, errno);
+        res = clientInfo->sockFd;
+        clientInfo->sockFd = MANGOH_BRIDGE_SOCKETS_INVALID;
+        goto cleanup;
+    }
+
+    res = fcntl(clientInfo->sockFd, F_SETFL, O_NONBLOCK);
+    if (res < 0)
+    {
+        LE_ERROR("ERROR fcntl() socket(%d) failed(%d/%d)", clientInfo->sockFd, res, errno);
+        goto cleanup;
+    }
+
+    struct addrinfo* p = NULL;
+    for (p = job->servinfo; p != NULL; p = p->ai_next)
+    {
+        char addrstr[MANGOH_BRIDGE_SOCKETS_SERVER_IP_LEN] = {0};
+        void* ptr = NULL;
+
+        switch (p->ai_family)
         {
-            if (res == EAI_AGAIN)
-            {
-                LE_WARN("WARNING getaddrinfo() name server temporary failure indication");
-                res = LE_COMM_ERROR;
-            }
-            else
-            {
-                LE_ERROR("ERROR getaddrinfo() failed(%d)", res);
-                res = LE_FAULT;
-            }
+        case AF_INET:
+            ptr = &((struct sockaddr_in*)p->ai_addr)->sin_addr;
+            break;
 
-            goto cleanup;
+        case AF_INET6:
+            ptr = &((struct sockaddr_in6*)p->ai_addr)->sin6_addr;
+            break;
         }
 
-        struct addrinfo* p = NULL;
-        for (p = servinfo; p != NULL; p = p->ai_next)
+        inet_ntop(p->ai_family, ptr, addrstr, sizeof(addrstr));
+        LE_DEBUG("IPv%u address: '%s' ('%s')", p->ai_family == PF_INET6 ? 6 : 4, addrstr, p->ai_canonname);
+
+        res = connect(clientInfo->sockFd, p->ai_addr, p->ai_addrlen);
+        if ((res < 0) && (errno != EINPROGRESS))
         {
-            char addrstr[MANGOH_BRIDGE_SOCKETS_SERVER_IP_LEN] = {0};
-            void* ptr = NULL;
+            LE_WARN("WARNING connect() socket(%d) failed(%d/%d)", clientInfo->sockFd, res, errno);
+            continue;
+        }
 
-            switch (p->ai_family)
-            {
-            case AF_INET:
-                ptr = &((struct sockaddr_in*)p->ai_addr)->sin_addr;
-                break;
+        break;
+    }
 
-            case AF_INET6:
-                ptr = &((struct sockaddr_in6*)p->ai_addr)->sin6_addr;
-                break;
-            }
+    if (p == NULL)
+    {
+        LE_ERROR("ERROR connect('%s:%s') socket(%d) failed", job->host, job->port, clientInfo->sockFd);
+        res = LE_IO_ERROR;
+        goto cleanup;
+    }
 
-            inet_ntop(p->ai_family, ptr, addrstr, sizeof(addrstr));
-            LE_DEBUG("IPv%u address: '%s' ('%s')", p->ai_family == PF_INET6 ? 6 : 4, addrstr, p->ai_canonname);
+    LE_DEBUG("socket[%u](%d) connecting...", job->id, clientInfo->sockFd);
+    clientInfo->connecting = true;
 
-            res = connect(sockets->clients.info[sockets->clients.nextId].sockFd, p->ai_addr, p->ai_addrlen);
-            if ((res < 0) && (errno != EINPROGRESS))
-            {
-                LE_WARN("WARNING connect() socket(%d) failed(%d/%d)",
-                        sockets->clients.info[sockets->clients.nextId].sockFd, res, errno);
-                continue;
-            }
+    res = mangoh_bridge_sockets_monitorClient(clientInfo);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_sockets_monitorClient() failed(%d)", res);
+        goto cleanup;
+    }
 
-            break;
+cleanup:
+    return res;
+}
+
+static void mangoh_bridge_sockets_resolveDone(void* param)
+{
+    mangoh_bridge_sockets_connect_job_t* job = (mangoh_bridge_sockets_connect_job_t*)param;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(job);
+
+    mangoh_bridge_sockets_connect_rsp_t rsp = { .id = job->id };
+    uint32_t rspLen = 0;
+
+    // The client may have been closed and reused by a later connect while resolving
+    mangoh_bridge_sockets_client_info_t* const clientInfo = &job->sockets->clients.info[job->id];
+    if (job->generation != clientInfo->generation)
+    {
+        LE_INFO("socket[%u] closed while resolving '%s'", job->id, job->host);
+        res = LE_CLOSED;
+        goto cleanup;
+    }
+
+    clientInfo->resolving = false;
+    res = mangoh_bridge_sockets_connectClient(job);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_sockets_connectClient() failed(%d)", res);
+
+        int32_t err = mangoh_bridge_sockets_closeClient(clientInfo);
+        if (err != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_sockets_closeClient() failed(%d)", err);
         }
 
-        if (p == NULL)
+        goto cleanup;
+    }
+
+    LE_DEBUG("result(%d)", rsp.id);
+    rspLen = sizeof(rsp);
+
+cleanup:
+    res = mangoh_bridge_completeResult(job->sockets->bridge, &job->pending, &rsp, rspLen);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_completeResult() failed(%d)", res);
+    }
+
+    if (job->servinfo)
+    {
+        freeaddrinfo(job->servinfo);
+    }
+
+    free(job);
+}
+
+static int mangoh_bridge_sockets_connect(void* param, const unsigned char* data, uint32_t size)
+{
+    mangoh_bridge_sockets_t* sockets = (mangoh_bridge_sockets_t*)param;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(sockets);
+    LE_ASSERT(data);
+
+    const mangoh_bridge_sockets_connect_req_t* const req = (mangoh_bridge_sockets_connect_req_t*)data;
+    const uint16_t port = ntohs(req->port);
+    LE_DEBUG("---> CONNECT('%s:%u')", req->serverIP, port);
+
+    if ((sockets->clients.info[sockets->clients.nextId].sockFd == MANGOH_BRIDGE_SOCKETS_INVALID) &&
+        !sockets->clients.info[sockets->clients.nextId].resolving)
+    {
+        mangoh_bridge_sockets_connect_job_t* job = calloc(1, sizeof(mangoh_bridge_sockets_connect_job_t));
+        if (!job)
         {
-            LE_ERROR("ERROR connect('%s:%u') socket(%d) failed",
-                    req->serverIP, req->port, sockets->clients.info[sockets->clients.nextId].sockFd);
-            res = LE_IO_ERROR;
+            LE_ERROR("ERROR calloc() failed");
+            res = LE_NO_MEMORY;
             goto cleanup;
         }
 
-        LE_DEBUG("socket[%u](%d) connecting...", sockets->clients.nextId, sockets->clients.info[sockets->clients.nextId].sockFd);
-        sockets->clients.info[sockets->clients.nextId].connecting = true;
-        rsp->id = sockets->clients.nextId;
-        sockets->clients.nextId = (sockets->clients.nextId + 1) % MANGOH_BRIDGE_SOCKETS_MAX_CLIENTS;
+        const uint32_t hostLen = size - sizeof(req->port);
+        memcpy(job->host, req->serverIP, (hostLen < sizeof(job->host)) ? hostLen:sizeof(job->host) - 1);
+        snprintf(job->port, sizeof(job->port), "%u", port);
+        job->sockets = sockets;
+        job->id = sockets->clients.nextId;
+        job->generation = sockets->clients.info[job->id].generation;
 
-        LE_DEBUG("result(%d)", rsp->id);
-        res = mangoh_bridge_sendResult(sockets->bridge, sizeof(mangoh_bridge_sockets_connect_rsp_t));
+        // getaddrinfo() may block on the name server, resolve on a worker and connect when done
+        res = mangoh_bridge_worker_submit(NULL, mangoh_bridge_sockets_resolveWork, mangoh_bridge_sockets_resolveDone, job);
         if (res != LE_OK)
         {
-            LE_ERROR("ERROR mangoh_bridge_sendResult() failed(%d)", res);
+            LE_ERROR("ERROR mangoh_bridge_worker_submit() failed(%d)", res);
+            free(job);
+
+            // The submit failed, so no resolve can be running for the slot
+            int32_t err = mangoh_bridge_sockets_closeClient(&sockets->clients.info[sockets->clients.nextId]);
+            if (err != LE_OK)
+            {
+                LE_ERROR("ERROR mangoh_bridge_sockets_closeClient() failed(%d)", err);
+            }
+
             goto cleanup;
         }
+
+        mangoh_bridge_deferResult(sockets->bridge, &job->pending);
+        sockets->clients.info[job->id].resolving = true;
+        sockets->clients.nextId = (sockets->clients.nextId + 1) % MANGOH_BRIDGE_SOCKETS_MAX_CLIENTS;
     }
     else
     {
         LE_ERROR("socket(%u) not closed", sockets->clients.nextId);
         res = -EINVAL;
+
+        // Closing bumps the generation, so a resolve still running for the slot is dropped when it completes
+        int32_t err = mangoh_bridge_sockets_closeClient(&sockets->clients.info[sockets->clients.nextId]);
+        if (err != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_sockets_closeClient() failed(%d)", err);
+        }
+
         goto cleanup;
     }
 
@@ -637,12 +754,6 @@ cleanup:
         {
             LE_ERROR("ERROR mangoh_bridge_sendResult() failed(%d)", err);
         }
-
-        err = mangoh_bridge_sockets_closeClient(&sockets->clients.info[sockets->clients.nextId]);
-        if (err != LE_OK)
-        {
-            LE_ERROR("ERROR mangoh_bridge_sockets_closeClient() failed(%d)", err);
-        }
     }
 
     return res;
@@ -664,10 +775,10 @@ static int mangoh_bridge_sockets_writeToAll(void* param, const unsigned char* da
     {
         if ((sockets->clients.info[idx].sockFd != MANGOH_BRIDGE_SOCKETS_INVALID) && sockets->clients.info[idx].connected)
         {
-            if (sockets->clients.info[idx].txBuff.len + size < MANGOH_BRIDGE_SOCKETS_BUFF_LEN)
+            if (size <= mangoh_bridge_queue_room(&sockets->clients.info[idx].txBuff.queue))
             {
-                memcpy(&sockets->clients.info[idx].txBuff.data[sockets->clients.info[idx].txBuff.len], req->data, size);
-                sockets->clients.info[idx].txBuff.len += size;
+                mangoh_bridge_queue_write(&sockets->clients.info[idx].txBuff.queue, req->data, size);
+                mangoh_bridge_sockets_updateEvents(&sockets->clients.info[idx]);
             }
             else
             {
@@ -719,10 +830,14 @@ static int mangoh_bridge_sockets_closeClient(mangoh_bridge_sockets_client_info_t
 
     LE_ASSERT(clientInfo);
 
-    clientInfo->rxBuff.len = 0;
-    clientInfo->txBuff.len = 0;
+    mangoh_bridge_sockets_stopMonitor(clientInfo);
+
+    mangoh_bridge_queue_clear(&clientInfo->rxBuff.queue);
+    mangoh_bridge_queue_clear(&clientInfo->txBuff.queue);
     clientInfo->connected = false;
     clientInfo->connecting = false;
+    clientInfo->resolving = false;
+    clientInfo->generation++;
 
     if (clientInfo->sockFd != MANGOH_BRIDGE_SOCKETS_INVALID)
     {
@@ -785,15 +900,15 @@ cleanup:
     return res;
 }
 
-static int mangoh_bridge_sockets_checkClients(uint16_t idx, mangoh_bridge_sockets_client_t* clients)
+static int mangoh_bridge_sockets_checkClient(mangoh_bridge_sockets_client_info_t* clientInfo, uint32_t events)
 {
     int32_t res = LE_OK;
 
-    LE_ASSERT(clients);
+    LE_ASSERT(clientInfo);
 
-    if (FD_ISSET(clients->info[idx].sockFd, &clients->errfds))
+    if (events & EPOLLERR)
     {
-        res = mangoh_bridge_sockets_closeClient(&clients->info[idx]);
+        res = mangoh_bridge_sockets_closeClient(clientInfo);
         if (res != LE_OK)
         {
             LE_ERROR("ERROR mangoh_bridge_sockets_closeClient() failed(%d)", res);
@@ -803,16 +918,26 @@ static int mangoh_bridge_sockets_checkClients(uint16_t idx, mangoh_bridge_socket
         goto cleanup;
     }
 
-    if (FD_ISSET(clients->info[idx].sockFd, &clients->readfds))
+    if (events & (EPOLLIN | EPOLLHUP))
     {
-        uint8_t data[MANGOH_BRIDGE_SOCKETS_BUFF_LEN] = {0};
-        ssize_t bytesRx = recv(clients->info[idx].sockFd, data, MANGOH_BRIDGE_SOCKETS_BUFF_LEN, 0);
-        LE_DEBUG("socket[%u](%d) recv(%zd)", idx, clients->info[idx].sockFd, bytesRx);
-        if (bytesRx < 0)
+        ssize_t bytesRx = 0;
+        if (mangoh_bridge_queue_room(&clientInfo->rxBuff.queue))
+        {
+            struct iovec iov[MANGOH_BRIDGE_QUEUE_NUM_IOVS];
+            int iovcnt = mangoh_bridge_queue_writeIov(&clientInfo->rxBuff.queue, iov);
+            bytesRx = readv(clientInfo->sockFd, iov, iovcnt);
+            LE_DEBUG("socket(%d) recv(%zd)", clientInfo->sockFd, bytesRx);
+        }
+
+        if ((bytesRx < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)))
         {
-            LE_ERROR("ERROR recv() socket(%d) failed(%zd/%d)", clients->info[idx].sockFd, bytesRx, errno);
+            bytesRx = 0;
+        }
+        else if (bytesRx < 0)
+        {
+            LE_ERROR("ERROR recv() socket(%d) failed(%zd/%d)", clientInfo->sockFd, bytesRx, errno);
 
-            res = mangoh_bridge_sockets_closeClient(&clients->info[idx]);
+            res = mangoh_bridge_sockets_closeClient(clientInfo);
             if (res != LE_OK)
             {
                 LE_ERROR("ERROR mangoh_bridge_sockets_closeClient() failed(%d)", res);
@@ -822,147 +947,139 @@ static int mangoh_bridge_sockets_checkClients(uint16_t idx, mangoh_bridge_socket
             res = bytesRx;
             goto cleanup;
         }
-        else if (bytesRx > 0)
+        else if ((bytesRx == 0) && ((events & EPOLLHUP) || mangoh_bridge_queue_room(&clientInfo->rxBuff.queue)))
         {
-            if (clients->info[idx].rxBuff.len + bytesRx > MANGOH_BRIDGE_SOCKETS_BUFF_LEN)
-            {
-                LE_ERROR("ERROR socket[%u](%d) Rx buffer overflow", idx, clients->info[idx].sockFd);
-                res = LE_OVERFLOW;
-                goto cleanup;
-            }
-
-            memcpy(&clients->info[idx].rxBuff.data[clients->info[idx].rxBuff.len], data, bytesRx);
-            clients->info[idx].rxBuff.len += bytesRx;
-            LE_DEBUG("socket[%u](%d) Rx buffer length(%d)", idx, clients->info[idx].sockFd, clients->info[idx].rxBuff.len);
+            // Peer closed, keep the socket and any unread data until the MCU closes it
+            LE_INFO("socket(%d) closed by peer", clientInfo->sockFd);
+            mangoh_bridge_sockets_stopMonitor(clientInfo);
+            clientInfo->connected = false;
+            goto cleanup;
         }
+
+        mangoh_bridge_queue_produce(&clientInfo->rxBuff.queue, bytesRx);
+        LE_DEBUG("socket(%d) Rx buffer length(%u)", clientInfo->sockFd, mangoh_bridge_queue_len(&clientInfo->rxBuff.queue));
     }
 
-    if (FD_ISSET(clients->info[idx].sockFd, &clients->writefds))
+    if ((events & EPOLLOUT) && mangoh_bridge_queue_len(&clientInfo->txBuff.queue))
     {
-        LE_DEBUG("socket[%u](%d) Tx buffer length(%u)", idx, clients->info[idx].sockFd, clients->info[idx].txBuff.len);
-        if (clients->info[idx].txBuff.len)
+        struct iovec iov[MANGOH_BRIDGE_QUEUE_NUM_IOVS];
+        struct msghdr msg = { .msg_iov = iov };
+        msg.msg_iovlen = mangoh_bridge_queue_readIov(&clientInfo->txBuff.queue, iov, MANGOH_BRIDGE_SOCKETS_BUFF_LEN);
+        ssize_t bytesTx = sendmsg(clientInfo->sockFd, &msg, MSG_NOSIGNAL);
+        LE_DEBUG("socket(%d) send(%zd)", clientInfo->sockFd, bytesTx);
+        if ((bytesTx < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)))
         {
-            ssize_t bytesTx = send(clients->info[idx].sockFd, clients->info[idx].txBuff.data, clients->info[idx].txBuff.len, 0);
-            LE_DEBUG("socket[%u](%d) send(%zd)", idx, clients->info[idx].sockFd, bytesTx);
-            if (bytesTx < 0)
-            {
-                LE_ERROR("ERROR socket[%u](%d) send() failed(%zd/%d)", idx, clients->info[idx].sockFd, bytesTx, errno);
-
-                res = mangoh_bridge_sockets_closeClient(&clients->info[idx]);
-                if (res != LE_OK)
-                {
-                    LE_ERROR("ERROR mangoh_bridge_sockets_closeClient() failed(%d)", res);
-                    goto cleanup;
-                }
+            goto cleanup;
+        }
+        else if (bytesTx < 0)
+        {
+            LE_ERROR("ERROR socket(%d) send() failed(%zd/%d)", clientInfo->sockFd, bytesTx, errno);
 
-                res = LE_IO_ERROR;
+            res = mangoh_bridge_sockets_closeClient(clientInfo);
+            if (res != LE_OK)
+            {
+                LE_ERROR("ERROR mangoh_bridge_sockets_closeClient() failed(%d)", res);
                 goto cleanup;
             }
 
-            memmove(clients->info[idx].txBuff.data, &clients->info[idx].txBuff.data[bytesTx], clients->info[idx].txBuff.len - bytesTx);
-            clients->info[idx].txBuff.len -= bytesTx;
-            LE_DEBUG("socket[%u](%d) Tx buffer length(%u)", idx, clients->info[idx].sockFd, clients->info[idx].txBuff.len);
+            res = LE_IO_ERROR;
+            goto cleanup;
         }
+
+        mangoh_bridge_queue_consume(&clientInfo->txBuff.queue, bytesTx);
+        LE_DEBUG("socket(%d) Tx buffer length(%u)", clientInfo->sockFd, mangoh_bridge_queue_len(&clientInfo->txBuff.queue));
     }
 
 cleanup:
     return res;
 }
 
-static int mangoh_bridge_sockets_runner(void* param)
+static int mangoh_bridge_sockets_monitorClient(mangoh_bridge_sockets_client_info_t* clientInfo)
 {
-    mangoh_bridge_sockets_t* sockets = (mangoh_bridge_sockets_t*)param;
     int32_t res = LE_OK;
 
-    LE_ASSERT(sockets);
+    LE_ASSERT(clientInfo);
+    res = mangoh_bridge_reactor_add(&clientInfo->watch, clientInfo->sockFd, clientInfo->connecting ? EPOLLOUT:EPOLLIN,
+                                    mangoh_bridge_sockets_eventHandler, clientInfo);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_reactor_add() failed(%d)", res);
+        goto cleanup;
+    }
 
-    FD_ZERO(&sockets->clients.writefds);
-    FD_ZERO(&sockets->clients.errfds);
-    sockets->clients.maxSockFd = MANGOH_BRIDGE_SOCKETS_INVALID;
+cleanup:
+    return res;
+}
 
-    uint8_t idx = 0;
-    for (idx = 0; idx < MANGOH_BRIDGE_SOCKETS_MAX_CLIENTS; idx++)
+static void mangoh_bridge_sockets_stopMonitor(mangoh_bridge_sockets_client_info_t* clientInfo)
+{
+    LE_ASSERT(clientInfo);
+
+    mangoh_bridge_reactor_remove(&clientInfo->watch);
+}
+
+static void mangoh_bridge_sockets_updateEvents(mangoh_bridge_sockets_client_info_t* clientInfo)
+{
+    LE_ASSERT(clientInfo);
+
+    if (!mangoh_bridge_reactor_isRegistered(&clientInfo->watch))
     {
-        if ((sockets->clients.info[idx].sockFd != MANGOH_BRIDGE_SOCKETS_INVALID) && sockets->clients.info[idx].connecting)
-        {
-            FD_SET(sockets->clients.info[idx].sockFd, &sockets->clients.writefds);
-            FD_SET(sockets->clients.info[idx].sockFd, &sockets->clients.errfds);
-            sockets->clients.maxSockFd = (sockets->clients.info[idx].sockFd > sockets->clients.maxSockFd) ?
-                    sockets->clients.info[idx].sockFd:sockets->clients.maxSockFd;
-        }
+        return;
     }
 
-    if (sockets->clients.maxSockFd != MANGOH_BRIDGE_SOCKETS_INVALID)
+    // A connecting socket reports completion as writable, otherwise poll only for what can be serviced
+    if (clientInfo->connecting)
     {
-        struct timeval tv  = {0};
-        res = select(sockets->clients.maxSockFd + 1, NULL, &sockets->clients.writefds, &sockets->clients.errfds, &tv);
-        if (res < 0)
-        {
-            LE_ERROR("ERROR select() failed(%d/%d)", res, errno);
-            res = LE_IO_ERROR;
-            goto cleanup;
-        }
-
-        for (idx = 0; idx < MANGOH_BRIDGE_SOCKETS_MAX_CLIENTS; idx++)
-        {
-            if ((sockets->clients.info[idx].sockFd != MANGOH_BRIDGE_SOCKETS_INVALID) &&
-                (FD_ISSET(sockets->clients.info[idx].sockFd, &sockets->clients.writefds)) &&
-                sockets->clients.info[idx].connecting)
-            {
-                res = mangoh_bridge_sockets_checkConnections(&sockets->clients.info[idx]);
-                if (res != LE_OK)
-                {
-                    LE_ERROR("ERROR mangoh_bridge_sockets_checkConnections() failed(%d)", res);
-                    goto cleanup;
-                }
-            }
-        }
+        mangoh_bridge_reactor_disable(&clientInfo->watch, EPOLLIN);
+        mangoh_bridge_reactor_enable(&clientInfo->watch, EPOLLOUT);
+        return;
     }
 
-    FD_ZERO(&sockets->clients.readfds);
-    FD_ZERO(&sockets->clients.writefds);
-    FD_ZERO(&sockets->clients.errfds);
-    sockets->clients.maxSockFd = MANGOH_BRIDGE_SOCKETS_INVALID;
+    if (mangoh_bridge_queue_room(&clientInfo->rxBuff.queue))
+    {
+        mangoh_bridge_reactor_enable(&clientInfo->watch, EPOLLIN);
+    }
+    else
+    {
+        mangoh_bridge_reactor_disable(&clientInfo->watch, EPOLLIN);
+    }
 
-    for (idx = 0; idx < MANGOH_BRIDGE_SOCKETS_MAX_CLIENTS; idx++)
+    if (mangoh_bridge_queue_len(&clientInfo->txBuff.queue))
     {
-        if ((sockets->clients.info[idx].sockFd != MANGOH_BRIDGE_SOCKETS_INVALID) && sockets->clients.info[idx].connected)
-        {
-            FD_SET(sockets->clients.info[idx].sockFd, &sockets->clients.readfds);
-            FD_SET(sockets->clients.info[idx].sockFd, &sockets->clients.writefds);
-            FD_SET(sockets->clients.info[idx].sockFd, &sockets->clients.errfds);
-            sockets->clients.maxSockFd = (sockets->clients.info[idx].sockFd > sockets->clients.maxSockFd) ?
-                    sockets->clients.info[idx].sockFd:sockets->clients.maxSockFd;
-        }
+        mangoh_bridge_reactor_enable(&clientInfo->watch, EPOLLOUT);
+    }
+    else
+    {
+        mangoh_bridge_reactor_disable(&clientInfo->watch, EPOLLOUT);
     }
+}
+
+static void mangoh_bridge_sockets_eventHandler(mangoh_bridge_reactor_watch_t* watch, uint32_t events)
+{
+    mangoh_bridge_sockets_client_info_t* clientInfo = watch->context;
+    int32_t res = LE_OK;
 
-    if (sockets->clients.maxSockFd != MANGOH_BRIDGE_SOCKETS_INVALID)
+    LE_ASSERT(clientInfo);
+    LE_ASSERT(clientInfo->sockFd == watch->fd);
+
+    if (clientInfo->connecting)
     {
-        struct timeval tv  = {0};
-        res = select(sockets->clients.maxSockFd + 1, &sockets->clients.readfds, &sockets->clients.writefds, &sockets->clients.errfds, &tv);
-        if (res < 0)
+        res = mangoh_bridge_sockets_checkConnections(clientInfo);
+        if (res != LE_OK)
         {
-            LE_ERROR("ERROR select() failed(%d/%d)", res, errno);
-            res = LE_IO_ERROR;
-            goto cleanup;
+            LE_ERROR("ERROR mangoh_bridge_sockets_checkConnections() failed(%d)", res);
         }
-
-        for (idx = 0; idx < MANGOH_BRIDGE_SOCKETS_MAX_CLIENTS; idx++)
+    }
+    else if (clientInfo->connected)
+    {
+        res = mangoh_bridge_sockets_checkClient(clientInfo, events);
+        if (res != LE_OK)
         {
-            if ((sockets->clients.info[idx].sockFd != MANGOH_BRIDGE_SOCKETS_INVALID) && (sockets->clients.info[idx].connected))
-            {
-                res = mangoh_bridge_sockets_checkClients(idx, &sockets->clients);
-                if (res != LE_OK)
-                {
-                    LE_ERROR("ERROR mangoh_bridge_sockets_checkClients() failed(%d)", res);
-                    goto cleanup;
-                }
-            }
+            LE_ERROR("ERROR mangoh_bridge_sockets_checkClient() failed(%d)", res);
         }
     }
 
-cleanup:
-    return res;
+    mangoh_bridge_sockets_updateEvents(clientInfo);
 }
 
 static int mangoh_bridge_sockets_reset(void* param)
@@ -975,37 +1092,19 @@ static int mangoh_bridge_sockets_reset(void* param)
     uint8_t idx = 0;
     for (idx = 0; idx < MANGOH_BRIDGE_SOCKETS_MAX_CLIENTS; idx++)
     {
-        if (sockets->clients.info[idx].sockFd != MANGOH_BRIDGE_SOCKETS_INVALID)
+        res = mangoh_bridge_sockets_closeClient(&sockets->clients.info[idx]);
+        if (res != LE_OK)
         {
-            LE_DEBUG("close socket[%u](%d)", idx, sockets->clients.info[idx].sockFd);
-            res = close(sockets->clients.info[idx].sockFd);
-            if (res < 0)
-            {
-                LE_ERROR("ERROR close() failed(%d/%d)", res, errno);
-                res = LE_IO_ERROR;
-                goto cleanup;
-            }
-
-            sockets->clients.info[idx].sockFd = MANGOH_BRIDGE_SOCKETS_INVALID;
-            sockets->clients.info[idx].rxBuff.len = 0;
-            sockets->clients.info[idx].txBuff.len = 0;
-            sockets->clients.info[idx].connecting = false;
-            sockets->clients.info[idx].connected = false;
+            LE_ERROR("ERROR mangoh_bridge_sockets_closeClient() failed(%d)", res);
+            goto cleanup;
         }
     }
 
-    if (sockets->server.sockFd != MANGOH_BRIDGE_SOCKETS_INVALID)
+    res = mangoh_bridge_sockets_closeServer(&sockets->server);
+    if (res != LE_OK)
     {
-        LE_DEBUG("close server socket(%d)", sockets->server.sockFd);
-        res = close(sockets->server.sockFd);
-        if (res < 0)
-        {
-            LE_ERROR("ERROR close() failed(%d/%d)", res, errno);
-            res = LE_IO_ERROR;
-            goto cleanup;
-        }
-
-        sockets->server.sockFd = MANGOH_BRIDGE_SOCKETS_INVALID;
+        LE_ERROR("ERROR mangoh_bridge_sockets_closeServer() failed(%d)", res);
+        goto cleanup;
     }
 
 cleanup:
@@ -1027,7 +1126,10 @@ int mangoh_bridge_sockets_init(mangoh_bridge_sockets_t* sockets, void* bridge)
     uint32_t idx = 0;
     for (idx = 0; idx < MANGOH_BRIDGE_SOCKETS_MAX_CLIENTS; idx++)
     {
-        sockets->clients.info[idx].sockFd = MANGOH_BRIDGE_SOCKETS_INVALID;
+        mangoh_bridge_sockets_client_info_t* clientInfo = &sockets->clients.info[idx];
+        clientInfo->sockFd = MANGOH_BRIDGE_SOCKETS_INVALID;
+        mangoh_bridge_queue_init(&clientInfo->rxBuff.queue, clientInfo->rxBuff.data, sizeof(clientInfo->rxBuff.data));
+        mangoh_bridge_queue_init(&clientInfo->txBuff.queue, clientInfo->txBuff.data, sizeof(clientInfo->txBuff.data));
     }
 
     res = mangoh_bridge_registerCommandProcessor(sockets->bridge, MANGOH_BRIDGE_SOCKETS_LISTEN, sockets, mangoh_bridge_sockets_listen);
@@ -1093,13 +1195,6 @@ int mangoh_bridge_sockets_init(mangoh_bridge_sockets_t* sockets, void* bridge)
         goto cleanup;
     }
 
-    res = mangoh_bridge_registerRunner(sockets->bridge, sockets, mangoh_bridge_sockets_runner);
-    if (res != LE_OK)
-    {
-        LE_ERROR("ERROR mangoh_bridge_registerRunner() failed(%d)", res);
-        goto cleanup;
-    }
-
     res = mangoh_bridge_registerReset(sockets->bridge, sockets, mangoh_bridge_sockets_reset);
     if (res != LE_OK)
     {
@@ -10,6 +10,9 @@
  *
  * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
  */
+#include "reactor.h"
+#include "queue.h"
+
 #ifndef MANGOH_BRIDGE_SOCKETS_INCLUDE_GUARD
 #define MANGOH_BRIDGE_SOCKETS_INCLUDE_GUARD
 
@@ -117,8 +120,8 @@ typedef struct _mangoh_bridge_sockets_read_rsp_t
 
 typedef struct _mangoh_bridge_sockets_buff_t
 {
-    uint8_t  data[MANGOH_BRIDGE_SOCKETS_BUFF_LEN];
-    uint16_t len;
+    uint8_t               data[MANGOH_BRIDGE_SOCKETS_BUFF_LEN];
+    mangoh_bridge_queue_t queue;
 } mangoh_bridge_sockets_buff_t;
 
 //------------------------------------------------------------------------------------------------------------------
@@ -128,7 +131,6 @@ typedef struct _mangoh_bridge_sockets_buff_t
 //------------------------------------------------------------------------------------------------------------------
 typedef struct _mangoh_bridge_sockets_server_t
 {
-    fd_set   readfds; ///< Read fd set
     int32_t  sockFd;  ///< Socket fd
     uint16_t port;    ///< Server port
 } mangoh_bridge_sockets_server_t;
@@ -142,10 +144,13 @@ typedef struct _mangoh_bridge_sockets_client_info_t
 {
     mangoh_bridge_sockets_buff_t rxBuff;       ///< Receive buffer
     mangoh_bridge_sockets_buff_t txBuff;       ///< Send buffer
+    mangoh_bridge_reactor_watch_t watch;       ///< Socket event registration
     int32_t                      sockFd;       ///< Socket fd
+    uint32_t                     generation;   ///< Bumped on close, a resolve started before it is stale
     uint8_t                      connected:1;  ///< Connected flag
     uint8_t                      connecting:1; ///< Connecting flag
-    uint8_t                      reserved:6;
+    uint8_t                      resolving:1;  ///< Connect request waiting for the server address
+    uint8_t                      reserved:5;
 } mangoh_bridge_sockets_client_info_t;
 
 //------------------------------------------------------------------------------------------------------------------
@@ -156,10 +161,6 @@ typedef struct _mangoh_bridge_sockets_client_info_t
 typedef struct _mangoh_bridge_sockets_client_t
 {
     mangoh_bridge_sockets_client_info_t info[MANGOH_BRIDGE_SOCKETS_MAX_CLIENTS]; ///< List of client sockets
-    fd_set                              readfds;                                 ///< Read fd set
-    fd_set                              writefds;                                ///< Write fd set
-    fd_set                              errfds;                                  ///< Error fd set
-    int32_t                             maxSockFd;                               ///< Maximum socket fd
     uint8_t                             nextId;                                  ///< Next client ID
 } mangoh_bridge_sockets_client_t;
 
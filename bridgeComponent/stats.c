@@ -0,0 +1,139 @@
+/**
+ * @file
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless, Inc. Use of this work is subject to license.
+ */
+
+#include <inttypes.h>
+#include "legato.h"
+#include "stats.h"
+
+static le_log_TraceRef_t StatsTraceRef;
+
+void mangoh_bridge_stats_begin(mangoh_bridge_stats_t* stats, uint8_t cmd, uint32_t bytesIn)
+{
+    LE_ASSERT(stats);
+
+    if (!LE_IS_TRACE_ENABLED(StatsTraceRef))
+    {
+        stats->current = MANGOH_BRIDGE_STATS_CMD_NONE;
+        return;
+    }
+
+    stats->current = cmd;
+    stats->cmd[cmd].calls++;
+    stats->cmd[cmd].bytesIn += bytesIn;
+    clock_gettime(CLOCK_MONOTONIC, &stats->start);
+}
+
+void mangoh_bridge_stats_addBytesOut(mangoh_bridge_stats_t* stats, uint32_t bytesOut)
+{
+    LE_ASSERT(stats);
+
+    if (stats->current != MANGOH_BRIDGE_STATS_CMD_NONE)
+    {
+        stats->cmd[stats->current].bytesOut += bytesOut;
+    }
+}
+
+void mangoh_bridge_stats_addNack(mangoh_bridge_stats_t* stats)
+{
+    LE_ASSERT(stats);
+
+    if (stats->current != MANGOH_BRIDGE_STATS_CMD_NONE)
+    {
+        stats->cmd[stats->current].nacks++;
+    }
+}
+
+void mangoh_bridge_stats_suspend(mangoh_bridge_stats_t* stats, int32_t* cmd, struct timespec* start)
+{
+    LE_ASSERT(stats);
+    LE_ASSERT(cmd);
+    LE_ASSERT(start);
+
+    *cmd = stats->current;
+    *start = stats->start;
+    stats->current = MANGOH_BRIDGE_STATS_CMD_NONE;
+}
+
+void mangoh_bridge_stats_resume(mangoh_bridge_stats_t* stats, int32_t cmd, const struct timespec* start)
+{
+    LE_ASSERT(stats);
+    LE_ASSERT(start);
+
+    stats->current = LE_IS_TRACE_ENABLED(StatsTraceRef) ? cmd:MANGOH_BRIDGE_STATS_CMD_NONE;
+    stats->start = *start;
+}
+
+void mangoh_bridge_stats_end(mangoh_bridge_stats_t* stats, int32_t result)
+{
+    LE_ASSERT(stats);
+
+    if (stats->current == MANGOH_BRIDGE_STATS_CMD_NONE)
+    {
+        return;
+    }
+
+    mangoh_bridge_cmd_stats_t* cmdStats = &stats->cmd[stats->current];
+    stats->current = MANGOH_BRIDGE_STATS_CMD_NONE;
+
+    struct timespec now = {0};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    uint64_t elapsedUs = (uint64_t)(now.tv_sec - stats->start.tv_sec) * 1000000 + (now.tv_nsec - stats->start.tv_nsec) / 1000;
+    uint32_t bucket = 0;
+    while ((bucket < MANGOH_BRIDGE_STATS_HIST_BUCKETS - 1) && (elapsedUs >> bucket))
+    {
+        bucket++;
+    }
+
+    cmdStats->hist[bucket]++;
+    cmdStats->totalUs += elapsedUs;
+    cmdStats->maxUs = (elapsedUs > cmdStats->maxUs) ? elapsedUs:cmdStats->maxUs;
+    if (result != LE_OK)
+    {
+        cmdStats->errors++;
+    }
+}
+
+void mangoh_bridge_stats_dump(const mangoh_bridge_stats_t* stats, const char* name)
+{
+    LE_ASSERT(stats);
+    LE_ASSERT(name);
+
+    uint32_t cmd = 0;
+    for (cmd = 0; cmd < MANGOH_BRIDGE_STATS_NUMBER_OF_COMMANDS; cmd++)
+    {
+        const mangoh_bridge_cmd_stats_t* cmdStats = &stats->cmd[cmd];
+        if (!cmdStats->calls)
+        {
+            continue;
+        }
+
+        LE_INFO("'%s' command(0x%02x) calls(%" PRIu64 ") errors(%" PRIu64 ") NACKs(%" PRIu64 ") in(%" PRIu64 ") out(%" PRIu64 ") avg(%" PRIu64 " us) max(%u us)",
+                name, cmd, cmdStats->calls, cmdStats->errors, cmdStats->nacks, cmdStats->bytesIn, cmdStats->bytesOut,
+                cmdStats->totalUs / cmdStats->calls, cmdStats->maxUs);
+
+        char hist[MANGOH_BRIDGE_STATS_HIST_BUCKETS * 12] = {0};
+        uint32_t len = 0;
+        uint32_t bucket = 0;
+        for (bucket = 0; bucket < MANGOH_BRIDGE_STATS_HIST_BUCKETS; bucket++)
+        {
+            len += snprintf(&hist[len], sizeof(hist) - len, " %u", cmdStats->hist[bucket]);
+        }
+
+        LE_INFO("'%s' command(0x%02x) latency log2(us) histogram:%s", name, cmd, hist);
+    }
+}
+
+void mangoh_bridge_stats_init(mangoh_bridge_stats_t* stats)
+{
+    LE_ASSERT(stats);
+
+    StatsTraceRef = le_log_GetTraceRef(MANGOH_BRIDGE_STATS_TRACE_KEYWORD);
+    memset(stats, 0, sizeof(mangoh_bridge_stats_t));
+    stats->current = MANGOH_BRIDGE_STATS_CMD_NONE;
+}
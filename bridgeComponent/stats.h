@@ -0,0 +1,64 @@
+/*
+ * @file mangoh_bridge_stats.h
+ *
+ * Arduino bridge command statistics module.
+ *
+ * Per command counters and latency histograms collected by the command dispatcher.  Collection is controlled by the
+ * "BridgeStats" trace keyword (e.g. "log trace BridgeStats") so a disabled bridge only pays one flag test per command.
+ * Latency is measured from the parsed request to the response being written, bucket n counts the commands that took
+ * less than 2^n microseconds, the last bucket holds everything slower.  A deferred command is suspended when its
+ * processor returns and resumed when its response is completed.  Send SIGUSR1 to log the collected values.
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+#include "legato.h"
+
+#ifndef MANGOH_BRIDGE_STATS_INCLUDE_GUARD
+#define MANGOH_BRIDGE_STATS_INCLUDE_GUARD
+
+#define MANGOH_BRIDGE_STATS_TRACE_KEYWORD         "BridgeStats"
+#define MANGOH_BRIDGE_STATS_NUMBER_OF_COMMANDS    256
+#define MANGOH_BRIDGE_STATS_HIST_BUCKETS          21
+#define MANGOH_BRIDGE_STATS_CMD_NONE              -1
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Single command statistics
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_cmd_stats_t
+{
+    uint64_t calls;                                   ///< Number of requests processed
+    uint64_t errors;                                  ///< Number of failed command processors
+    uint64_t nacks;                                   ///< Number of NACK responses
+    uint64_t bytesIn;                                 ///< Request payload bytes
+    uint64_t bytesOut;                                ///< Response payload bytes, before compression
+    uint64_t totalUs;                                 ///< Accumulated latency
+    uint32_t maxUs;                                   ///< Worst latency
+    uint32_t hist[MANGOH_BRIDGE_STATS_HIST_BUCKETS];  ///< Log2 latency histogram
+} mangoh_bridge_cmd_stats_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Command statistics
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_stats_t
+{
+    mangoh_bridge_cmd_stats_t cmd[MANGOH_BRIDGE_STATS_NUMBER_OF_COMMANDS]; ///< Statistics indexed by command
+    struct timespec           start;                                       ///< Current command start time
+    int32_t                   current;                                     ///< Command being measured or NONE
+} mangoh_bridge_stats_t;
+
+void mangoh_bridge_stats_begin(mangoh_bridge_stats_t*, uint8_t, uint32_t);
+void mangoh_bridge_stats_addBytesOut(mangoh_bridge_stats_t*, uint32_t);
+void mangoh_bridge_stats_addNack(mangoh_bridge_stats_t*);
+void mangoh_bridge_stats_suspend(mangoh_bridge_stats_t*, int32_t*, struct timespec*);
+void mangoh_bridge_stats_resume(mangoh_bridge_stats_t*, int32_t, const struct timespec*);
+void mangoh_bridge_stats_end(mangoh_bridge_stats_t*, int32_t);
+void mangoh_bridge_stats_dump(const mangoh_bridge_stats_t*, const char*);
+void mangoh_bridge_stats_init(mangoh_bridge_stats_t*);
+
+#endif
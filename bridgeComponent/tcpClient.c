@@ -11,9 +11,11 @@
 #include "tcpClient.h"
 
 static int mangoh_bridge_tcp_client_close(mangoh_bridge_tcp_client_info_t*);
-static int mangoh_bridge_tcp_client_broadcast(mangoh_bridge_tcp_client_t*, uint32_t);
-static int mangoh_bridge_tcp_client_readFromSockets(mangoh_bridge_tcp_client_t*);
-static int mangoh_bridge_tcp_client_writeToSockets(mangoh_bridge_tcp_client_t*);
+static int mangoh_bridge_tcp_client_broadcast(mangoh_bridge_tcp_client_t*, uint32_t, const int8_t*, uint32_t);
+static void mangoh_bridge_tcp_client_updateEvents(mangoh_bridge_tcp_client_info_t*);
+static int mangoh_bridge_tcp_client_readFromSocket(mangoh_bridge_tcp_client_info_t*);
+static int mangoh_bridge_tcp_client_writeToSocket(mangoh_bridge_tcp_client_info_t*);
+static void mangoh_bridge_tcp_client_eventHandler(mangoh_bridge_reactor_watch_t*, uint32_t);
 static int mangoh_bridge_tcp_client_dropStarvingClients(mangoh_bridge_tcp_client_t*);
 
 static int mangoh_bridge_tcp_client_close(mangoh_bridge_tcp_client_info_t* tcpClientInfo)
@@ -22,12 +24,18 @@ static int mangoh_bridge_tcp_client_close(mangoh_bridge_tcp_client_info_t* tcpCl
 
     LE_ASSERT(tcpClientInfo);
 
+    if (tcpClientInfo->sockFd == MANGOH_BRIDGE_TCP_CLIENT_SOCKET_INVALID)
+    {
+        goto cleanup;
+    }
+
+    mangoh_bridge_reactor_remove(&tcpClientInfo->watch);
+
     res = close(tcpClientInfo->sockFd);
     if (res < 0)
     {
         LE_ERROR("ERROR socket(%d) close() failed(%d/%d)", tcpClientInfo->sockFd, res, errno);
         res = LE_IO_ERROR;
-        goto cleanup;
     }
 
     if (tcpClientInfo->sendBuffer)
@@ -36,25 +44,27 @@ static int mangoh_bridge_tcp_client_close(mangoh_bridge_tcp_client_info_t* tcpCl
         tcpClientInfo->sendBuffer = NULL;
     }
 
+    mangoh_bridge_queue_init(&tcpClientInfo->sendQueue, NULL, 0);
+
     if (tcpClientInfo->rxBuffer)
     {
         free(tcpClientInfo->rxBuffer);
         tcpClientInfo->rxBuffer = NULL;
     }
 
-    tcpClientInfo->sendBuffLen = 0;
+    tcpClientInfo->recvBuffLen = 0;
     tcpClientInfo->sockFd = MANGOH_BRIDGE_TCP_CLIENT_SOCKET_INVALID;
-    res = LE_OK;
 
 cleanup:
     return res;
 }
 
-static int mangoh_bridge_tcp_client_broadcast(mangoh_bridge_tcp_client_t* tcpClients, uint32_t from)
+static int mangoh_bridge_tcp_client_broadcast(mangoh_bridge_tcp_client_t* tcpClients, uint32_t from, const int8_t* data, uint32_t len)
 {
     int32_t res = LE_OK;
 
     LE_ASSERT(tcpClients);
+    LE_ASSERT(data);
 
     uint32_t idx = 0;
     for (idx = 0; idx < MANGOH_BRIDGE_TCP_CLIENT_MAX_CLIENTS; idx++)
@@ -64,16 +74,17 @@ static int mangoh_bridge_tcp_client_broadcast(mangoh_bridge_tcp_client_t* tcpCli
             LE_DEBUG("socket[%u](%d)", idx, tcpClients->info[idx].sockFd);
             LE_ASSERT(tcpClients->info[idx].sendBuffer != NULL);
 
-            if (tcpClients->info[idx].sendBuffLen + tcpClients->info[from].sendBuffLen > MANGOH_BRIDGE_TCP_CLIENT_SEND_BUFFER_LEN)
+            if (len > mangoh_bridge_queue_room(&tcpClients->info[idx].sendQueue))
             {
                 LE_ERROR("ERROR client(%u) send buffer overflow", idx);
                 res = LE_OVERFLOW;
                 goto cleanup;
             }
 
-            memcpy(tcpClients->info[idx].sendBuffer + tcpClients->info[idx].sendBuffLen, tcpClients->info[from].rxBuffer, tcpClients->info[from].recvBuffLen);
-            tcpClients->info[idx].sendBuffLen += tcpClients->info[from].recvBuffLen;
-            LE_DEBUG("socket[%u](%d) send(%u)", idx, tcpClients->info[idx].sockFd, tcpClients->info[idx].sendBuffLen);
+            mangoh_bridge_queue_write(&tcpClients->info[idx].sendQueue, data, len);
+            LE_DEBUG("socket[%u](%d) send(%u)", idx, tcpClients->info[idx].sockFd, mangoh_bridge_queue_len(&tcpClients->info[idx].sendQueue));
+
+            mangoh_bridge_tcp_client_updateEvents(&tcpClients->info[idx]);
         }
     }
 
@@ -81,178 +92,196 @@ cleanup:
     return res;
 }
 
-static int mangoh_bridge_tcp_client_readFromSockets(mangoh_bridge_tcp_client_t* tcpClients)
+static void mangoh_bridge_tcp_client_updateEvents(mangoh_bridge_tcp_client_info_t* tcpClientInfo)
 {
-    int32_t res = LE_OK;
+    LE_ASSERT(tcpClientInfo);
 
-    LE_ASSERT(tcpClients);
+    if (!mangoh_bridge_reactor_isRegistered(&tcpClientInfo->watch))
+    {
+        return;
+    }
 
-    tcpClients->maxSockFd = MANGOH_BRIDGE_TCP_CLIENT_SOCKET_INVALID;
-    FD_ZERO(&tcpClients->readfds);
+    // Only poll for what can be serviced: stop reading while the receive buffer is full, write while data is queued
+    if (tcpClientInfo->recvBuffLen < MANGOH_BRIDGE_TCP_CLIENT_RECV_BUFFER_LEN)
+    {
+        mangoh_bridge_reactor_enable(&tcpClientInfo->watch, EPOLLIN);
+    }
+    else
+    {
+        mangoh_bridge_reactor_disable(&tcpClientInfo->watch, EPOLLIN);
+    }
 
-    uint32_t idx = 0;
-    for (idx = 0; idx < MANGOH_BRIDGE_TCP_CLIENT_MAX_CLIENTS; idx++)
+    if (mangoh_bridge_queue_len(&tcpClientInfo->sendQueue) > 0)
     {
-        if (tcpClients->info[idx].sockFd != MANGOH_BRIDGE_TCP_CLIENT_SOCKET_INVALID)
-        {
-            FD_SET(tcpClients->info[idx].sockFd, &tcpClients->readfds);
-            tcpClients->maxSockFd = (tcpClients->info[idx].sockFd > tcpClients->maxSockFd) ? tcpClients->info[idx].sockFd:tcpClients->maxSockFd;
-        }
+        mangoh_bridge_reactor_enable(&tcpClientInfo->watch, EPOLLOUT);
+    }
+    else
+    {
+        mangoh_bridge_reactor_disable(&tcpClientInfo->watch, EPOLLOUT);
     }
+}
+
+static int mangoh_bridge_tcp_client_readFromSocket(mangoh_bridge_tcp_client_info_t* tcpClientInfo)
+{
+    mangoh_bridge_tcp_client_t* tcpClients = tcpClientInfo->clients;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(tcpClients);
+    LE_ASSERT(tcpClientInfo->rxBuffer != NULL);
 
-    if (tcpClients->maxSockFd == MANGOH_BRIDGE_TCP_CLIENT_SOCKET_INVALID)
+    const uint32_t idx = tcpClientInfo - tcpClients->info;
+    const uint32_t offset = tcpClientInfo->recvBuffLen;
+    int32_t bytesRead = recv(tcpClientInfo->sockFd, tcpClientInfo->rxBuffer + offset, MANGOH_BRIDGE_TCP_CLIENT_RECV_BUFFER_LEN - offset, 0);
+    if ((bytesRead < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)))
     {
         goto cleanup;
     }
-
-    struct timeval tv  = {0};
-    res = select(tcpClients->maxSockFd + 1, &tcpClients->readfds, NULL, NULL, &tv);
-    if (res < 0)
+    else if (bytesRead < 0)
     {
-        LE_ERROR("ERROR select() failed(%d/%d)", res, errno);
+        LE_ERROR("ERROR socket[%u](%d) recv() failed(%d/%d)", idx, tcpClientInfo->sockFd, bytesRead, errno);
+
+        res = mangoh_bridge_tcp_client_close(tcpClientInfo);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_tcp_client_close() failed(%d)", res);
+            goto cleanup;
+        }
+
         res = LE_IO_ERROR;
         goto cleanup;
     }
+    else if (bytesRead == 0)
+    {
+        LE_INFO("socket[%u](%d) closed", idx, tcpClientInfo->sockFd);
+
+        res = mangoh_bridge_tcp_client_close(tcpClientInfo);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_tcp_client_close() failed(%d)", res);
+            goto cleanup;
+        }
+
+        goto cleanup;
+    }
+
+    LE_DEBUG("socket[%u](%d) read(%u)", idx, tcpClientInfo->sockFd, bytesRead);
+    tcpClientInfo->recvBuffLen += bytesRead;
+    LE_DEBUG("Rx buffer(%u)", tcpClientInfo->recvBuffLen);
 
-    if (res > 0)
+    if (tcpClients->broadcast)
     {
-        for (idx = 0; idx < MANGOH_BRIDGE_TCP_CLIENT_MAX_CLIENTS; idx++)
+        res = mangoh_bridge_tcp_client_broadcast(tcpClients, idx, tcpClientInfo->rxBuffer + offset, bytesRead);
+        if (res)
         {
-            if ((tcpClients->info[idx].sockFd != MANGOH_BRIDGE_TCP_CLIENT_SOCKET_INVALID) &&
-                (FD_ISSET(tcpClients->info[idx].sockFd, &tcpClients->readfds)))
-            {
-                LE_ASSERT(tcpClients->info[idx].rxBuffer != NULL);
-
-                int32_t bytesRead = recv(tcpClients->info[idx].sockFd, tcpClients->info[idx].rxBuffer + tcpClients->info[idx].recvBuffLen,
-                                         MANGOH_BRIDGE_TCP_CLIENT_RECV_BUFFER_LEN - tcpClients->info[idx].recvBuffLen, 0);
-                if (bytesRead < 0)
-                {
-                    LE_ERROR("ERROR socket[%u](%d) recv() failed(%d/%d)", idx, tcpClients->info[idx].sockFd, bytesRead, errno);
-
-                    res = mangoh_bridge_tcp_client_close(&tcpClients->info[idx]);
-                    if (res != LE_OK)
-                    {
-                        LE_ERROR("ERROR mangoh_bridge_tcp_client_close() failed(%d)", res);
-                        goto cleanup;
-                    }
-
-                    res = LE_IO_ERROR;
-                    goto cleanup;
-                }
-                else if ((bytesRead == 0) && (MANGOH_BRIDGE_TCP_CLIENT_RECV_BUFFER_LEN - tcpClients->info[idx].recvBuffLen > 0))
-                {
-                    LE_INFO("socket[%u](%d) closed", idx, tcpClients->info[idx].sockFd);
-
-                    res = mangoh_bridge_tcp_client_close(&tcpClients->info[idx]);
-                    if (res != LE_OK)
-                    {
-                            LE_ERROR("ERROR mangoh_bridge_tcp_client_close() failed(%d)", res);
-                            goto cleanup;
-                    }
-                }
-                else
-                {
-                    LE_DEBUG("socket[%u](%d) read(%u)", idx, tcpClients->info[idx].sockFd, bytesRead);
-                    tcpClients->info[idx].recvBuffLen += bytesRead;
-                    LE_DEBUG("Rx buffer(%u)", tcpClients->info[idx].recvBuffLen);
-
-                    if (tcpClients->broadcast)
-                    {
-                        res = mangoh_bridge_tcp_client_broadcast(tcpClients, idx);
-                        if (res)
-                        {
-                            LE_ERROR("ERROR mangoh_bridge_tcp_client_broadcast() failed(%d)", res);
-                            goto cleanup;
-                        }
-                    }
-                }
-
-                FD_CLR(tcpClients->info[idx].sockFd, &tcpClients->readfds);
-            }
+            LE_ERROR("ERROR mangoh_bridge_tcp_client_broadcast() failed(%d)", res);
+            goto cleanup;
         }
     }
 
-    res = LE_OK;
+    if (tcpClients->recvHandler)
+    {
+        res = tcpClients->recvHandler(tcpClients->recvContext);
+        if (res)
+        {
+            LE_ERROR("ERROR receive handler failed(%d)", res);
+            goto cleanup;
+        }
+    }
 
 cleanup:
     return res;
 }
 
-static int mangoh_bridge_tcp_client_writeToSockets(mangoh_bridge_tcp_client_t* tcpClient)
+static int mangoh_bridge_tcp_client_writeToSocket(mangoh_bridge_tcp_client_info_t* tcpClientInfo)
 {
     int32_t res = LE_OK;
 
-    LE_ASSERT(tcpClient);
-
-    FD_ZERO(&tcpClient->writefds);
-    tcpClient->maxSockFd = MANGOH_BRIDGE_TCP_CLIENT_SOCKET_INVALID;
+    LE_ASSERT(tcpClientInfo->sendBuffer != NULL);
 
-    uint32_t idx = 0;
-    for (idx = 0; idx < MANGOH_BRIDGE_TCP_CLIENT_MAX_CLIENTS; idx++)
+    if (!mangoh_bridge_queue_len(&tcpClientInfo->sendQueue))
     {
-        if (tcpClient->info[idx].sockFd != MANGOH_BRIDGE_TCP_CLIENT_SOCKET_INVALID)
-        {
-            FD_SET(tcpClient->info[idx].sockFd, &tcpClient->writefds);
-            tcpClient->maxSockFd = (tcpClient->info[idx].sockFd > tcpClient->maxSockFd) ? tcpClient->info[idx].sockFd:tcpClient->maxSockFd;
-        }
+        goto cleanup;
     }
 
-    if (tcpClient->maxSockFd == MANGOH_BRIDGE_TCP_CLIENT_SOCKET_INVALID)
+    LE_DEBUG("socket(%d) send(%u)", tcpClientInfo->sockFd, mangoh_bridge_queue_len(&tcpClientInfo->sendQueue));
+    struct iovec iov[MANGOH_BRIDGE_QUEUE_NUM_IOVS];
+    struct msghdr msg = { .msg_iov = iov };
+    msg.msg_iovlen = mangoh_bridge_queue_readIov(&tcpClientInfo->sendQueue, iov, MANGOH_BRIDGE_TCP_CLIENT_SEND_BUFFER_LEN);
+    int32_t bytesSent = sendmsg(tcpClientInfo->sockFd, &msg, MSG_NOSIGNAL);
+    if ((bytesSent < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)))
     {
         goto cleanup;
     }
-
-    struct timeval tv  = {0};
-    res = select(tcpClient->maxSockFd + 1, NULL, &tcpClient->writefds, NULL, &tv);
-    if (res < 0)
+    else if (bytesSent < 0)
     {
-        LE_ERROR("ERROR select() failed(%d/%d)", res, errno);
-        res = LE_IO_ERROR;
+        LE_WARN("WARNING socket(%d) send() failed(%d/%d)", tcpClientInfo->sockFd, bytesSent, errno);
+
+        res = mangoh_bridge_tcp_client_close(tcpClientInfo);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_tcp_client_close() failed(%d)", res);
+            goto cleanup;
+        }
+
         goto cleanup;
     }
 
-    if (res > 0)
+    LE_DEBUG("socket(%d) sent(%u)", tcpClientInfo->sockFd, bytesSent);
+    mangoh_bridge_queue_consume(&tcpClientInfo->sendQueue, bytesSent);
+
+cleanup:
+    return res;
+}
+
+static void mangoh_bridge_tcp_client_eventHandler(mangoh_bridge_reactor_watch_t* watch, uint32_t events)
+{
+    mangoh_bridge_tcp_client_info_t* tcpClientInfo = watch->context;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(tcpClientInfo);
+    LE_ASSERT(tcpClientInfo->sockFd == watch->fd);
+
+    if (events & (EPOLLIN | EPOLLHUP | EPOLLERR))
     {
-        for (idx = 0; idx < MANGOH_BRIDGE_TCP_CLIENT_MAX_CLIENTS; idx++)
+        if (tcpClientInfo->recvBuffLen < MANGOH_BRIDGE_TCP_CLIENT_RECV_BUFFER_LEN)
+        {
+            res = mangoh_bridge_tcp_client_readFromSocket(tcpClientInfo);
+            if (res != LE_OK)
+            {
+                LE_ERROR("ERROR mangoh_bridge_tcp_client_readFromSocket() failed(%d)", res);
+            }
+        }
+        else if (events & (EPOLLHUP | EPOLLERR))
         {
-            if ((tcpClient->info[idx].sockFd != MANGOH_BRIDGE_TCP_CLIENT_SOCKET_INVALID) &&
-                (FD_ISSET(tcpClient->info[idx].sockFd, &tcpClient->writefds)))
+            // Nothing more can be read into a full buffer, hang ups would otherwise be reported forever
+            LE_INFO("socket(%d) hang up", tcpClientInfo->sockFd);
+            res = mangoh_bridge_tcp_client_close(tcpClientInfo);
+            if (res != LE_OK)
             {
-                LE_ASSERT(tcpClient->info[idx].sendBuffer != NULL);
-
-                if (tcpClient->info[idx].sendBuffLen > 0)
-                {
-                    LE_DEBUG("socket[%u](%d) send(%u)", idx, tcpClient->info[idx].sockFd, tcpClient->info[idx].sendBuffLen);
-                    int32_t bytesSent = send(tcpClient->info[idx].sockFd, tcpClient->info[idx].sendBuffer, tcpClient->info[idx].sendBuffLen, 0);
-                    if (bytesSent < 0)
-                    {
-                        LE_WARN("WARNING socket[%u](%d) send() failed(%d/%d)", idx, tcpClient->info[idx].sockFd, bytesSent, errno);
-
-                        res = mangoh_bridge_tcp_client_close(&tcpClient->info[idx]);
-                        if (res != LE_OK)
-                        {
-                            LE_ERROR("ERROR mangoh_bridge_tcp_client_close() failed(%d)", res);
-                            goto cleanup;
-                        }
-                    }
-                    else
-                    {
-                        LE_DEBUG("socket[%u](%d) sent(%u)", idx, tcpClient->info[idx].sockFd, bytesSent);
-                        memmove(tcpClient->info[idx].sendBuffer, tcpClient->info[idx].sendBuffer + bytesSent, tcpClient->info[idx].sendBuffLen - bytesSent);
-                        memset(tcpClient->info[idx].sendBuffer + tcpClient->info[idx].sendBuffLen - bytesSent, 0, bytesSent);
-                        tcpClient->info[idx].sendBuffLen -= bytesSent;
-                    }
-                }
-
-                FD_CLR(tcpClient->info[idx].sockFd, &tcpClient->writefds);
+                LE_ERROR("ERROR mangoh_bridge_tcp_client_close() failed(%d)", res);
             }
         }
     }
 
-    res = LE_OK;
+    if ((tcpClientInfo->sockFd != MANGOH_BRIDGE_TCP_CLIENT_SOCKET_INVALID) && (events & EPOLLOUT))
+    {
+        res = mangoh_bridge_tcp_client_writeToSocket(tcpClientInfo);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_tcp_client_writeToSocket() failed(%d)", res);
+        }
+    }
 
-cleanup:
-    return res;
+    if (tcpClientInfo->sockFd != MANGOH_BRIDGE_TCP_CLIENT_SOCKET_INVALID)
+    {
+        mangoh_bridge_tcp_client_updateEvents(tcpClientInfo);
+    }
+
+    res = mangoh_bridge_tcp_client_dropStarvingClients(tcpClientInfo->clients);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_tcp_client_dropStarvingClients() failed(%d)", res);
+    }
 }
 
 static int mangoh_bridge_tcp_client_dropStarvingClients(mangoh_bridge_tcp_client_t* tcpClient)
@@ -265,7 +294,7 @@ static int mangoh_bridge_tcp_client_dropStarvingClients(mangoh_bridge_tcp_client
     for (idx = 0; idx < MANGOH_BRIDGE_TCP_CLIENT_MAX_CLIENTS; idx++)
     {
         if ((tcpClient->info[idx].sockFd != MANGOH_BRIDGE_TCP_CLIENT_SOCKET_INVALID) &&
-            (tcpClient->info[idx].sendBuffLen == MANGOH_BRIDGE_TCP_CLIENT_SEND_BUFFER_LEN))
+            !mangoh_bridge_queue_room(&tcpClient->info[idx].sendQueue))
         {
             LE_DEBUG("close socket[%u](%d)", idx, tcpClient->info[idx].sockFd);
             res = mangoh_bridge_tcp_client_close(&tcpClient->info[idx]);
@@ -281,20 +310,19 @@ cleanup:
     return res;
 }
 
-int mangoh_bridge_tcp_client_getReceivedData(mangoh_bridge_tcp_client_t* tcpClient, int8_t* buff, uint32_t* len, uint32_t maxLen)
+int mangoh_bridge_tcp_client_getReceivedData(mangoh_bridge_tcp_client_t* tcpClient, mangoh_bridge_queue_t* queue)
 {
     int32_t res = LE_OK;
 
     LE_ASSERT(tcpClient);
-    LE_ASSERT(buff);
-    LE_ASSERT(len);
+    LE_ASSERT(queue);
 
     uint32_t idx = 0;
     for (idx = 0; idx < MANGOH_BRIDGE_TCP_CLIENT_MAX_CLIENTS; idx++)
     {
         if (tcpClient->info[idx].sockFd != MANGOH_BRIDGE_TCP_CLIENT_SOCKET_INVALID)
         {
-            if (*len + tcpClient->info[idx].recvBuffLen > maxLen)
+            if (tcpClient->info[idx].recvBuffLen > mangoh_bridge_queue_room(queue))
             {
                 LE_WARN("buffer overflow");
                 break;
@@ -302,9 +330,9 @@ int mangoh_bridge_tcp_client_getReceivedData(mangoh_bridge_tcp_client_t* tcpClie
 
             if (tcpClient->info[idx].recvBuffLen > 0)
             {
-                memcpy(&buff[*len], tcpClient->info[idx].rxBuffer, tcpClient->info[idx].recvBuffLen);
-                *len += tcpClient->info[idx].recvBuffLen;
+                mangoh_bridge_queue_write(queue, tcpClient->info[idx].rxBuffer, tcpClient->info[idx].recvBuffLen);
                 tcpClient->info[idx].recvBuffLen = 0;
+                mangoh_bridge_tcp_client_updateEvents(&tcpClient->info[idx]);
             }
         }
     }
@@ -325,19 +353,56 @@ int mangoh_bridge_tcp_client_write(mangoh_bridge_tcp_client_t* tcpClient, const
         {
             LE_ASSERT(tcpClient->info[idx].sendBuffer != NULL);
 
-            if (len + tcpClient->info[idx].sendBuffLen > MANGOH_BRIDGE_TCP_CLIENT_SEND_BUFFER_LEN)
+            if (len > mangoh_bridge_queue_room(&tcpClient->info[idx].sendQueue))
             {
                 LE_ERROR("ERROR socket[%u](%d) send buffer overflow", idx, tcpClient->info[idx].sockFd);
                 res = LE_OVERFLOW;
                 goto cleanup;
             }
 
-            memcpy(tcpClient->info[idx].sendBuffer + tcpClient->info[idx].sendBuffLen, buff, len);
-            tcpClient->info[idx].sendBuffLen += len;
-            LE_DEBUG("socket[%u](%d) send buffer length(%u)", idx, tcpClient->info[idx].sockFd, tcpClient->info[idx].sendBuffLen);
+            mangoh_bridge_queue_write(&tcpClient->info[idx].sendQueue, buff, len);
+            LE_DEBUG("socket[%u](%d) send buffer length(%u)", idx, tcpClient->info[idx].sockFd, mangoh_bridge_queue_len(&tcpClient->info[idx].sendQueue));
+
+            mangoh_bridge_tcp_client_updateEvents(&tcpClient->info[idx]);
         }
     }
 
+    res = mangoh_bridge_tcp_client_dropStarvingClients(tcpClient);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_tcp_client_dropStarvingClients() failed(%d)", res);
+        goto cleanup;
+    }
+
+cleanup:
+    return res;
+}
+
+int mangoh_bridge_tcp_client_writeTo(mangoh_bridge_tcp_client_t* tcpClient, uint32_t idx, const uint8_t* buff, uint32_t len)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(tcpClient);
+    LE_ASSERT(idx < MANGOH_BRIDGE_TCP_CLIENT_MAX_CLIENTS);
+
+    if (tcpClient->info[idx].sockFd == MANGOH_BRIDGE_TCP_CLIENT_SOCKET_INVALID)
+    {
+        LE_WARN("WARNING socket[%u] closed", idx);
+        res = LE_CLOSED;
+        goto cleanup;
+    }
+
+    if (len > mangoh_bridge_queue_room(&tcpClient->info[idx].sendQueue))
+    {
+        LE_ERROR("ERROR socket[%u](%d) send buffer overflow", idx, tcpClient->info[idx].sockFd);
+        res = LE_OVERFLOW;
+        goto cleanup;
+    }
+
+    mangoh_bridge_queue_write(&tcpClient->info[idx].sendQueue, buff, len);
+    LE_DEBUG("socket[%u](%d) send buffer length(%u)", idx, tcpClient->info[idx].sockFd, mangoh_bridge_queue_len(&tcpClient->info[idx].sendQueue));
+    mangoh_bridge_tcp_client_updateEvents(&tcpClient->info[idx]);
+
 cleanup:
     return res;
 }
@@ -367,42 +432,105 @@ void mangoh_bridge_tcp_client_connected(const mangoh_bridge_tcp_client_t* tcpCli
     }
 }
 
-int mangoh_bridge_tcp_client_run(mangoh_bridge_tcp_client_t* tcpClient)
+void mangoh_bridge_tcp_client_setNextId(mangoh_bridge_tcp_client_t* tcpClients)
+{
+    LE_ASSERT(tcpClients);
+    tcpClients->nextId = (tcpClients->nextId + 1) % MANGOH_BRIDGE_TCP_CLIENT_MAX_CLIENTS;
+};
+
+int mangoh_bridge_tcp_client_add(mangoh_bridge_tcp_client_t* tcpClients, int32_t sockFd)
 {
     int32_t res = LE_OK;
 
-    LE_ASSERT(tcpClient);
+    LE_ASSERT(tcpClients);
 
-    res = mangoh_bridge_tcp_client_readFromSockets(tcpClient);
-    if (res != LE_OK)
+    mangoh_bridge_tcp_client_info_t* tcpClientInfo = &tcpClients->info[tcpClients->nextId];
+    if (tcpClientInfo->sockFd != MANGOH_BRIDGE_TCP_CLIENT_SOCKET_INVALID)
     {
-        LE_ERROR("ERROR mangoh_bridge_tcp_client_readFromSockets() failed(%d)", res);
+        LE_ERROR("ERROR socket(%d) not closed", tcpClientInfo->sockFd);
+
+        res = close(sockFd);
+        if (res < 0)
+        {
+            LE_ERROR("ERROR socket(%d) close() failed(%d/%d)", sockFd, res, errno);
+            res = LE_COMM_ERROR;
+            goto cleanup;
+        }
+
+        res = LE_BAD_PARAMETER;
         goto cleanup;
     }
 
-    res = mangoh_bridge_tcp_client_writeToSockets(tcpClient);
-    if (res != LE_OK)
+    LE_ASSERT(!tcpClientInfo->sendBuffer && !tcpClientInfo->rxBuffer);
+
+    LE_DEBUG("client -> socket[%u](%d)", tcpClients->nextId, sockFd);
+    tcpClientInfo->sockFd = sockFd;
+
+    tcpClientInfo->sendBuffer = calloc(1, MANGOH_BRIDGE_TCP_CLIENT_SEND_BUFFER_LEN);
+    if (!tcpClientInfo->sendBuffer)
     {
-        LE_ERROR("ERROR mangoh_bridge_tcp_client_writeToSockets() failed(%d)", res);
+        LE_ERROR("ERROR calloc() failed");
+        res = LE_NO_MEMORY;
         goto cleanup;
     }
 
-    res = mangoh_bridge_tcp_client_dropStarvingClients(tcpClient);
+    mangoh_bridge_queue_init(&tcpClientInfo->sendQueue, tcpClientInfo->sendBuffer, MANGOH_BRIDGE_TCP_CLIENT_SEND_BUFFER_LEN);
+
+    tcpClientInfo->recvBuffLen = 0;
+    tcpClientInfo->rxBuffer = calloc(1, MANGOH_BRIDGE_TCP_CLIENT_RECV_BUFFER_LEN);
+    if (!tcpClientInfo->rxBuffer)
+    {
+        LE_ERROR("ERROR calloc() failed");
+        res = LE_NO_MEMORY;
+        goto cleanup;
+    }
+
+    res = mangoh_bridge_reactor_add(&tcpClientInfo->watch, sockFd, EPOLLIN, mangoh_bridge_tcp_client_eventHandler, tcpClientInfo);
     if (res != LE_OK)
     {
-        LE_ERROR("ERROR mangoh_bridge_tcp_client_dropStarvingClients() failed(%d)", res);
+        LE_ERROR("ERROR mangoh_bridge_reactor_add() failed(%d)", res);
         goto cleanup;
     }
 
+    mangoh_bridge_tcp_client_setNextId(tcpClients);
+
 cleanup:
+    if ((res != LE_OK) && (tcpClientInfo->sockFd == sockFd))
+    {
+        mangoh_bridge_tcp_client_close(tcpClientInfo);
+    }
+
     return res;
 }
 
-void mangoh_bridge_tcp_client_setNextId(mangoh_bridge_tcp_client_t* tcpClients)
+int mangoh_bridge_tcp_client_closeAll(mangoh_bridge_tcp_client_t* tcpClient)
 {
-    LE_ASSERT(tcpClients);
-    tcpClients->nextId = (tcpClients->nextId + 1) % MANGOH_BRIDGE_TCP_CLIENT_MAX_CLIENTS;
-};
+    int32_t res = LE_OK;
+
+    LE_ASSERT(tcpClient);
+
+    uint32_t idx = 0;
+    for (idx = 0; idx < MANGOH_BRIDGE_TCP_CLIENT_MAX_CLIENTS; idx++)
+    {
+        res = mangoh_bridge_tcp_client_close(&tcpClient->info[idx]);
+        if (res != LE_OK)
+        {
+            LE_ERROR("ERROR mangoh_bridge_tcp_client_close() failed(%d)", res);
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    return res;
+}
+
+void mangoh_bridge_tcp_client_setRecvHandler(mangoh_bridge_tcp_client_t* tcpClient, mangoh_bridge_tcp_client_recv_handler_t handler, void* context)
+{
+    LE_ASSERT(tcpClient);
+
+    tcpClient->recvHandler = handler;
+    tcpClient->recvContext = context;
+}
 
 void mangoh_bridge_tcp_client_init(mangoh_bridge_tcp_client_t* tcpClient, bool broadcast)
 {
@@ -413,6 +541,7 @@ void mangoh_bridge_tcp_client_init(mangoh_bridge_tcp_client_t* tcpClient, bool b
     uint32_t idx = 0;
     for (idx = 0; idx < MANGOH_BRIDGE_TCP_CLIENT_MAX_CLIENTS; idx++)
     {
+        tcpClient->info[idx].clients = tcpClient;
         tcpClient->info[idx].sockFd = MANGOH_BRIDGE_TCP_CLIENT_SOCKET_INVALID;
     }
 }
@@ -423,18 +552,13 @@ int mangoh_bridge_tcp_client_destroy(mangoh_bridge_tcp_client_t* tcpClient)
 
     LE_ASSERT(tcpClient);
 
-    uint32_t idx = 0;
-    for (idx = 0; idx < MANGOH_BRIDGE_TCP_CLIENT_MAX_CLIENTS; idx++)
+    res = mangoh_bridge_tcp_client_closeAll(tcpClient);
+    if (res != LE_OK)
     {
-        res = mangoh_bridge_tcp_client_close(&tcpClient->info[idx]);
-        if (res != LE_OK)
-        {
-            LE_ERROR("ERROR mangoh_bridge_tcp_client_close() failed(%d)", res);
-            goto cleanup;
-        }
+        LE_ERROR("ERROR mangoh_bridge_tcp_client_closeAll() failed(%d)", res);
+        goto cleanup;
     }
 
 cleanup:
     return res;
 }
-
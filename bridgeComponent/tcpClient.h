@@ -9,6 +9,10 @@
  *
  * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
  */
+#include "legato.h"
+#include "reactor.h"
+#include "queue.h"
+
 #ifndef MANGOH_BRIDGE_TCP_CLIENT_INCLUDE_GUARD
 #define MANGOH_BRIDGE_TCP_CLIENT_INCLUDE_GUARD
 
@@ -17,6 +21,10 @@
 #define MANGOH_BRIDGE_TCP_CLIENT_SEND_BUFFER_LEN                0x4000
 #define MANGOH_BRIDGE_TCP_CLIENT_RECV_BUFFER_LEN                0x4000
 
+struct _mangoh_bridge_tcp_client_t;
+
+typedef int (*mangoh_bridge_tcp_client_recv_handler_t)(void*);
+
 //------------------------------------------------------------------------------------------------------------------
 /**
  * TCP client info
@@ -24,11 +32,13 @@
 //------------------------------------------------------------------------------------------------------------------
 typedef struct _mangoh_bridge_tcp_client_info_t
 {
-    int8_t*  sendBuffer;  ///< Send buffer
-    int8_t*  rxBuffer;    ///< Receive buffer
-    uint32_t sendBuffLen; ///< Number of bytes in send buffer
-    uint32_t recvBuffLen; ///< Number of bytes in receive buffer
-    int32_t  sockFd;      ///< Socket descriptor
+    struct _mangoh_bridge_tcp_client_t* clients;     ///< Owning client list
+    mangoh_bridge_reactor_watch_t       watch;       ///< Socket event registration
+    mangoh_bridge_queue_t               sendQueue;   ///< Data waiting to be sent
+    uint8_t*                            sendBuffer;  ///< Send queue storage
+    int8_t*                             rxBuffer;    ///< Receive buffer
+    uint32_t                            recvBuffLen; ///< Number of bytes in receive buffer
+    int32_t                             sockFd;      ///< Socket descriptor
 } mangoh_bridge_tcp_client_info_t;
 
 //------------------------------------------------------------------------------------------------------------------
@@ -38,21 +48,23 @@ typedef struct _mangoh_bridge_tcp_client_info_t
 //------------------------------------------------------------------------------------------------------------------
 typedef struct _mangoh_bridge_tcp_client_t
 {
-    mangoh_bridge_tcp_client_info_t info[MANGOH_BRIDGE_TCP_CLIENT_MAX_CLIENTS]; ///< List of clients
-    fd_set                          readfds;                                    ///< Read fd set
-    fd_set                          writefds;                                   ///< Write fd set
-    int32_t                         maxSockFd;                                  ///< fd set maximum
-    uint32_t                        nextId;                                     ///< Next client ID
-    bool                            broadcast;                                  ///< Broadcast to all clients flag
+    mangoh_bridge_tcp_client_info_t         info[MANGOH_BRIDGE_TCP_CLIENT_MAX_CLIENTS]; ///< List of clients
+    mangoh_bridge_tcp_client_recv_handler_t recvHandler;                                ///< Called when data is received
+    void*                                   recvContext;                                ///< Receive handler parameter
+    uint32_t                                nextId;                                     ///< Next client ID
+    bool                                    broadcast;                                  ///< Broadcast to all clients flag
 } mangoh_bridge_tcp_client_t;
 
 int mangoh_bridge_tcp_client_write(mangoh_bridge_tcp_client_t*, const uint8_t*, uint32_t);
+int mangoh_bridge_tcp_client_writeTo(mangoh_bridge_tcp_client_t*, uint32_t, const uint8_t*, uint32_t);
 void mangoh_bridge_tcp_client_connected(const mangoh_bridge_tcp_client_t*, int8_t*);
-int mangoh_bridge_tcp_client_getReceivedData(mangoh_bridge_tcp_client_t*, int8_t*, uint32_t*, uint32_t);
+int mangoh_bridge_tcp_client_getReceivedData(mangoh_bridge_tcp_client_t*, mangoh_bridge_queue_t*);
 
 void mangoh_bridge_tcp_client_setNextId(mangoh_bridge_tcp_client_t*);
+int mangoh_bridge_tcp_client_add(mangoh_bridge_tcp_client_t*, int32_t);
+int mangoh_bridge_tcp_client_closeAll(mangoh_bridge_tcp_client_t*);
+void mangoh_bridge_tcp_client_setRecvHandler(mangoh_bridge_tcp_client_t*, mangoh_bridge_tcp_client_recv_handler_t, void*);
 
-int mangoh_bridge_tcp_client_run(mangoh_bridge_tcp_client_t*);
 void mangoh_bridge_tcp_client_init(mangoh_bridge_tcp_client_t*, bool);
 int mangoh_bridge_tcp_client_destroy(mangoh_bridge_tcp_client_t*);
 
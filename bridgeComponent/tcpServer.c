@@ -13,187 +13,223 @@
 #include "legato.h"
 #include "tcpServer.h"
 
-int mangoh_bridge_tcp_server_acceptNewConnections(mangoh_bridge_tcp_server_t* tcpServer, mangoh_bridge_tcp_client_t* tcpClients)
+static int mangoh_bridge_tcp_server_acceptNewConnections(mangoh_bridge_tcp_server_t*);
+static void mangoh_bridge_tcp_server_eventHandler(mangoh_bridge_reactor_watch_t*, uint32_t);
+static int mangoh_bridge_tcp_server_listen(mangoh_bridge_tcp_server_t*);
+static void mangoh_bridge_tcp_server_retryTimerHandler(le_timer_Ref_t);
+
+static int mangoh_bridge_tcp_server_acceptNewConnections(mangoh_bridge_tcp_server_t* tcpServer)
 {
     int32_t res = LE_OK;
 
     LE_ASSERT(tcpServer);
-    LE_ASSERT(tcpClients);
+    LE_ASSERT(tcpServer->clients);
 
-    FD_ZERO(&tcpServer->readfds);
-    FD_SET(tcpServer->sockFd, &tcpServer->readfds);
-
-    struct timeval tv  = {0};
-    res = select(tcpServer->sockFd + 1, &tcpServer->readfds, NULL, NULL, &tv);
-    if (res < 0)
+    struct sockaddr_in clientAddr = {0};
+    socklen_t clientAddrSize = sizeof(clientAddr);
+    int32_t newFd = accept(tcpServer->sockFd, (struct sockaddr*)&clientAddr, &clientAddrSize);
+    if ((newFd < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)))
     {
-        LE_ERROR("ERROR select() failed(%d/%d)", res, errno);
-        res = LE_COMM_ERROR;
         goto cleanup;
     }
-
-    if ((res > 0) && FD_ISSET(tcpServer->sockFd, &tcpServer->readfds))
+    else if (newFd < 0)
     {
-        struct sockaddr_in clientAddr = {0};
-        uint32_t clientAddrSize = 0;
-        int32_t newFd = accept(tcpServer->sockFd, (struct sockaddr*)&clientAddr, &clientAddrSize);
-        if (newFd < 0)
-        {
-            LE_ERROR("ERROR accept() failed(%d/%d)", newFd, errno);
-            res = LE_COMM_ERROR;
-            goto cleanup;
-        }
-
-        char clientIPStr[INET_ADDRSTRLEN] = {0};
-        LE_INFO("connection -> '%s'", inet_ntop(AF_INET, &clientAddr.sin_addr, clientIPStr, INET_ADDRSTRLEN));
-
-        res = fcntl(newFd, F_SETFL, O_NONBLOCK);
-        if (res < 0)
-        {
-            LE_ERROR("ERROR fcntl() failed(%d/%d)", res, errno);
-            res = LE_FAULT;
-            goto cleanup;
-        }
-
-        if (tcpClients->info[tcpClients->nextId].sockFd == MANGOH_BRIDGE_TCP_SERVER_SOCKET_INVALID)
-        {
-            LE_ASSERT(!tcpClients->info[tcpClients->nextId].sendBuffer && !tcpClients->info[tcpClients->nextId].rxBuffer);
-
-            LE_DEBUG("client -> socket[%u](%d)", tcpClients->nextId, newFd);
-            tcpClients->info[tcpClients->nextId].sockFd = newFd;
-
-            tcpClients->info[tcpClients->nextId].sendBuffLen = 0;
-            tcpClients->info[tcpClients->nextId].sendBuffer = calloc(1, MANGOH_BRIDGE_TCP_CLIENT_SEND_BUFFER_LEN);
-            if (!tcpClients->info[tcpClients->nextId].sendBuffer)
-            {
-                LE_ERROR("ERROR calloc() failed");
-                res = LE_NO_MEMORY;
-                goto cleanup;
-            }
-
-            tcpClients->info[tcpClients->nextId].recvBuffLen = 0;
-            tcpClients->info[tcpClients->nextId].rxBuffer = calloc(1, MANGOH_BRIDGE_TCP_CLIENT_SEND_BUFFER_LEN);
-            if (!tcpClients->info[tcpClients->nextId].rxBuffer)
-            {
-                LE_ERROR("ERROR calloc() failed");
-                res = LE_NO_MEMORY;
-                goto cleanup;
-            }
-
-            mangoh_bridge_tcp_client_setNextId(tcpClients);
-        }
-        else
-        {
-            LE_ERROR("ERROR socket(%u) not closed", tcpClients->info[tcpClients->nextId].sockFd);
+        LE_ERROR("ERROR accept() failed(%d/%d)", newFd, errno);
+        res = LE_COMM_ERROR;
+        goto cleanup;
+    }
 
-            res = close(newFd);
-            if (res < 0)
-            {
-                LE_ERROR("ERROR socket(%d) close() failed(%d/%d)", newFd, res, errno);
-                res = LE_COMM_ERROR;
-                goto cleanup;
-            }
+    char clientIPStr[INET_ADDRSTRLEN] = {0};
+    LE_INFO("connection -> '%s'", inet_ntop(AF_INET, &clientAddr.sin_addr, clientIPStr, INET_ADDRSTRLEN));
 
-            res = LE_BAD_PARAMETER;
-            goto cleanup;
-        }
+    res = fcntl(newFd, F_SETFL, O_NONBLOCK);
+    if (res < 0)
+    {
+        LE_ERROR("ERROR fcntl() failed(%d/%d)", res, errno);
+        close(newFd);
+        res = LE_FAULT;
+        goto cleanup;
     }
 
-    res = LE_OK;
+    res = mangoh_bridge_tcp_client_add(tcpServer->clients, newFd);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_tcp_client_add() failed(%d)", res);
+        goto cleanup;
+    }
 
 cleanup:
     return res;
 }
 
-int mangoh_bridge_tcp_server_start(mangoh_bridge_tcp_server_t* tcpServer, const char* serverIp, const char* service, uint32_t backlog)
+static void mangoh_bridge_tcp_server_eventHandler(mangoh_bridge_reactor_watch_t* watch, uint32_t events)
 {
-    int32_t res = LE_OK;
+    mangoh_bridge_tcp_server_t* tcpServer = watch->context;
 
     LE_ASSERT(tcpServer);
+    LE_ASSERT(tcpServer->sockFd == watch->fd);
 
-    while (1)
+    if (events & EPOLLIN)
     {
-        struct addrinfo hints = {0};
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        hints.ai_flags = AI_PASSIVE;
-
-        struct addrinfo* servinfo = NULL;
-        res = getaddrinfo(serverIp, service, &hints, &servinfo);
-        if (res < 0)
+        int32_t res = mangoh_bridge_tcp_server_acceptNewConnections(tcpServer);
+        if (res != LE_OK)
         {
-            LE_ERROR("ERROR getaddrinfo() failed(%d/%d)", res, errno);
-            res = LE_FAULT;
-            goto cleanup;
+            LE_ERROR("ERROR mangoh_bridge_tcp_server_acceptNewConnections() failed(%d)", res);
         }
+    }
+}
 
-        // loop through all the results and bind to the first we can
-        struct addrinfo* p = NULL;
-        for (p = servinfo; p != NULL; p = p->ai_next)
-        {
-            tcpServer->sockFd = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
-            if (tcpServer->sockFd < 0)
-            {
-                LE_ERROR("ERROR socket() failed(%d/%d)", tcpServer->sockFd, errno);
-                continue;
-            }
-
-            uint32_t reuseAddr = 1;
-            res = setsockopt(tcpServer->sockFd, SOL_SOCKET, SO_REUSEADDR, &reuseAddr, sizeof(reuseAddr));
-            if (res < 0)
-            {
-                LE_ERROR("ERROR setsockopt() failed(%d/%d)", res, errno);
-                res = LE_FAULT;
-                goto cleanup;
-            }
-
-            res = bind(tcpServer->sockFd, p->ai_addr, p->ai_addrlen);
-            if (res < 0)
-            {
-                LE_ERROR("ERROR bind() failed(%d/%d)", res, errno);
-
-                res = close(tcpServer->sockFd);
-                if (res < 0)
-                {
-                    LE_ERROR("ERROR close() failed(%d/%d)", res, errno);
-                    res = LE_COMM_ERROR;
-                    goto cleanup;
-                }
-
-                tcpServer->sockFd = MANGOH_BRIDGE_TCP_SERVER_SOCKET_INVALID;
-                continue;
-            }
-
-            break;
-        }
+static int mangoh_bridge_tcp_server_listen(mangoh_bridge_tcp_server_t* tcpServer)
+{
+    struct addrinfo* servinfo = NULL;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(tcpServer);
+
+    struct addrinfo hints = {0};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    res = getaddrinfo(tcpServer->serverIp, tcpServer->service, &hints, &servinfo);
+    if (res)
+    {
+        LE_ERROR("ERROR getaddrinfo() failed(%d/%d)", res, errno);
+        servinfo = NULL;
+        res = LE_FAULT;
+        goto cleanup;
+    }
 
-        if (tcpServer->sockFd == MANGOH_BRIDGE_TCP_SERVER_SOCKET_INVALID)
+    // loop through all the results and bind to the first we can
+    struct addrinfo* p = NULL;
+    for (p = servinfo; p != NULL; p = p->ai_next)
+    {
+        tcpServer->sockFd = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+        if (tcpServer->sockFd < 0)
         {
-            LE_ERROR("ERROR bind '%s:%s' failed", serverIp, service);
-            sleep(MANGOH_BRIDGE_TCP_SERVER_RETRY_BIND_DELAY_SECS);
+            LE_ERROR("ERROR socket() failed(%d/%d)", tcpServer->sockFd, errno);
+            tcpServer->sockFd = MANGOH_BRIDGE_TCP_SERVER_SOCKET_INVALID;
             continue;
         }
 
-        res = fcntl(tcpServer->sockFd, F_SETFL, O_NONBLOCK);
+        uint32_t reuseAddr = 1;
+        res = setsockopt(tcpServer->sockFd, SOL_SOCKET, SO_REUSEADDR, &reuseAddr, sizeof(reuseAddr));
         if (res < 0)
         {
-            LE_ERROR("ERROR fcntl() failed(%d/%d)", res, errno);
+            LE_ERROR("ERROR setsockopt() failed(%d/%d)", res, errno);
             res = LE_FAULT;
             goto cleanup;
         }
 
-        res = listen(tcpServer->sockFd, backlog);
+        res = bind(tcpServer->sockFd, p->ai_addr, p->ai_addrlen);
         if (res < 0)
         {
-            LE_ERROR("ERROR listen() failed(%d/%d)", res, errno);
-            res = LE_COMM_ERROR;
-            goto cleanup;
+            LE_ERROR("ERROR bind() failed(%d/%d)", res, errno);
+            close(tcpServer->sockFd);
+            tcpServer->sockFd = MANGOH_BRIDGE_TCP_SERVER_SOCKET_INVALID;
+            continue;
         }
 
-        LE_DEBUG("server started('%s:%s')", serverIp, service);
         break;
     }
 
+    if (tcpServer->sockFd == MANGOH_BRIDGE_TCP_SERVER_SOCKET_INVALID)
+    {
+        LE_ERROR("ERROR bind '%s:%s' failed", tcpServer->serverIp, tcpServer->service);
+        res = LE_COMM_ERROR;
+        goto cleanup;
+    }
+
+    res = fcntl(tcpServer->sockFd, F_SETFL, O_NONBLOCK);
+    if (res < 0)
+    {
+        LE_ERROR("ERROR fcntl() failed(%d/%d)", res, errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    res = listen(tcpServer->sockFd, tcpServer->backlog);
+    if (res < 0)
+    {
+        LE_ERROR("ERROR listen() failed(%d/%d)", res, errno);
+        res = LE_COMM_ERROR;
+        goto cleanup;
+    }
+
+    res = mangoh_bridge_reactor_add(&tcpServer->watch, tcpServer->sockFd, EPOLLIN, mangoh_bridge_tcp_server_eventHandler, tcpServer);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_reactor_add() failed(%d)", res);
+        goto cleanup;
+    }
+
+    LE_INFO("server started('%s:%s')", tcpServer->serverIp, tcpServer->service);
+
+cleanup:
+    if ((res != LE_OK) && (tcpServer->sockFd != MANGOH_BRIDGE_TCP_SERVER_SOCKET_INVALID))
+    {
+        close(tcpServer->sockFd);
+        tcpServer->sockFd = MANGOH_BRIDGE_TCP_SERVER_SOCKET_INVALID;
+    }
+
+    if (servinfo)
+    {
+        freeaddrinfo(servinfo);
+    }
+
+    return res;
+}
+
+static void mangoh_bridge_tcp_server_retryTimerHandler(le_timer_Ref_t timer)
+{
+    mangoh_bridge_tcp_server_t* tcpServer = le_timer_GetContextPtr(timer);
+
+    LE_ASSERT(tcpServer);
+
+    int32_t res = mangoh_bridge_tcp_server_listen(tcpServer);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_tcp_server_listen() failed(%d), retry in %u s", res, MANGOH_BRIDGE_TCP_SERVER_RETRY_BIND_DELAY_SECS);
+        le_timer_Start(timer);
+    }
+}
+
+int mangoh_bridge_tcp_server_start(mangoh_bridge_tcp_server_t* tcpServer, mangoh_bridge_tcp_client_t* tcpClients, const char* serverIp, uint16_t port, uint32_t backlog)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(tcpServer);
+    LE_ASSERT(tcpClients);
+    LE_ASSERT(serverIp);
+
+    tcpServer->clients = tcpClients;
+    tcpServer->serverIp = serverIp;
+    tcpServer->backlog = backlog;
+    tcpServer->sockFd = MANGOH_BRIDGE_TCP_SERVER_SOCKET_INVALID;
+    snprintf(tcpServer->service, sizeof(tcpServer->service), "%u", port);
+
+    tcpServer->retryTimer = le_timer_Create(MANGOH_BRIDGE_TCP_SERVER_RETRY_TIMER_NAME);
+    le_timer_SetMsInterval(tcpServer->retryTimer, MANGOH_BRIDGE_TCP_SERVER_RETRY_BIND_DELAY_SECS * 1000);
+    le_timer_SetRepeat(tcpServer->retryTimer, 1);
+    le_timer_SetContextPtr(tcpServer->retryTimer, tcpServer);
+    le_timer_SetHandler(tcpServer->retryTimer, mangoh_bridge_tcp_server_retryTimerHandler);
+
+    // The port may still be held, e.g. by an instance being restarted, keep retrying from the timer
+    res = mangoh_bridge_tcp_server_listen(tcpServer);
+    if (res == LE_COMM_ERROR)
+    {
+        LE_WARN("WARNING server '%s:%s' not started, retry in %u s", serverIp, tcpServer->service, MANGOH_BRIDGE_TCP_SERVER_RETRY_BIND_DELAY_SECS);
+        le_timer_Start(tcpServer->retryTimer);
+        res = LE_OK;
+    }
+    else if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_tcp_server_listen() failed(%d)", res);
+        le_timer_Delete(tcpServer->retryTimer);
+        tcpServer->retryTimer = NULL;
+        goto cleanup;
+    }
+
 cleanup:
     return res;
 }
@@ -202,6 +238,16 @@ int mangoh_bridge_tcp_server_stop(mangoh_bridge_tcp_server_t* tcpServer)
 {
     int32_t res = LE_OK;
 
+    LE_ASSERT(tcpServer);
+
+    if (tcpServer->retryTimer)
+    {
+        le_timer_Delete(tcpServer->retryTimer);
+        tcpServer->retryTimer = NULL;
+    }
+
+    mangoh_bridge_reactor_remove(&tcpServer->watch);
+
     if (tcpServer->sockFd > 0)
     {
         res = close(tcpServer->sockFd);
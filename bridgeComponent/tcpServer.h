@@ -3,7 +3,8 @@
  *
  * Arduino bridge TCP server module.
  *
- * This module contains data structures and methods used to implement a TCP server.
+ * This module contains data structures and methods used to implement a TCP server.  A port that cannot be bound yet
+ * (e.g. still held by a previous instance) is retried from a timer, the event loop is never blocked waiting for it.
  *
  * <HR>
  *
@@ -16,6 +17,8 @@
 
 #define MANGOH_BRIDGE_TCP_SERVER_SOCKET_INVALID                   -1
 #define MANGOH_BRIDGE_TCP_SERVER_RETRY_BIND_DELAY_SECS            5
+#define MANGOH_BRIDGE_TCP_SERVER_RETRY_TIMER_NAME                 "BridgeTcpServerRetry"
+#define MANGOH_BRIDGE_TCP_SERVER_SERVICE_MAX_LEN                  8
 
 //------------------------------------------------------------------------------------------------------------------
 /**
@@ -24,13 +27,16 @@
 //------------------------------------------------------------------------------------------------------------------
 typedef struct _mangoh_bridge_tcp_server_t
 {
-    fd_set  readfds; ///< Read descriptor set
-    int32_t sockFd;  ///< Server socket descriptor
+    mangoh_bridge_reactor_watch_t watch;                                             ///< Listening socket event registration
+    mangoh_bridge_tcp_client_t*   clients;                                           ///< Accepted connections
+    le_timer_Ref_t                retryTimer;                                        ///< Bind retry timer
+    const char*                   serverIp;                                          ///< Address to bind
+    char                          service[MANGOH_BRIDGE_TCP_SERVER_SERVICE_MAX_LEN]; ///< Port to bind
+    uint32_t                      backlog;                                           ///< Listen backlog
+    int32_t                       sockFd;                                            ///< Server socket descriptor
 } mangoh_bridge_tcp_server_t;
 
-int mangoh_bridge_tcp_server_acceptNewConnections(mangoh_bridge_tcp_server_t*, mangoh_bridge_tcp_client_t*);
-
-int mangoh_bridge_tcp_server_start(mangoh_bridge_tcp_server_t*, const char*, const char*, uint32_t);
+int mangoh_bridge_tcp_server_start(mangoh_bridge_tcp_server_t*, mangoh_bridge_tcp_client_t*, const char*, uint16_t, uint32_t);
 int mangoh_bridge_tcp_server_stop(mangoh_bridge_tcp_server_t*);
 
 #endif
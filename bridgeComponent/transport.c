@@ -0,0 +1,695 @@
+/**
+ * @file
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless, Inc. Use of this work is subject to license.
+ */
+
+// posix_openpt() and friends
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <netdb.h>
+#include <sys/ioctl.h>
+#include <sys/un.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "legato.h"
+#include "transport.h"
+
+static int mangoh_bridge_transport_rawMode(int, speed_t);
+static ssize_t mangoh_bridge_transport_fdReadv(mangoh_bridge_transport_t*, const struct iovec*, int);
+static ssize_t mangoh_bridge_transport_fdWritev(mangoh_bridge_transport_t*, const struct iovec*, int);
+static int mangoh_bridge_transport_fdClose(mangoh_bridge_transport_t*);
+
+static int mangoh_bridge_transport_ttyOpen(mangoh_bridge_transport_t*);
+static int mangoh_bridge_transport_ttySetSpeed(mangoh_bridge_transport_t*, speed_t);
+static int mangoh_bridge_transport_ttyOutputPending(mangoh_bridge_transport_t*, uint32_t*);
+static int mangoh_bridge_transport_ptyOpen(mangoh_bridge_transport_t*);
+static int mangoh_bridge_transport_ptyClose(mangoh_bridge_transport_t*);
+static int mangoh_bridge_transport_tcpResolve(const mangoh_bridge_transport_t*, mangoh_bridge_transport_peer_t*);
+static int mangoh_bridge_transport_unixResolve(const mangoh_bridge_transport_t*, mangoh_bridge_transport_peer_t*);
+static int mangoh_bridge_transport_connect(mangoh_bridge_transport_t*);
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Transport backends, the first entry is used when no scheme is given
+ */
+//------------------------------------------------------------------------------------------------------------------
+static const mangoh_bridge_transport_ops_t mangoh_bridge_transport_backends[] =
+{
+    {
+        .scheme        = "tty",
+        .resolve       = NULL,
+        .open          = mangoh_bridge_transport_ttyOpen,
+        .readv         = mangoh_bridge_transport_fdReadv,
+        .writev        = mangoh_bridge_transport_fdWritev,
+        .setSpeed      = mangoh_bridge_transport_ttySetSpeed,
+        .outputPending = mangoh_bridge_transport_ttyOutputPending,
+        .close         = mangoh_bridge_transport_fdClose,
+    },
+    {
+        .scheme        = "pty",
+        .resolve       = NULL,
+        .open          = mangoh_bridge_transport_ptyOpen,
+        .readv         = mangoh_bridge_transport_fdReadv,
+        .writev        = mangoh_bridge_transport_fdWritev,
+        .setSpeed      = NULL,
+        .outputPending = NULL,
+        .close         = mangoh_bridge_transport_ptyClose,
+    },
+    {
+        .scheme        = "tcp",
+        .resolve       = mangoh_bridge_transport_tcpResolve,
+        .open          = mangoh_bridge_transport_connect,
+        .readv         = mangoh_bridge_transport_fdReadv,
+        .writev        = mangoh_bridge_transport_fdWritev,
+        .setSpeed      = NULL,
+        .outputPending = NULL,
+        .close         = mangoh_bridge_transport_fdClose,
+    },
+    {
+        .scheme        = "unix",
+        .resolve       = mangoh_bridge_transport_unixResolve,
+        .open          = mangoh_bridge_transport_connect,
+        .readv         = mangoh_bridge_transport_fdReadv,
+        .writev        = mangoh_bridge_transport_fdWritev,
+        .setSpeed      = NULL,
+        .outputPending = NULL,
+        .close         = mangoh_bridge_transport_fdClose,
+    },
+};
+
+static int mangoh_bridge_transport_rawMode(int fd, speed_t speed)
+{
+    struct termios tty = {0};
+    int32_t res = LE_OK;
+
+    res = tcgetattr(fd, &tty);
+    if (res)
+    {
+        LE_ERROR("ERROR tcgetattr() failed(%d/%d)", res, errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    res = cfsetospeed(&tty, speed);
+    if (res)
+    {
+        LE_ERROR("ERROR cfsetospeed() failed(%d/%d)", res, errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    res = cfsetispeed(&tty, speed);
+    if (res)
+    {
+        LE_ERROR("ERROR cfsetispeed() failed(%d/%d)", res, errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    cfmakeraw(&tty);
+
+    tty.c_cc[VMIN] = 1;       // read blocks
+    tty.c_cc[VTIME] = 0;      // seconds read timeout
+
+    res = tcflush(fd, TCIFLUSH);
+    if (res)
+    {
+        LE_ERROR("ERROR tcflush() failed(%d/%d)", res, errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    res = tcsetattr(fd, TCSANOW, &tty);
+    if (res)
+    {
+        LE_ERROR("ERROR tcsetattr() failed(%d/%d)", res, errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+cleanup:
+    return res;
+}
+
+static ssize_t mangoh_bridge_transport_fdReadv(mangoh_bridge_transport_t* transport, const struct iovec* iov, int iovcnt)
+{
+    LE_ASSERT(transport);
+    return readv(transport->fd, iov, iovcnt);
+}
+
+static ssize_t mangoh_bridge_transport_fdWritev(mangoh_bridge_transport_t* transport, const struct iovec* iov, int iovcnt)
+{
+    LE_ASSERT(transport);
+    return writev(transport->fd, iov, iovcnt);
+}
+
+static int mangoh_bridge_transport_fdClose(mangoh_bridge_transport_t* transport)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(transport);
+
+    if (transport->fd == MANGOH_BRIDGE_TRANSPORT_FD_INVALID)
+    {
+        goto cleanup;
+    }
+
+    res = close(transport->fd);
+    if (res)
+    {
+        LE_ERROR("ERROR close() failed(%d/%d)", res, errno);
+        res = LE_IO_ERROR;
+    }
+
+    transport->fd = MANGOH_BRIDGE_TRANSPORT_FD_INVALID;
+
+cleanup:
+    return res;
+}
+
+static int mangoh_bridge_transport_ttyOpen(mangoh_bridge_transport_t* transport)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(transport);
+
+    transport->fd = open(transport->addr, O_RDWR | O_NOCTTY | O_EXCL);
+    if (transport->fd < 0)
+    {
+        LE_ERROR("ERROR open() '%s' failed(%d)", transport->addr, errno);
+        res = LE_NOT_FOUND;
+        goto cleanup;
+    }
+
+    res = fcntl(transport->fd, F_SETFL, 0);
+    if (res)
+    {
+        LE_ERROR("ERROR fcntl() failed(%d/%d)", res, errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    res = mangoh_bridge_transport_rawMode(transport->fd, B115200);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_transport_rawMode() failed(%d)", res);
+        goto cleanup;
+    }
+
+cleanup:
+    return res;
+}
+
+static int mangoh_bridge_transport_ttySetSpeed(mangoh_bridge_transport_t* transport, speed_t speed)
+{
+    struct termios tty = {0};
+    int32_t res = LE_OK;
+
+    LE_ASSERT(transport);
+
+    res = tcgetattr(transport->fd, &tty);
+    if (res)
+    {
+        LE_ERROR("ERROR tcgetattr() failed(%d/%d)", res, errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    res = cfsetospeed(&tty, speed);
+    if (res)
+    {
+        LE_ERROR("ERROR cfsetospeed() failed(%d/%d)", res, errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    res = cfsetispeed(&tty, speed);
+    if (res)
+    {
+        LE_ERROR("ERROR cfsetispeed() failed(%d/%d)", res, errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    // The caller waits for the output queue to drain, TCSADRAIN would block until the pending reply is sent
+    res = tcsetattr(transport->fd, TCSANOW, &tty);
+    if (res)
+    {
+        LE_ERROR("ERROR tcsetattr() failed(%d/%d)", res, errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    res = tcflush(transport->fd, TCIFLUSH);
+    if (res)
+    {
+        LE_ERROR("ERROR tcflush() failed(%d/%d)", res, errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+cleanup:
+    return res;
+}
+
+static int mangoh_bridge_transport_ttyOutputPending(mangoh_bridge_transport_t* transport, uint32_t* pending)
+{
+    int queued = 0;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(transport);
+    LE_ASSERT(pending);
+
+    res = ioctl(transport->fd, TIOCOUTQ, &queued);
+    if (res)
+    {
+        LE_ERROR("ERROR ioctl(TIOCOUTQ) failed(%d/%d)", res, errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    *pending = (queued > 0) ? queued:0;
+
+cleanup:
+    return res;
+}
+
+static int mangoh_bridge_transport_ptyOpen(mangoh_bridge_transport_t* transport)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(transport);
+
+    transport->fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (transport->fd < 0)
+    {
+        LE_ERROR("ERROR posix_openpt() failed(%d)", errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    if (grantpt(transport->fd) || unlockpt(transport->fd))
+    {
+        LE_ERROR("ERROR grantpt()/unlockpt() failed(%d)", errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    const char* slave = ptsname(transport->fd);
+    if (!slave)
+    {
+        LE_ERROR("ERROR ptsname() failed(%d)", errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    // Hold the slave open so the master does not see a hangup while the simulated MCU (re)opens it
+    transport->peerFd = open(slave, O_RDWR | O_NOCTTY);
+    if (transport->peerFd < 0)
+    {
+        LE_ERROR("ERROR open() '%s' failed(%d)", slave, errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    res = mangoh_bridge_transport_rawMode(transport->peerFd, B115200);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_transport_rawMode() failed(%d)", res);
+        goto cleanup;
+    }
+
+    unlink(transport->addr);
+    res = symlink(slave, transport->addr);
+    if (res)
+    {
+        LE_ERROR("ERROR symlink() '%s' -> '%s' failed(%d/%d)", transport->addr, slave, res, errno);
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    LE_INFO("pty '%s' -> '%s'", transport->addr, slave);
+
+cleanup:
+    return res;
+}
+
+static int mangoh_bridge_transport_ptyClose(mangoh_bridge_transport_t* transport)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(transport);
+
+    if (transport->peerFd != MANGOH_BRIDGE_TRANSPORT_FD_INVALID)
+    {
+        close(transport->peerFd);
+        transport->peerFd = MANGOH_BRIDGE_TRANSPORT_FD_INVALID;
+    }
+
+    unlink(transport->addr);
+
+    res = mangoh_bridge_transport_fdClose(transport);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_transport_fdClose() failed(%d)", res);
+        goto cleanup;
+    }
+
+cleanup:
+    return res;
+}
+
+static int mangoh_bridge_transport_connect(mangoh_bridge_transport_t* transport)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(transport);
+    LE_ASSERT(transport->peer.len);
+
+    transport->fd = socket(transport->peer.family, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (transport->fd < 0)
+    {
+        LE_ERROR("ERROR socket() failed(%d)", errno);
+        transport->fd = MANGOH_BRIDGE_TRANSPORT_FD_INVALID;
+        res = LE_FAULT;
+        goto cleanup;
+    }
+
+    if (transport->peer.family != AF_UNIX)
+    {
+        // Frames are small and latency bound
+        int noDelay = 1;
+        setsockopt(transport->fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    }
+
+    // An unreachable server must not hold up the event loop, the connection completes on POLLOUT
+    res = connect(transport->fd, (const struct sockaddr*)&transport->peer.addr, transport->peer.len);
+    if (res && (errno == EINPROGRESS))
+    {
+        LE_DEBUG("connect '%s' in progress", transport->addr);
+        res = LE_WOULD_BLOCK;
+        goto cleanup;
+    }
+    else if (res)
+    {
+        LE_ERROR("ERROR connect() '%s' failed(%d/%d)", transport->addr, res, errno);
+        res = LE_COMM_ERROR;
+        goto cleanup;
+    }
+
+cleanup:
+    return res;
+}
+
+static int mangoh_bridge_transport_tcpResolve(const mangoh_bridge_transport_t* transport, mangoh_bridge_transport_peer_t* peer)
+{
+    char host[MANGOH_BRIDGE_TRANSPORT_NAME_MAX_LEN] = {0};
+    struct addrinfo* result = NULL;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(transport);
+    LE_ASSERT(peer);
+
+    const char* port = strrchr(transport->addr, MANGOH_BRIDGE_TRANSPORT_SCHEME_SEPARATOR);
+    if (!port || (port == transport->addr))
+    {
+        LE_ERROR("ERROR invalid address '%s', expected host:port", transport->addr);
+        res = LE_BAD_PARAMETER;
+        goto cleanup;
+    }
+
+    memcpy(host, transport->addr, port - transport->addr);
+    port++;
+
+    struct addrinfo hints = {0};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    res = getaddrinfo(host, port, &hints, &result);
+    if (res)
+    {
+        LE_ERROR("ERROR getaddrinfo() '%s' failed(%d)", transport->addr, res);
+        result = NULL;
+        res = LE_NOT_FOUND;
+        goto cleanup;
+    }
+
+    if (result->ai_addrlen > sizeof(peer->addr))
+    {
+        LE_ERROR("ERROR address '%s' length(%u) too long", transport->addr, (unsigned)result->ai_addrlen);
+        res = LE_OVERFLOW;
+        goto cleanup;
+    }
+
+    memcpy(&peer->addr, result->ai_addr, result->ai_addrlen);
+    peer->len = result->ai_addrlen;
+    peer->family = result->ai_family;
+
+cleanup:
+    if (result)
+    {
+        freeaddrinfo(result);
+    }
+
+    return res;
+}
+
+static int mangoh_bridge_transport_unixResolve(const mangoh_bridge_transport_t* transport, mangoh_bridge_transport_peer_t* peer)
+{
+    struct sockaddr_un addr = {0};
+    int32_t res = LE_OK;
+
+    LE_ASSERT(transport);
+    LE_ASSERT(peer);
+
+    if (strlen(transport->addr) >= sizeof(addr.sun_path))
+    {
+        LE_ERROR("ERROR path '%s' too long", transport->addr);
+        res = LE_OVERFLOW;
+        goto cleanup;
+    }
+
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, transport->addr);
+
+    memcpy(&peer->addr, &addr, sizeof(addr));
+    peer->len = sizeof(addr);
+    peer->family = AF_UNIX;
+
+cleanup:
+    return res;
+}
+
+bool mangoh_bridge_transport_needsResolve(const mangoh_bridge_transport_t* transport)
+{
+    LE_ASSERT(transport);
+    LE_ASSERT(transport->ops);
+
+    return transport->ops->resolve != NULL;
+}
+
+int mangoh_bridge_transport_resolve(const mangoh_bridge_transport_t* transport, mangoh_bridge_transport_peer_t* peer)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(transport);
+    LE_ASSERT(transport->ops);
+    LE_ASSERT(peer);
+
+    memset(peer, 0, sizeof(mangoh_bridge_transport_peer_t));
+    if (!transport->ops->resolve)
+    {
+        goto cleanup;
+    }
+
+    res = transport->ops->resolve(transport, peer);
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR resolve '%s' failed(%d)", transport->name, res);
+        goto cleanup;
+    }
+
+cleanup:
+    return res;
+}
+
+int mangoh_bridge_transport_finishConnect(mangoh_bridge_transport_t* transport)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(transport);
+
+    int err = 0;
+    socklen_t len = sizeof(err);
+    res = getsockopt(transport->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+    if (res || err)
+    {
+        LE_ERROR("ERROR connect() '%s' failed(%d/%d)", transport->addr, res, res ? errno:err);
+        res = LE_COMM_ERROR;
+        goto cleanup;
+    }
+
+    LE_INFO("connected '%s'", transport->name);
+
+cleanup:
+    return res;
+}
+
+int mangoh_bridge_transport_open(mangoh_bridge_transport_t* transport)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(transport);
+    LE_ASSERT(transport->ops);
+
+    LE_INFO("open '%s'", transport->name);
+    res = transport->ops->open(transport);
+    if (res == LE_WOULD_BLOCK)
+    {
+        goto cleanup;
+    }
+    else if (res != LE_OK)
+    {
+        LE_ERROR("ERROR open '%s' failed(%d)", transport->name, res);
+        mangoh_bridge_transport_close(transport);
+        goto cleanup;
+    }
+
+cleanup:
+    return res;
+}
+
+ssize_t mangoh_bridge_transport_readv(mangoh_bridge_transport_t* transport, const struct iovec* iov, int iovcnt)
+{
+    LE_ASSERT(transport);
+    LE_ASSERT(transport->ops);
+
+    return transport->ops->readv(transport, iov, iovcnt);
+}
+
+ssize_t mangoh_bridge_transport_writev(mangoh_bridge_transport_t* transport, const struct iovec* iov, int iovcnt)
+{
+    LE_ASSERT(transport);
+    LE_ASSERT(transport->ops);
+
+    return transport->ops->writev(transport, iov, iovcnt);
+}
+
+bool mangoh_bridge_transport_hasLineRate(const mangoh_bridge_transport_t* transport)
+{
+    LE_ASSERT(transport);
+    LE_ASSERT(transport->ops);
+
+    return transport->ops->setSpeed != NULL;
+}
+
+int mangoh_bridge_transport_setSpeed(mangoh_bridge_transport_t* transport, speed_t speed)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(transport);
+    LE_ASSERT(transport->ops);
+
+    if (!transport->ops->setSpeed)
+    {
+        LE_ERROR("ERROR transport '%s' has no line rate", transport->name);
+        res = LE_NOT_IMPLEMENTED;
+        goto cleanup;
+    }
+
+    res = transport->ops->setSpeed(transport, speed);
+
+cleanup:
+    return res;
+}
+
+int mangoh_bridge_transport_outputPending(mangoh_bridge_transport_t* transport, uint32_t* pending)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(transport);
+    LE_ASSERT(transport->ops);
+    LE_ASSERT(pending);
+
+    *pending = 0;
+    if (!transport->ops->outputPending)
+    {
+        goto cleanup;
+    }
+
+    res = transport->ops->outputPending(transport, pending);
+
+cleanup:
+    return res;
+}
+
+int mangoh_bridge_transport_close(mangoh_bridge_transport_t* transport)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(transport);
+    LE_ASSERT(transport->ops);
+
+    if ((transport->fd == MANGOH_BRIDGE_TRANSPORT_FD_INVALID) && (transport->peerFd == MANGOH_BRIDGE_TRANSPORT_FD_INVALID))
+    {
+        goto cleanup;
+    }
+
+    res = transport->ops->close(transport);
+
+cleanup:
+    return res;
+}
+
+int mangoh_bridge_transport_init(mangoh_bridge_transport_t* transport, const char* name)
+{
+    uint32_t idx = 0;
+    int32_t res = LE_OK;
+
+    LE_ASSERT(transport);
+    LE_ASSERT(name);
+
+    memset(transport, 0, sizeof(mangoh_bridge_transport_t));
+    transport->fd = MANGOH_BRIDGE_TRANSPORT_FD_INVALID;
+    transport->peerFd = MANGOH_BRIDGE_TRANSPORT_FD_INVALID;
+
+    if (strlen(name) >= sizeof(transport->name))
+    {
+        LE_ERROR("ERROR transport '%s' name too long(%zu >= %zu)", name, strlen(name), sizeof(transport->name));
+        res = LE_OVERFLOW;
+        goto cleanup;
+    }
+
+    strcpy(transport->name, name);
+    transport->ops = &mangoh_bridge_transport_backends[0];
+    transport->addr = transport->name;
+
+    const char* separator = strchr(transport->name, MANGOH_BRIDGE_TRANSPORT_SCHEME_SEPARATOR);
+    if (!separator)
+    {
+        goto cleanup;
+    }
+
+    for (idx = 0; idx < NUM_ARRAY_MEMBERS(mangoh_bridge_transport_backends); idx++)
+    {
+        const char* scheme = mangoh_bridge_transport_backends[idx].scheme;
+        if ((strlen(scheme) == (size_t)(separator - transport->name)) && !strncmp(transport->name, scheme, strlen(scheme)))
+        {
+            transport->ops = &mangoh_bridge_transport_backends[idx];
+            transport->addr = separator + 1;
+            break;
+        }
+    }
+
+    LE_INFO("transport '%s' address '%s'", transport->ops->scheme, transport->addr);
+
+cleanup:
+    return res;
+}
@@ -0,0 +1,93 @@
+/*
+ * @file mangoh_bridge_transport.h
+ *
+ * Arduino bridge serial transport sub-module.
+ *
+ * This module hides how the bridge reaches the MCU.  A transport is selected with a "scheme:address" string:
+ *
+ *  - tty:/dev/ttyUSB0   local UART (default when no scheme is given)
+ *  - pty:/tmp/bridge    pseudo terminal, the slave is linked at the given path for a simulated MCU to open
+ *  - tcp:host:port      network serial server
+ *  - unix:/path         UNIX domain stream socket
+ *
+ * Only the tty transport has a line rate, the others ignore baud rate negotiation.  Socket addresses are resolved
+ * with mangoh_bridge_transport_resolve(), which may block and is meant for a worker thread, and their connection
+ * completes in the background: open returns LE_WOULD_BLOCK until the descriptor reports POLLOUT, then
+ * mangoh_bridge_transport_finishConnect() tells whether it succeeded.
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+#include <termios.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+
+#ifndef MANGOH_BRIDGE_TRANSPORT_INCLUDE_GUARD
+#define MANGOH_BRIDGE_TRANSPORT_INCLUDE_GUARD
+
+#define MANGOH_BRIDGE_TRANSPORT_FD_INVALID          -1
+#define MANGOH_BRIDGE_TRANSPORT_NAME_MAX_LEN        128
+#define MANGOH_BRIDGE_TRANSPORT_SCHEME_SEPARATOR    ':'
+#define MANGOH_BRIDGE_TRANSPORT_CONNECT_TIMEOUT_SEC 1
+
+struct _mangoh_bridge_transport_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Resolved socket address
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_transport_peer_t
+{
+    struct sockaddr_storage addr;   ///< Socket address
+    socklen_t               len;    ///< Socket address length
+    int                     family; ///< Socket address family
+} mangoh_bridge_transport_peer_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Transport backend operations
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_transport_ops_t
+{
+    const char* scheme;                                                                                ///< Address scheme
+    int         (*resolve)(const struct _mangoh_bridge_transport_t*, mangoh_bridge_transport_peer_t*); ///< Address lookup, NULL if none
+    int         (*open)(struct _mangoh_bridge_transport_t*);                                           ///< Open/connect
+    ssize_t     (*readv)(struct _mangoh_bridge_transport_t*, const struct iovec*, int);                ///< Scatter read
+    ssize_t     (*writev)(struct _mangoh_bridge_transport_t*, const struct iovec*, int);               ///< Gather write
+    int         (*setSpeed)(struct _mangoh_bridge_transport_t*, speed_t);                              ///< Change line rate, NULL if none
+    int         (*outputPending)(struct _mangoh_bridge_transport_t*, uint32_t*);                       ///< Bytes not sent yet, NULL if none
+    int         (*close)(struct _mangoh_bridge_transport_t*);                                          ///< Close
+} mangoh_bridge_transport_ops_t;
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Transport
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_transport_t
+{
+    const mangoh_bridge_transport_ops_t* ops;                                        ///< Backend
+    char                                 name[MANGOH_BRIDGE_TRANSPORT_NAME_MAX_LEN]; ///< Full transport string
+    const char*                          addr;                                       ///< Address part of name
+    mangoh_bridge_transport_peer_t       peer;                                       ///< Resolved socket address
+    int                                  fd;                                         ///< Descriptor to monitor
+    int                                  peerFd;                                     ///< pty slave held open
+} mangoh_bridge_transport_t;
+
+bool mangoh_bridge_transport_needsResolve(const mangoh_bridge_transport_t*);
+int mangoh_bridge_transport_resolve(const mangoh_bridge_transport_t*, mangoh_bridge_transport_peer_t*);
+int mangoh_bridge_transport_open(mangoh_bridge_transport_t*);
+int mangoh_bridge_transport_finishConnect(mangoh_bridge_transport_t*);
+ssize_t mangoh_bridge_transport_readv(mangoh_bridge_transport_t*, const struct iovec*, int);
+ssize_t mangoh_bridge_transport_writev(mangoh_bridge_transport_t*, const struct iovec*, int);
+bool mangoh_bridge_transport_hasLineRate(const mangoh_bridge_transport_t*);
+int mangoh_bridge_transport_setSpeed(mangoh_bridge_transport_t*, speed_t);
+int mangoh_bridge_transport_outputPending(mangoh_bridge_transport_t*, uint32_t*);
+int mangoh_bridge_transport_close(mangoh_bridge_transport_t*);
+
+int mangoh_bridge_transport_init(mangoh_bridge_transport_t*, const char*);
+
+#endif
@@ -0,0 +1,167 @@
+/**
+ * @file
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless, Inc. Use of this work is subject to license.
+ */
+
+#include "legato.h"
+#include "worker.h"
+
+static int mangoh_bridge_worker_start(void);
+static void mangoh_bridge_worker_queue(mangoh_bridge_worker_job_t*);
+static void* mangoh_bridge_worker_main(void*);
+static void mangoh_bridge_worker_complete(void*, void*);
+
+static le_mutex_Ref_t mangoh_bridge_worker_mutex;
+static le_sem_Ref_t mangoh_bridge_worker_sem;
+static le_sls_List_t mangoh_bridge_worker_runQueue = LE_SLS_LIST_INIT;
+
+// Keyed jobs submitted and not yet done, only used from the event loop thread
+static le_dls_List_t mangoh_bridge_worker_keyed = LE_DLS_LIST_INIT;
+
+static int mangoh_bridge_worker_start(void)
+{
+    int32_t res = LE_OK;
+
+    if (mangoh_bridge_worker_sem)
+    {
+        goto cleanup;
+    }
+
+    mangoh_bridge_worker_mutex = le_mutex_CreateNonRecursive(MANGOH_BRIDGE_WORKER_THREAD_NAME);
+    mangoh_bridge_worker_sem = le_sem_Create(MANGOH_BRIDGE_WORKER_THREAD_NAME, 0);
+
+    uint32_t idx = 0;
+    for (idx = 0; idx < MANGOH_BRIDGE_WORKER_NUM_THREADS; idx++)
+    {
+        le_thread_Ref_t thread = le_thread_Create(MANGOH_BRIDGE_WORKER_THREAD_NAME, mangoh_bridge_worker_main, NULL);
+        if (!thread)
+        {
+            LE_ERROR("ERROR le_thread_Create() failed");
+            res = LE_FAULT;
+            goto cleanup;
+        }
+
+        le_thread_Start(thread);
+    }
+
+    LE_DEBUG("worker pool started(%u)", MANGOH_BRIDGE_WORKER_NUM_THREADS);
+
+cleanup:
+    return res;
+}
+
+static void mangoh_bridge_worker_queue(mangoh_bridge_worker_job_t* job)
+{
+    LE_ASSERT(job);
+
+    le_mutex_Lock(mangoh_bridge_worker_mutex);
+    le_sls_Queue(&mangoh_bridge_worker_runQueue, &job->link);
+    le_mutex_Unlock(mangoh_bridge_worker_mutex);
+
+    le_sem_Post(mangoh_bridge_worker_sem);
+}
+
+static void* mangoh_bridge_worker_main(void* param)
+{
+    while (1)
+    {
+        le_sem_Wait(mangoh_bridge_worker_sem);
+
+        le_mutex_Lock(mangoh_bridge_worker_mutex);
+        le_sls_Link_t* link = le_sls_Pop(&mangoh_bridge_worker_runQueue);
+        le_mutex_Unlock(mangoh_bridge_worker_mutex);
+
+        if (!link)
+        {
+            continue;
+        }
+
+        mangoh_bridge_worker_job_t* job = CONTAINER_OF(link, mangoh_bridge_worker_job_t, link);
+        job->work(job->context);
+        le_event_QueueFunctionToThread(job->owner, mangoh_bridge_worker_complete, job, NULL);
+    }
+
+    return NULL;
+}
+
+static void mangoh_bridge_worker_complete(void* param1, void* param2)
+{
+    mangoh_bridge_worker_job_t* job = (mangoh_bridge_worker_job_t*)param1;
+
+    LE_ASSERT(job);
+
+    if (job->key)
+    {
+        le_dls_Remove(&mangoh_bridge_worker_keyed, &job->keyLink);
+        if (job->next)
+        {
+            mangoh_bridge_worker_queue(job->next);
+        }
+    }
+
+    job->done(job->context);
+    free(job);
+}
+
+int mangoh_bridge_worker_submit(const void* key, mangoh_bridge_worker_func_t work, mangoh_bridge_worker_func_t done, void* context)
+{
+    int32_t res = LE_OK;
+
+    LE_ASSERT(work);
+    LE_ASSERT(done);
+
+    res = mangoh_bridge_worker_start();
+    if (res != LE_OK)
+    {
+        LE_ERROR("ERROR mangoh_bridge_worker_start() failed(%d)", res);
+        goto cleanup;
+    }
+
+    mangoh_bridge_worker_job_t* job = calloc(1, sizeof(mangoh_bridge_worker_job_t));
+    if (!job)
+    {
+        LE_ERROR("ERROR calloc() failed");
+        res = LE_NO_MEMORY;
+        goto cleanup;
+    }
+
+    job->work = work;
+    job->done = done;
+    job->context = context;
+    job->key = key;
+    job->owner = le_thread_GetCurrent();
+    job->link = LE_SLS_LINK_INIT;
+    job->keyLink = LE_DLS_LINK_INIT;
+
+    if (key)
+    {
+        // Chain behind the last job with the same key, it queues this one when done
+        le_dls_Link_t* link = le_dls_PeekTail(&mangoh_bridge_worker_keyed);
+        while (link)
+        {
+            mangoh_bridge_worker_job_t* last = CONTAINER_OF(link, mangoh_bridge_worker_job_t, keyLink);
+            if (last->key == key)
+            {
+                LE_ASSERT(!last->next);
+                last->next = job;
+                break;
+            }
+
+            link = le_dls_PeekPrev(&mangoh_bridge_worker_keyed, link);
+        }
+
+        le_dls_Queue(&mangoh_bridge_worker_keyed, &job->keyLink);
+        if (link)
+        {
+            goto cleanup;
+        }
+    }
+
+    mangoh_bridge_worker_queue(job);
+
+cleanup:
+    return res;
+}
@@ -0,0 +1,44 @@
+/*
+ * @file mangoh_bridge_worker.h
+ *
+ * Arduino bridge worker pool module.
+ *
+ * A small pool of threads shared by all bridges for the blocking part of a command (waiting for a process, resolving a
+ * host name, file I/O).  A job's work function runs on a pool thread, its done function is then queued back to the
+ * thread that submitted it, where the command response is completed.  Jobs submitted with the same key run one at a
+ * time in submission order, e.g. the reads and writes of one file.
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless Inc. Use of this work is subject to license.
+ */
+#include "legato.h"
+
+#ifndef MANGOH_BRIDGE_WORKER_INCLUDE_GUARD
+#define MANGOH_BRIDGE_WORKER_INCLUDE_GUARD
+
+#define MANGOH_BRIDGE_WORKER_THREAD_NAME          "BridgeWorker"
+#define MANGOH_BRIDGE_WORKER_NUM_THREADS          4
+
+typedef void (*mangoh_bridge_worker_func_t)(void*);
+
+//------------------------------------------------------------------------------------------------------------------
+/**
+ * Worker pool job
+ */
+//------------------------------------------------------------------------------------------------------------------
+typedef struct _mangoh_bridge_worker_job_t
+{
+    mangoh_bridge_worker_func_t         work;    ///< Blocking part, runs on a pool thread
+    mangoh_bridge_worker_func_t         done;    ///< Completion, runs on the submitting thread
+    void*                               context; ///< Owner data passed to both functions
+    const void*                         key;     ///< Serialization key or NULL
+    le_thread_Ref_t                     owner;   ///< Submitting thread
+    struct _mangoh_bridge_worker_job_t* next;    ///< Next job with the same key, queued once this one is done
+    le_sls_Link_t                       link;    ///< Run queue link
+    le_dls_Link_t                       keyLink; ///< Keyed jobs list link
+} mangoh_bridge_worker_job_t;
+
+int mangoh_bridge_worker_submit(const void*, mangoh_bridge_worker_func_t, mangoh_bridge_worker_func_t, void*);
+
+#endif